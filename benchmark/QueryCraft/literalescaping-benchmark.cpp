@@ -0,0 +1,189 @@
+#include <QueryCraft/helper/literalescaping.h>
+#include <QueryCraft/querycraft.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Прежняя реализация экранирования sql_table: побайтовая запись в поток
+void insert_with_escaping_character(std::stringstream& sql_stream, const std::string& value)
+{
+    if(value != query_craft::column_info::null_value()) {
+        sql_stream << "'";
+    }
+
+    for(size_t i = 0; i < value.size(); i++) {
+        const auto ch = value[i];
+
+        switch(ch) {
+            case '\'': {
+                sql_stream << "\'\'";
+                break;
+            }
+
+            case '\\': {
+                // Доп обработка для json формата
+                if(i + 1 < value.size() && value[i + 1] == '"') {
+                    sql_stream << ch;
+                } else {
+                    sql_stream << "\\\\";
+                }
+
+                break;
+            }
+
+            default: {
+                sql_stream << ch;
+            }
+        }
+    }
+
+    if(value != query_craft::column_info::null_value()) {
+        sql_stream << "'";
+    }
+}
+
+std::vector<std::string> make_text(std::mt19937& random)
+{
+    const std::vector<std::string> words { "order", "customer's", "delivery", "address", "Москва", "улица", "O'Brien", "notes", "payment", "status" };
+
+    std::vector<std::string> values(100000);
+    for(auto& value : values) {
+        const auto count = 4 + random() % 12;
+        for(size_t i = 0; i < count; i++) {
+            value += words[random() % words.size()];
+            value += ' ';
+        }
+    }
+
+    return values;
+}
+
+std::vector<std::string> make_json(std::mt19937& random)
+{
+    std::vector<std::string> values(100000);
+    for(auto& value : values) {
+        value = "{\"id\": " + std::to_string(random()) + ", \"name\": \"item \\\"" + std::to_string(random() % 1000)
+            + "\\\"\", \"path\": \"C:\\\\data\\\\file.txt\", \"tags\": [\"a\", \"b\", \"c\"], \"comment\": \"it's fine\"}";
+    }
+
+    return values;
+}
+
+std::vector<std::string> make_binary(std::mt19937& random)
+{
+    std::vector<std::string> values(100000);
+    for(auto& value : values) {
+        value.resize(64 + random() % 192);
+        for(auto& symbol : value) {
+            symbol = static_cast<char>(random());
+        }
+    }
+
+    return values;
+}
+
+size_t total_size(const std::vector<std::string>& values)
+{
+    size_t size = 0;
+    for(const auto& value : values) {
+        size += value.size();
+    }
+
+    return size;
+}
+
+/// Лучшее время из нескольких запусков в миллисекундах
+double measure(const std::function<size_t()>& action)
+{
+    double best = 1e30;
+    size_t checksum = 0;
+
+    for(int run = 0; run < 7; run++) {
+        const auto start = std::chrono::steady_clock::now();
+        checksum += action();
+        const auto end = std::chrono::steady_clock::now();
+
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    // Контрольная сумма не даёт компилятору удалить измеряемый код
+    if(checksum == 0) {
+        std::printf(" ");
+    }
+
+    return best;
+}
+
+void report(const char* payload, const char* implementation, const size_t bytes, const double milliseconds)
+{
+    std::printf("%-8s %-22s %9.2f ms %9.1f MB/s\n", payload, implementation, milliseconds, bytes / milliseconds / 1000.0);
+}
+
+void run(const char* payload, const std::vector<std::string>& values)
+{
+    const auto bytes = total_size(values);
+
+    report(payload, "stringstream (old)", bytes, measure([&values]() {
+        std::stringstream stream;
+        for(const auto& value : values) {
+            insert_with_escaping_character(stream, value);
+        }
+
+        return static_cast<size_t>(stream.tellp());
+    }));
+
+    const std::pair<query_craft::helper::escape_kernel, const char*> kernels[] = {
+        { query_craft::helper::escape_kernel::scalar, "scalar" },
+        { query_craft::helper::escape_kernel::sse2, "sse2" },
+        { query_craft::helper::escape_kernel::avx2, "avx2" }
+    };
+
+    std::string output;
+    for(const auto& kernel : kernels) {
+        if(!query_craft::helper::is_escape_kernel_supported(kernel.first)) {
+            continue;
+        }
+
+        report(payload, kernel.second, bytes, measure([&values, &output, &kernel]() {
+            output.clear();
+            for(const auto& value : values) {
+                const auto offset = output.size();
+                output.resize(offset + query_craft::helper::escaped_literal_size(value.data(), value.size(), kernel.first));
+                query_craft::helper::escape_literal(value.data(), value.size(), &output[offset], kernel.first);
+            }
+
+            return output.size();
+        }));
+    }
+
+    query_craft::sql_builder builder;
+    report(payload, "sql_builder", bytes, measure([&values, &builder]() {
+        builder.clear();
+        for(const auto& value : values) {
+            builder.append_literal(value);
+        }
+
+        return builder.size();
+    }));
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 random(42);
+
+    run("text", make_text(random));
+    run("json", make_json(random));
+    run("binary", make_binary(random));
+
+    return 0;
+}
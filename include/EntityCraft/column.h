@@ -3,13 +3,87 @@
 #include "nullcheker.h"
 #include "QueryCraft/conditiongroup.h"
 
+#include <DatabaseAdapter/model/queryresult.h>
 #include <ReflectionApi/helper/templates.h>
 #include <ReflectionApi/property.h>
 
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
 
 namespace entity_craft {
 
+namespace impl {
+
+/// Символьные типы разбираются type_converter как символ, а не как число, поэтому напрямую не заполняются
+template<typename T>
+constexpr bool is_character_v = std::is_same<T, char>::value
+    || std::is_same<T, signed char>::value
+    || std::is_same<T, unsigned char>::value
+    || std::is_same<T, wchar_t>::value
+    || std::is_same<T, char16_t>::value
+    || std::is_same<T, char32_t>::value;
+
+template<typename T>
+bool is_in_range(const int64_t value, std::true_type /*is_signed*/)
+{
+    return value >= static_cast<int64_t>(std::numeric_limits<T>::min()) && value <= static_cast<int64_t>(std::numeric_limits<T>::max());
+}
+
+template<typename T>
+bool is_in_range(const int64_t value, std::false_type /*is_signed*/)
+{
+    return value >= 0 && static_cast<uint64_t>(value) <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+}
+
+/// Заполнение целочисленного поля из ячейки хранящей целое число
+template<typename T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value && !is_character_v<T>, bool> = true>
+bool fill_from_cell(T& value, const database_adapter::query_result::row_view& row, const size_t column_index, int)
+{
+    if(row.type(column_index) != database_adapter::query_result::cell_type::integer)
+        return false;
+
+    const auto cell_value = row.as_int64(column_index);
+    // Значения вне диапазона типа обрабатываются type_converter, чтобы поведение не отличалось
+    if(!is_in_range<T>(cell_value, std::is_signed<T>()))
+        return false;
+
+    value = static_cast<T>(cell_value);
+    return true;
+}
+
+/// Заполнение поля с плавающей точкой из ячейки хранящей число
+template<typename T, std::enable_if_t<std::is_floating_point<T>::value, bool> = true>
+bool fill_from_cell(T& value, const database_adapter::query_result::row_view& row, const size_t column_index, int)
+{
+    const auto type = row.type(column_index);
+    if(type != database_adapter::query_result::cell_type::integer && type != database_adapter::query_result::cell_type::real)
+        return false;
+
+    value = static_cast<T>(row.as_double(column_index));
+    return true;
+}
+
+/// Заполнение строкового поля без промежуточной копии
+template<typename T, std::enable_if_t<std::is_same<T, std::string>::value, bool> = true>
+bool fill_from_cell(T& value, const database_adapter::query_result::row_view& row, const size_t column_index, int)
+{
+    const auto text = row.as_text(column_index);
+    value.assign(text.data(), text.size());
+    return true;
+}
+
+/// Для остальных типов значение заполняется через type_converter
+template<typename T>
+bool fill_from_cell(T&, const database_adapter::query_result::row_view&, size_t, ...)
+{
+    return false;
+}
+
+} // namespace impl
+
 template<typename ClassType,
     typename PropertyType,
     typename Setter = reflection_api::helper::Setter_t<ClassType, PropertyType>,
@@ -20,6 +94,7 @@ public:
     column(query_craft::column_info column_info, const reflection_api::property<ClassType, PropertyType, Setter, Getter>& reflection_property)
         : _column_info(std::move(column_info))
         , _reflection_property(reflection_property)
+        , _default_converter(is_default_converter(reflection_property.property_converter()))
     {
     }
 
@@ -54,6 +129,7 @@ public:
     column set_converter(const std::shared_ptr<type_converter_api::type_converter<PropertyType>>& converter)
     {
         _reflection_property.set_converter(converter);
+        _default_converter = is_default_converter(converter);
         return *this;
     }
 
@@ -68,10 +144,44 @@ public:
         return *this;
     }
 
+    /**
+     * Заполнить поле сущности значением ячейки результата запроса
+     * @param entity Сущность в которой находится поле
+     * @param row Строка результата запроса
+     * @param column_index Номер колонки в строке
+     * @note Если используется стандартный конвертер и тип ячейки подходит типу поля, то значение переносится напрямую,
+     * без создания промежуточной строки и разбора через std::stringstream
+     */
+    template<typename Entity>
+    void fill_from_cell(Entity& entity, const database_adapter::query_result::row_view& row, const size_t column_index) const
+    {
+        auto property_value = _reflection_property.empty_property();
+
+        if(!_default_converter || !impl::fill_from_cell(property_value, row, column_index, 0)) {
+            const auto converter = _reflection_property.property_converter();
+            if(converter == nullptr) {
+                throw std::logic_error("Column " + _column_info.name() + " has no type converter");
+            }
+
+            converter->fill_from_string(property_value, row.at(column_index).str());
+        }
+
+        _reflection_property.set_value(entity, property_value);
+    }
+
+private:
+    /// Используется ли стандартный конвертер, для которого значение можно перенести из типизированной ячейки напрямую
+    static bool is_default_converter(const std::shared_ptr<type_converter_api::type_converter<PropertyType>>& converter)
+    {
+        return converter == nullptr || typeid(*converter) == typeid(type_converter_api::type_converter<PropertyType>);
+    }
+
 private:
     query_craft::column_info _column_info;
     reflection_api::property<ClassType, PropertyType, Setter, Getter> _reflection_property;
     std::shared_ptr<entity_craft::null_cheker<PropertyType>> _null_cheker = std::make_shared<entity_craft::null_cheker<PropertyType>>();
+    /// Тип конвертера определяется при создании колонки и смене конвертера, а не для каждой ячейки
+    bool _default_converter = true;
 };
 
 template<typename ClassType, typename PropertyType>
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <DatabaseAdapter/iconnection.h>
+#include <DatabaseAdapter/model/queryresult.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace entity_craft {
+
+/**
+ * Декодер строк результата выборки в сущность
+ * Колонки, которые читает декодер, описываются слотами. Номера колонок результата для слотов вычисляются один раз на результат,
+ * после чего строка разбирается проходом по заранее подготовленным шагам без поиска колонок по имени
+ */
+template<typename ClassType>
+class entity_decoder
+{
+public:
+    using row_view = database_adapter::query_result::row_view;
+
+    /**
+     * Шаг разбора строки: заполнение поля или связанной сущности
+     * positions - номера колонок результата для слотов декодера, npos если колонки нет в результате
+     * @note Один декодер используется несколькими потоками, поэтому шаг не должен изменять своё состояние
+     */
+    using step = std::function<void(ClassType& entity, const row_view& row, const size_t* positions, const std::shared_ptr<database_adapter::IConnection>& database)>;
+
+    /// Итератор на сущности, которые склеиваются по primary_key
+    using entity_iterator = typename std::vector<ClassType>::iterator;
+
+    /**
+     * Шаг склейки сущностей с одинаковым primary_key: перенос связанных сущностей в первую сущность группы
+     * @note Как и шаг разбора строки, не должен изменять своё состояние
+     */
+    using merge_step = std::function<void(entity_iterator first, entity_iterator last)>;
+
+public:
+    /**
+     * Добавить слот колонки результата
+     * @param alias Псевдоним колонки в запросе на выборку
+     * @return Номер слота
+     */
+    size_t add_slot(std::string alias)
+    {
+        _aliases.emplace_back(std::move(alias));
+        return _aliases.size() - 1;
+    }
+
+    /**
+     * Добавить слоты вложенного декодера
+     * @param aliases Псевдонимы колонок вложенного декодера
+     * @return Номер первого добавленного слота, с которого начинаются позиции вложенного декодера
+     */
+    size_t add_slots(const std::vector<std::string>& aliases)
+    {
+        const size_t offset = _aliases.size();
+        _aliases.insert(_aliases.end(), aliases.begin(), aliases.end());
+        return offset;
+    }
+
+    /// Добавить шаг разбора строки. Шаги выполняются в порядке добавления
+    void add_step(step decode_step)
+    {
+        _steps.emplace_back(std::move(decode_step));
+    }
+
+    /// Добавить шаг склейки сущностей одной группы
+    void add_merge_step(merge_step step)
+    {
+        _merge_steps.emplace_back(std::move(step));
+    }
+
+    /**
+     * Склеить сущности одной группы в первую из них
+     * @param first Первая сущность группы, в неё переносятся связанные сущности остальных
+     * @param last Конец группы
+     */
+    void merge(entity_iterator first, entity_iterator last) const
+    {
+        for(const auto& merge_step : _merge_steps) {
+            merge_step(first, last);
+        }
+    }
+
+    /// Псевдонимы колонок всех слотов декодера, включая слоты вложенных декодеров
+    const std::vector<std::string>& aliases() const
+    {
+        return _aliases;
+    }
+
+    /**
+     * Вычислить номера колонок результата для слотов декодера
+     * @param columns Результат выборки или любая его строка
+     * @return Номера колонок, npos для колонок которых нет в результате
+     */
+    template<typename Columns_>
+    std::vector<size_t> bind(const Columns_& columns) const
+    {
+        std::vector<size_t> positions;
+        positions.reserve(_aliases.size());
+        for(const auto& alias : _aliases) {
+            positions.emplace_back(columns.column_index(alias));
+        }
+
+        return positions;
+    }
+
+    /**
+     * Разобрать строку результата в сущность
+     * @param row Строка результата
+     * @param positions Номера колонок, полученные из bind
+     * @param database Соединение, передаваемое в функции обратного вызова связанных таблиц
+     */
+    ClassType decode(const row_view& row, const size_t* positions, const std::shared_ptr<database_adapter::IConnection>& database) const
+    {
+        auto entity = ClassType();
+        for(const auto& decode_step : _steps) {
+            decode_step(entity, row, positions, database);
+        }
+
+        return entity;
+    }
+
+private:
+    std::vector<std::string> _aliases;
+    std::vector<step> _steps;
+    std::vector<merge_step> _merge_steps;
+};
+
+/// Хранилище декодера, которое разделяют копии описания таблицы
+template<typename ClassType>
+struct entity_decoder_cache
+{
+    std::once_flag once;
+    std::shared_ptr<const entity_decoder<ClassType>> decoder;
+};
+
+} // namespace entity_craft
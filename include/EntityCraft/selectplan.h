@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QueryCraft/joincolumn.h>
+#include <QueryCraft/sqltable.h>
+
+#include <mutex>
+#include <vector>
+
+namespace entity_craft {
+
+/**
+ * Части запроса на выборку, которые зависят только от описания таблицы и не зависят от условий, сортировки и ограничений
+ * Вычисляются один раз при первой выборке и используются всеми копиями описания таблицы
+ */
+struct select_plan
+{
+    /// Представление основной таблицы для генерации запросов
+    query_craft::sql_table table;
+    /// Колонка primary_key основной таблицы
+    query_craft::column_info primary_key;
+    /// Колонки выборки без связанных сущностей
+    std::vector<query_craft::column_info> columns;
+    /// Колонки выборки со связанными сущностями
+    std::vector<query_craft::column_info> columns_with_relations;
+    /// Соединения для выборки со связанными сущностями
+    std::vector<query_craft::join_column> joins;
+    /// Задана ли функция обратного вызова у таблицы или у связанных таблиц
+    bool has_request_callbacks = false;
+};
+
+/// Хранилище плана выборки, которое разделяют копии описания таблицы
+struct select_plan_cache
+{
+    std::once_flag once;
+    select_plan plan;
+};
+
+} // namespace entity_craft
@@ -2,6 +2,7 @@
 
 #include "TypeConverterApi/void_t.h"
 
+#include <functional>
 #include <type_traits>
 
 namespace entity_craft {
@@ -58,6 +59,23 @@ struct has_end<T, type_converter_api::sfinae::void_t<decltype(std::declval<T>().
 template<typename T>
 constexpr bool has_end_v = has_end<T>::value;
 
+/// Структура для проверки наличия специализации std::hash
+template<typename T, typename = void>
+struct is_hashable : std::false_type
+{
+};
+
+/// Структура для проверки наличия специализации std::hash
+template<typename T>
+struct is_hashable<T, type_converter_api::sfinae::void_t<decltype(std::hash<T> {}(std::declval<const T&>()))>>
+    : std::true_type
+{
+};
+
+/// Результат проверки наличия специализации std::hash
+template<typename T>
+constexpr bool is_hashable_v = is_hashable<T>::value;
+
 template<typename T>
 constexpr bool is_iterable_v = has_begin_v<T> && has_end_v<T>;
 } // namespace sfinae
@@ -7,10 +7,12 @@
 
 #include <DatabaseAdapter/databaseadapter.h>
 
+#include <QueryCraft/helper/literalescaping.h>
 #include <QueryCraft/sqltable.h>
 
 #include <memory>
 #include <set>
+#include <unordered_set>
 
 namespace entity_craft {
 
@@ -19,6 +21,10 @@ namespace entity_craft {
 template<typename ClassType, typename... Columns>
 class storage
 {
+    // Хранилища связанных таблиц наследуют режим работы хранилища, которое их создало
+    template<typename, typename...>
+    friend class storage;
+
 public:
     using class_type = ClassType;
 
@@ -27,7 +33,7 @@ public:
         , _dto(std::move(dto))
         , _auto_commit(auto_commit)
     {
-        if(_database == nullptr || !_database->is_valid()) {
+        if(_database == nullptr || !_database->is_alive()) {
             throw std::invalid_argument("Connection is not valid");
         }
     }
@@ -80,6 +86,16 @@ public:
         return *this;
     }
 
+    /**
+     * Экранировать обратную косую черту в сохраняемых значениях так же, как при подстановке литералов в запрос
+     * @param escape_backslashes false - значения передаются в базу без изменений
+     */
+    storage& escape_backslashes(const bool escape_backslashes = true)
+    {
+        _escape_backslashes = escape_backslashes;
+        return *this;
+    }
+
     void transaction(const int type = -1)
     {
         _auto_commit = true;
@@ -125,128 +141,92 @@ public:
 
     std::vector<ClassType> select()
     {
-        const query_craft::sql_table sql_table(_dto.table_info());
+        const database_adapter::query_source source("storage::select");
 
-        std::vector<query_craft::column_info> columns = sql_table.columns();
+        auto parameters = make_parameters();
+        const auto sql = select_query(parameters, false);
 
-        const auto duplicate_column = _dto.duplicate_column();
-        _dto.for_each(visitor::make_reference_column_visitor([&duplicate_column, &columns](auto& reference_column) {
-            if(std::find(duplicate_column.begin(), duplicate_column.end(), reference_column.column_info()) != duplicate_column.end()
-                || reference_column.type() == relation_type::one_to_many
-                || reference_column.type() == relation_type::one_to_one_inverted) {
-                auto it = std::remove(columns.begin(), columns.end(), reference_column.column_info());
-                if(it != columns.end())
-                    columns.erase(it);
-            }
-        }));
-
-        if(!_without_relation_entity) {
-            append_join_columns(columns, _dto);
-        }
-
-        const auto sql = sql_table.select_sql(
-            _without_relation_entity ? std::vector<query_craft::join_column> {} : join_columns(_dto),
-            _condition_group,
-            _sortColumns,
-            _limit,
-            _offset,
-            columns);
-
-        const auto result = _database->exec(sql);
+        const auto result = _database->exec_prepared(sql, parameters.values());
 
         clear_select_settings();
 
-        if(result.empty()) {
-            return {};
-        }
-
-        std::vector<ClassType> res;
-        for(const auto& row : result.data()) {
-            auto entity = parse_entity_from_sql(_dto, row, _without_relation_entity);
-            if(_dto.has_reques_callback()) {
-                _dto.reques_callback()->post_request_callback(entity, request_callback_type::select, _database);
-            }
-            res.emplace_back(entity);
-        }
-
-        res = merge_result_by_id(res, _dto, type_converter_api::container_converter<std::vector<ClassType>>());
-
-        return res;
+        return parse_select_result(result);
     }
 
     std::vector<ClassType> select_for_update()
     {
-        const query_craft::sql_table sql_table(_dto.table_info());
-
-        std::vector<query_craft::column_info> columns = sql_table.columns();
-
-        const auto duplicate_column = _dto.duplicate_column();
-        _dto.for_each(visitor::make_reference_column_visitor([&duplicate_column, &columns](auto& reference_column) {
-            if(std::find(duplicate_column.begin(), duplicate_column.end(), reference_column.column_info()) != duplicate_column.end()
-                || reference_column.type() == relation_type::one_to_many
-                || reference_column.type() == relation_type::one_to_one_inverted) {
-                auto it = std::remove(columns.begin(), columns.end(), reference_column.column_info());
-                if(it != columns.end())
-                    columns.erase(it);
-            }
-        }));
-
-        if(!_without_relation_entity) {
-            append_join_columns(columns, _dto);
-        }
+        const database_adapter::query_source source("storage::select_for_update");
 
-        const auto sql = sql_table.select_for_update_sql(
-            _without_relation_entity ? std::vector<query_craft::join_column> {} : join_columns(_dto),
-            _condition_group,
-            _sortColumns,
-            _limit,
-            _offset,
-            columns);
+        auto parameters = make_parameters();
+        const auto sql = select_query(parameters, true);
 
-        const auto result = _database->exec(sql);
+        const auto result = _database->exec_prepared(sql, parameters.values());
 
         clear_select_settings();
 
-        if(result.empty()) {
-            return {};
-        }
+        return parse_select_result(result);
+    }
 
-        std::vector<ClassType> res;
-        for(const auto& row : result.data()) {
-            auto entity = parse_entity_from_sql(_dto, row, _without_relation_entity);
-            if(_dto.has_reques_callback()) {
-                _dto.reques_callback()->post_request_callback(entity, request_callback_type::select, _database);
-            }
-            res.emplace_back(entity);
-        }
+    /**
+     * Потоковая выборка сущностей без сохранения всего результата в памяти
+     * @param callback Функция, которая вызывается для каждой полученной сущности
+     * @note При выборке со связанными сущностями строки дополнительно сортируются по primary_key,
+     * чтобы строки одной сущности шли подряд. Поэтому пользовательская сортировка должна использовать только колонки основной таблицы
+     * @note Во время вызова callback нельзя выполнять другие запросы через это же соединение
+     * @note Если у таблицы или связанных таблиц задана функция обратного вызова, результат читается целиком до разбора,
+     * так как функции обратного вызова могут выполнять запросы через соединение
+     */
+    template<typename Callback>
+    void select_stream(Callback&& callback)
+    {
+        const database_adapter::query_source source("storage::select_stream");
+
+        stream_select(std::forward<Callback>(callback), false);
+    }
 
-        res = merge_result_by_id(res, _dto, type_converter_api::container_converter<std::vector<ClassType>>());
+    /**
+     * Потоковая выгрузка сущностей через протокол выгрузки драйвера (для PostgreSQL - COPY TO STDOUT)
+     * Предназначена для выгрузки больших таблиц целиком с постоянным расходом памяти
+     * @param callback Функция, которая вызывается для каждой полученной сущности
+     * @note Значения условий подставляются в текст запроса, так как протокол выгрузки не поддерживает параметры.
+     * Ограничения на сортировку и выполнение запросов в callback такие же как у select_stream
+     */
+    template<typename Callback>
+    void export_stream(Callback&& callback)
+    {
+        const database_adapter::query_source source("storage::export_stream");
 
-        return res;
+        stream_select(std::forward<Callback>(callback), true);
     }
 
     template<typename Begin, typename End>
     std::vector<ClassType> select_by_ids(const Begin& begin, const End& end)
     {
+        const database_adapter::query_source source("storage::select_by_ids");
+
         if(begin == end)
             return {};
 
-        _condition_group = primary_key_column(_dto).in_list(begin, end);
+        _condition_group = cached_plan().primary_key.in_list(begin, end);
         return select();
     }
 
     template<typename Begin, typename End>
     std::vector<ClassType> select_for_update_by_ids(const Begin& begin, const End& end)
     {
+        const database_adapter::query_source source("storage::select_for_update_by_ids");
+
         if(begin == end)
             return {};
 
-        _condition_group = primary_key_column(_dto).in_list(begin, end);
+        _condition_group = cached_plan().primary_key.in_list(begin, end);
         return select_for_update();
     }
 
     size_t count()
     {
+        const database_adapter::query_source source("storage::count");
+
         const auto temp = _condition_group;
         clear_select_settings();
         _condition_group = temp;
@@ -257,6 +237,8 @@ public:
 
     std::shared_ptr<ClassType> get()
     {
+        const database_adapter::query_source source("storage::get");
+
         const auto t = _condition_group;
         const auto t1 = _without_relation_entity;
 
@@ -274,6 +256,8 @@ public:
 
     std::shared_ptr<ClassType> get_for_update()
     {
+        const database_adapter::query_source source("storage::get_for_update");
+
         const auto t = _condition_group;
         const auto t1 = _without_relation_entity;
 
@@ -292,19 +276,25 @@ public:
     template<typename IdType>
     std::shared_ptr<ClassType> get_by_id(const IdType& id)
     {
-        _condition_group = primary_key_column(_dto) == id;
+        const database_adapter::query_source source("storage::get_by_id");
+
+        _condition_group = cached_plan().primary_key == id;
         return get();
     }
 
     template<typename IdType>
     std::shared_ptr<ClassType> get_for_update_by_id(const IdType& id)
     {
-        _condition_group = primary_key_column(_dto) == id;
+        const database_adapter::query_source source("storage::get_for_update_by_id");
+
+        _condition_group = cached_plan().primary_key == id;
         return get_for_update();
     }
 
     bool contains(const ClassType& value)
     {
+        const database_adapter::query_source source("storage::contains");
+
         clear_select_settings();
 
         bool is_primary_key_null = false;
@@ -338,6 +328,8 @@ public:
 
     void insert(ClassType& value)
     {
+        const database_adapter::query_source source("storage::insert");
+
         std::vector<ClassType> data = { value };
 
         insert(data.begin(), data.end());
@@ -348,6 +340,8 @@ public:
     template<typename Begin, typename End>
     void insert(const Begin& begin, const End& end)
     {
+        const database_adapter::query_source source("storage::insert");
+
         if(begin == end) {
             return;
         }
@@ -371,13 +365,25 @@ public:
             }
         });
 
-        const auto sql = sql_table.insert_sql(columns_for_insert, true, columns_for_returning);
-        auto result = _database->exec(sql);
+        auto parameters = make_parameters();
+
+        // Буфер забирается у потока на время запроса, поэтому вложенная вставка получает собственный буфер
+        auto builder = std::move(insert_builder());
 
-        if(result.mutable_data().size() == static_cast<size_t>(end - begin)) {
-            auto resultIt = result.mutable_data().begin();
+        // Слишком большая пачка не помещается в ограничение на количество параметров, поэтому значения подставляются в запрос
+        if(static_cast<size_t>(end - begin) * columns_for_insert.size() > _database->max_bind_parameters()) {
+            sql_table.insert_sql(builder, columns_for_insert, true, columns_for_returning);
+        } else {
+            sql_table.insert_sql(builder, parameters, columns_for_insert, true, columns_for_returning);
+        }
+
+        const auto result = _database->exec_prepared(builder.str(), parameters.values());
+        insert_builder() = std::move(builder);
+
+        if(result.size() == static_cast<size_t>(end - begin)) {
+            auto resultIt = result.begin();
             auto valueIt = begin;
-            while(resultIt != result.mutable_data().end() && valueIt != end) {
+            while(resultIt != result.end() && valueIt != end) {
                 parse_entity_after_insert(*valueIt, _dto, *resultIt);
 
                 ++resultIt;
@@ -417,8 +423,104 @@ public:
         insert(value.begin(), value.end());
     }
 
+    /**
+     * Массовая вставка большого количества объектов. Строки передаются базе данных потоком, без построения одного запроса на все объекты
+     * Для таблиц с каскадной вставкой связей или с callback запросов используется insert
+     * @param begin Начало диапазона объектов
+     * @param end Конец диапазона объектов
+     * @param fetch_keys Заполнить объекты значениями колонок после вставки (например сгенерированными идентификаторами)
+     */
+    template<typename Begin, typename End>
+    void bulk_insert(const Begin& begin, const End& end, const bool fetch_keys = false)
+    {
+        const database_adapter::query_source source("storage::bulk_insert");
+
+        if(begin == end) {
+            return;
+        }
+
+        if(_dto.has_reques_callback() || has_cascade_insert()) {
+            insert(begin, end);
+            return;
+        }
+
+        std::vector<query_craft::column_info> columns_for_insert;
+        std::vector<query_craft::column_info> columns_for_returning;
+        prepare_insert_columns(columns_for_insert, columns_for_returning);
+
+        std::vector<std::string> columns;
+        columns.reserve(columns_for_insert.size());
+        for(const auto& column : columns_for_insert) {
+            columns.emplace_back(column.name());
+        }
+
+        std::vector<std::string> returning;
+        if(fetch_keys) {
+            returning.reserve(columns_for_returning.size());
+            for(const auto& column : columns_for_returning) {
+                returning.emplace_back(column.name());
+            }
+        }
+
+        const bool has_transactional = _database->is_transaction();
+
+        if(!has_transactional) {
+            transaction();
+        }
+
+        try {
+            // Строки формируются по мере чтения их драйвером, поэтому все значения не хранятся в памяти одновременно
+            auto value_it = begin;
+            const auto result = _database->bulk_insert(_dto.table_info().table_name(), columns, [this, &value_it, &end](std::vector<std::string>& row) {
+                if(value_it == end) {
+                    return false;
+                }
+
+                this->prepare_insert_row(*value_it, row, false);
+                if(_escape_backslashes) {
+                    for(auto& value : row) {
+                        if(value != query_craft::column_info::null_value() && value.find('\\') != std::string::npos) {
+                            value = query_craft::helper::escape_backslashes(value);
+                        }
+                    }
+                }
+                ++value_it;
+
+                return true;
+            }, returning);
+
+            auto result_it = result.begin();
+            auto entity_it = begin;
+            while(result_it != result.end() && entity_it != end) {
+                parse_entity_after_insert(*entity_it, _dto, *result_it);
+
+                ++result_it;
+                ++entity_it;
+            }
+
+            if(!has_transactional) {
+                commit();
+            }
+        } catch(...) {
+            // Открытая здесь транзакция не должна остаться открытой на соединении после ошибки
+            if(!has_transactional) {
+                rollback();
+            }
+
+            throw;
+        }
+    }
+
+    template<typename Container>
+    void bulk_insert(Container& value, const bool fetch_keys = false)
+    {
+        bulk_insert(value.begin(), value.end(), fetch_keys);
+    }
+
     void update(ClassType& value)
     {
+        const database_adapter::query_source source("storage::update");
+
         query_craft::sql_table sql_table(_dto.table_info());
 
         const auto has_transactional = _database->is_transaction();
@@ -427,14 +529,16 @@ public:
             transaction();
         }
 
-        _dto.for_each(visitor::make_reference_column_visitor([this, &value](auto& reference_column) {
+        // Состояние в базе читается один раз для всех связей объекта
+        std::unique_ptr<ClassType> old_state;
+        _dto.for_each(visitor::make_reference_column_visitor([this, &value, &old_state](auto& reference_column) {
             if(reference_column.has_cascade(cascade_type::all) || reference_column.has_cascade(cascade_type::merge_orphan)) {
-                this->sync_deleted_reference(value, reference_column);
+                this->sync_deleted_reference(value, this->cached_old_state(value, old_state), reference_column);
             } else {
                 if(reference_column.type() != relation_type::one_to_one_inverted && reference_column.type() != relation_type::one_to_many) {
                     return;
                 }
-                this->update_deleted_reference(value, reference_column);
+                this->update_deleted_reference(value, this->cached_old_state(value, old_state), reference_column);
             }
         }));
 
@@ -450,9 +554,16 @@ public:
 
         sql_table.add_row(row);
 
-        const auto sql = sql_table.update_sql(condition_for_update, columns_for_update);
+        auto parameters = make_parameters();
+        const auto sql = sql_table.update_sql(parameters, condition_for_update, columns_for_update);
 
-        _database->exec(sql);
+        // Результат обновления не нужен, поэтому при пакетном обновлении запрос откладывается и отправляется вместе с остальными.
+        // Callback может рассчитывать на уже выполненный запрос, поэтому с ним запрос выполняется сразу
+        if(_defer_updates && !_dto.has_reques_callback()) {
+            _database->exec_deferred(sql, parameters.values());
+        } else {
+            _database->exec_prepared(sql, parameters.values());
+        }
 
         if(_dto.has_reques_callback()) {
             _dto.reques_callback()->post_request_callback(value, request_callback_type::update, _database);
@@ -480,25 +591,36 @@ public:
     template<typename Begin, typename End>
     void update(const Begin& begin, const End& end)
     {
+        const database_adapter::query_source source("storage::update");
+
         const auto has_transactional = _database->is_transaction();
 
         if(!has_transactional) {
             transaction();
         }
 
+        _defer_updates = true;
+
         try {
             std::for_each(begin, end, [this](auto& value) {
                 this->update(value);
             });
 
+            _defer_updates = false;
+            _database->flush_deferred();
+
             if(!has_transactional) {
                 commit();
             }
 
-        } catch(database_adapter::sql_exception) {
+        } catch(...) {
+            _defer_updates = false;
+
             if(!has_transactional) {
                 rollback();
             }
+
+            throw;
         }
     }
 
@@ -510,6 +632,8 @@ public:
 
     void upsert(ClassType& value)
     {
+        const database_adapter::query_source source("storage::upsert");
+
         if(contains(value)) {
             update(value);
         } else {
@@ -520,6 +644,8 @@ public:
     template<typename Begin, typename End>
     void upsert(const Begin& begin, const End& end)
     {
+        const database_adapter::query_source source("storage::upsert");
+
         const auto has_transactional = _database->is_transaction();
 
         if(!has_transactional) {
@@ -535,10 +661,12 @@ public:
                 commit();
             }
 
-        } catch(database_adapter::sql_exception) {
+        } catch(...) {
             if(!has_transactional) {
                 rollback();
             }
+
+            throw;
         }
     }
 
@@ -550,6 +678,8 @@ public:
 
     void remove_by_condition(const query_craft::condition_info& condition)
     {
+        const database_adapter::query_source source("storage::remove_by_condition");
+
         clear_select_settings();
         _condition_group = condition;
 
@@ -559,6 +689,8 @@ public:
 
     void remove_by_condition(const query_craft::condition_group& condition)
     {
+        const database_adapter::query_source source("storage::remove_by_condition");
+
         clear_select_settings();
         _condition_group = condition;
 
@@ -568,6 +700,8 @@ public:
 
     void remove(ClassType& value)
     {
+        const database_adapter::query_source source("storage::remove");
+
         std::vector<ClassType> data = { value };
 
         remove(data.begin(), data.end());
@@ -578,6 +712,8 @@ public:
     template<typename Begin, typename End>
     void remove(const Begin& begin, const End& end)
     {
+        const database_adapter::query_source source("storage::remove");
+
         query_craft::sql_table sql_table(_dto.table_info());
 
         query_craft::condition_group condition_for_remove;
@@ -593,6 +729,8 @@ public:
                 _dto.reques_callback()->pre_request_callback(value, request_callback_type::remove, _database);
             }
 
+            std::unique_ptr<ClassType> old_state;
+
             _dto.for_each(visitor::make_any_column_visitor(
                 [&value, &condition_for_remove](auto& column) {
                     auto column_info = column.column_info();
@@ -611,9 +749,9 @@ public:
                         condition_for_remove = column_info == string_property_value;
                     }
                 },
-                [this, &value](auto& reference_column) {
+                [this, &value, &old_state](auto& reference_column) {
                     if(reference_column.has_cascade(cascade_type::all) || reference_column.has_cascade(cascade_type::remove)) {
-                        auto reference_storage = make_storage(this->_database, reference_column.reference_table(), false);
+                        auto reference_storage = this->make_nested_storage(reference_column.reference_table());
 
                         auto property_value = reference_column.property().value(value);
                         reference_storage.remove(property_value);
@@ -621,14 +759,25 @@ public:
                         if(reference_column.type() != relation_type::one_to_one_inverted && reference_column.type() != relation_type::one_to_many) {
                             return;
                         }
-                        this->update_deleted_reference(value, reference_column);
+                        this->update_deleted_reference(value, this->cached_old_state(value, old_state), reference_column);
                     }
                 }));
         });
 
-        const auto sql = sql_table.remove_sql(condition_for_remove);
+        auto parameters = make_parameters();
+        auto sql = sql_table.remove_sql(parameters, condition_for_remove);
 
-        _database->exec(sql);
+        if(parameters.size() > _database->max_bind_parameters()) {
+            parameters.clear();
+            sql = sql_table.remove_sql(condition_for_remove);
+        }
+
+        // Результат удаления не нужен, поэтому при пакетном обновлении запрос откладывается так же, как обновление
+        if(_defer_updates && !_dto.has_reques_callback()) {
+            _database->exec_deferred(sql, parameters.values());
+        } else {
+            _database->exec_prepared(sql, parameters.values());
+        }
 
         std::for_each(begin, end, [this](auto& value) {
             if(!_dto.has_reques_callback()) {
@@ -651,6 +800,8 @@ public:
 
     void remove()
     {
+        const database_adapter::query_source source("storage::remove");
+
         std::vector<ClassType> data;
         remove(data.begin(), data.end());
     }
@@ -658,42 +809,161 @@ public:
     template<typename IdType>
     void remove_by_id(const IdType& id)
     {
-        remove_by_condition(primary_key_column(_dto) == id);
+        const database_adapter::query_source source("storage::remove_by_id");
+
+        remove_by_condition(cached_plan().primary_key == id);
     }
 
     template<typename Begin, typename End>
     void remove_by_ids(const Begin& begin, const End& end)
     {
+        const database_adapter::query_source source("storage::remove_by_ids");
+
         if(begin == end)
             return;
 
-        remove_by_condition(primary_key_column(_dto).in_list(begin, end));
+        remove_by_condition(cached_plan().primary_key.in_list(begin, end));
     }
 
 private:
+    /// Буфер запросов вставки потока, память которого переиспользуется между вызовами
+    static query_craft::sql_builder& insert_builder()
+    {
+        static thread_local query_craft::sql_builder builder;
+        return builder;
+    }
+
     /**
-     * Получить текстовое представление идентификатора заданной сущности
-     * @tparam Entity Тип сущности у которой нужно получить уникальный идентификатор
-     * @tparam Dto Вспомогательный тип для возможности получить информацию о колонках. entity_craft::table
-     * @param entity Сущность у которой нужно получить уникальный идентификатор
-     * @param dto Информация о таблице
-     * @return текстовое представление идентификатора заданной сущности
+     * Создать список параметров запроса в формате, который поддерживает база данных
+     * @return Пустой список параметров
      */
-    template<typename Entity, typename Dto>
-    static std::string get_entity_id(Entity& entity, Dto& dto)
+    query_craft::sql_parameters make_parameters() const
     {
-        std::string id;
-        dto.for_each([&entity, &id](const auto& column) {
-            const auto column_info = column.column_info();
-            if(!column_info.has_settings(query_craft::column_settings::primary_key))
-                return;
+        return query_craft::sql_parameters(_database->numbered_placeholders() ? query_craft::placeholder_type::numbered : query_craft::placeholder_type::question, _escape_backslashes);
+    }
 
-            auto column_property = column.property();
-            const auto reference_propery_value = column_property.value(entity);
-            id = column_property.property_converter()->convert_to_string(reference_propery_value);
+    /**
+     * Сформировать запрос на выборку на основе текущих настроек
+     * @param parameters Список, в который добавляются значения параметров запроса
+     * @param for_update Флаг означающий что выбранные строки необходимо заблокировать
+     * @return SQL-запрос для выборки
+     */
+    std::string select_query(query_craft::sql_parameters& parameters, const bool for_update)
+    {
+        const auto& plan = cached_plan();
+        const auto& columns = _without_relation_entity ? plan.columns : plan.columns_with_relations;
+        const auto& joins = _without_relation_entity ? no_joins() : plan.joins;
+
+        if(for_update) {
+            return plan.table.select_for_update_sql(parameters, joins, _condition_group, _sortColumns, _limit, _offset, columns);
+        }
+
+        return plan.table.select_sql(parameters, joins, _condition_group, _sortColumns, _limit, _offset, columns);
+    }
+
+    /**
+     * Сформировать запрос на выборку на основе текущих настроек, значения условий подставляются в текст запроса
+     * @return SQL-запрос для выборки
+     */
+    std::string select_literal_query()
+    {
+        const auto& plan = cached_plan();
+        const auto& columns = _without_relation_entity ? plan.columns : plan.columns_with_relations;
+        const auto& joins = _without_relation_entity ? no_joins() : plan.joins;
+
+        return plan.table.select_sql(joins, _condition_group, _sortColumns, _limit, _offset, columns);
+    }
+
+    /**
+     * Получить план выборки таблицы
+     * @return Колонки, соединения и primary_key, вычисленные при первом вызове для описания таблицы
+     */
+    const entity_craft::select_plan& cached_plan()
+    {
+        return _dto.cached_select_plan([this]() {
+            entity_craft::select_plan plan;
+            plan.table = query_craft::sql_table(_dto.table_info());
+            plan.primary_key = primary_key_column(_dto);
+            plan.columns = select_columns(plan.table);
+            plan.columns_with_relations = plan.columns;
+            append_join_columns(plan.columns_with_relations, _dto);
+            plan.joins = join_columns(_dto);
+            plan.has_request_callbacks = has_request_callbacks(_dto);
+            return plan;
         });
+    }
+
+    /**
+     * Проверка задана ли функция обратного вызова у таблицы или у любой из связанных с ней таблиц
+     * @param dto Описание таблицы
+     */
+    template<typename Dto>
+    static bool has_request_callbacks(Dto& dto)
+    {
+        bool has_callbacks = dto.has_reques_callback();
+        dto.for_each(visitor::make_reference_column_visitor([&has_callbacks](auto& reference_column) {
+            auto reference_table = reference_column.reference_table();
+            has_callbacks = has_callbacks || has_request_callbacks(reference_table);
+        }));
+
+        return has_callbacks;
+    }
+
+    /// Пустой список соединений для выборки без связанных сущностей
+    static const std::vector<query_craft::join_column>& no_joins()
+    {
+        static const std::vector<query_craft::join_column> joins;
+        return joins;
+    }
+
+    /**
+     * Получить список колонок основной таблицы для выборки
+     * @param sql_table Представление основной таблицы
+     * @return Колонки основной таблицы без колонок связей, которые хранятся в связанной таблице
+     */
+    std::vector<query_craft::column_info> select_columns(const query_craft::sql_table& sql_table)
+    {
+        std::vector<query_craft::column_info> columns = sql_table.columns();
+
+        const auto duplicate_column = _dto.duplicate_column();
+        _dto.for_each(visitor::make_reference_column_visitor([&duplicate_column, &columns](auto& reference_column) {
+            if(std::find(duplicate_column.begin(), duplicate_column.end(), reference_column.column_info()) != duplicate_column.end()
+                || reference_column.type() == relation_type::one_to_many
+                || reference_column.type() == relation_type::one_to_one_inverted) {
+                auto it = std::remove(columns.begin(), columns.end(), reference_column.column_info());
+                if(it != columns.end())
+                    columns.erase(it);
+            }
+        }));
 
-        return id;
+        return columns;
+    }
+
+    /**
+     * Разобрать результат выборки в список сущностей
+     * @param result Результат выполнения запроса
+     * @return Список склееных по primary_key сущностей
+     */
+    std::vector<ClassType> parse_select_result(const database_adapter::query_result& result)
+    {
+        if(result.empty()) {
+            return {};
+        }
+
+        const auto& decoder = cached_decoder(_dto);
+        const auto positions = decoder->bind(result);
+
+        std::vector<ClassType> res;
+        res.reserve(result.size());
+        for(const auto& row : result) {
+            auto entity = decoder->decode(row, positions.data(), _database);
+            if(_dto.has_reques_callback()) {
+                _dto.reques_callback()->post_request_callback(entity, request_callback_type::select, _database);
+            }
+            res.emplace_back(entity);
+        }
+
+        return merge_result_by_id(res, _dto, type_converter_api::container_converter<std::vector<ClassType>>());
     }
 
     /**
@@ -707,9 +977,10 @@ private:
 
     /**
      * Склейка одной сущности и ее связанных сущностей по primary_key
+     * Сущности с одинаковым primary_key склеиваются в первую из них, порядок результата совпадает с порядком первого появления primary_key
      * @tparam EntityList Тип для списока сущностей
      * @tparam Dto Вспомогательный тип для возможности получить информацию о колонках. entity_craft::table
-     * @param input Список сущностей для склейки
+     * @param input Список сущностей для склейки, сущности перемещаются в результат
      * @param dto Информация о таблице
      * @param converter Конвертер для массива данных
      * @return Список склееных сущностей по primary_key
@@ -717,55 +988,172 @@ private:
     template<typename EntityList, typename Dto>
     static EntityList merge_result_by_id(EntityList& input, Dto& dto, type_converter_api::container_converter<EntityList> converter)
     {
-        auto merge_entity = [](auto& input, auto& dto) {
-            if(input.size() == 1) {
-                return *input.begin();
-            }
+        using entity_type = typename EntityList::value_type;
 
-            dto.for_each(visitor::make_reference_column_visitor([&input](auto& reference_column) {
-                if(reference_column.type() != relation_type::one_to_many) {
-                    return;
-                }
+        std::vector<entity_type> entities;
+        entities.reserve(input.size());
+        for(auto& value : input) {
+            entities.emplace_back(std::move(value));
+        }
 
-                auto reference_property = reference_column.property();
-                auto target_array = reference_property.value(*input.begin());
+        std::vector<size_t> groups;
+        const size_t group_count = group_by_primary_key(entities, dto, groups);
 
-                std::for_each(++input.begin(), input.end(), [&reference_property, &reference_column, &target_array](auto& value) {
-                    auto addition_value = reference_property.value(value);
-                    reference_column.inserter().convert_to_target(target_array, addition_value);
-                });
+        EntityList res;
+        if(group_count == entities.size()) {
+            converter.move_to_target(res, entities);
+            return res;
+        }
 
-                auto reference_dto = reference_column.reference_table();
-                target_array = merge_result_by_id(target_array, reference_dto, reference_column.inserter());
+        // Сущности одной группы располагаются подряд в порядке их следования во входном списке
+        std::vector<size_t> offsets(group_count + 1, 0);
+        for(const auto group : groups) {
+            ++offsets[group + 1];
+        }
+        for(size_t i = 1; i < offsets.size(); ++i) {
+            offsets[i] += offsets[i - 1];
+        }
 
-                reference_property.set_value(*input.begin(), target_array);
-            }));
+        std::vector<entity_type> grouped(entities.size());
+        auto next = offsets;
+        for(size_t i = 0; i < entities.size(); ++i) {
+            grouped[next[groups[i]]++] = std::move(entities[i]);
+        }
 
-            return *input.begin();
-        };
+        // Шаги склейки связанных сущностей формируются вместе с декодером один раз для описания таблицы
+        const auto& decoder = cached_decoder(dto);
 
-        std::unordered_map<std::string, EntityList> mapping;
-        for(const auto& value : input) {
-            const auto value_id = get_entity_id(value, dto);
-            auto it = mapping.find(value_id);
-            if(it == mapping.end()) {
-                mapping.insert({ value_id, { value } });
-            } else {
-                converter.convert_to_target(it->second, EntityList { value });
+        std::vector<entity_type> merged;
+        merged.reserve(group_count);
+        for(size_t group = 0; group < group_count; ++group) {
+            const auto first = grouped.begin() + offsets[group];
+            const auto last = grouped.begin() + offsets[group + 1];
+            if(std::distance(first, last) > 1) {
+                decoder->merge(first, last);
             }
-        }
 
-        EntityList res;
-        for(auto& value : mapping) {
-            if(value.second.empty()) {
-                continue;
-            }
-            converter.convert_to_target(res, EntityList { merge_entity(value.second, dto) });
+            merged.emplace_back(std::move(*first));
         }
 
+        converter.move_to_target(res, merged);
         return res;
     }
 
+    /**
+     * Проверка совпадения primary_key двух сущностей
+     * @param lhs Первая сущность
+     * @param rhs Вторая сущность
+     * @param dto Информация о таблице
+     * @note При нескольких колонках primary_key сравнивается только последняя
+     */
+    template<typename Entity, typename Dto>
+    static bool has_same_primary_key(const Entity& lhs, const Entity& rhs, Dto& dto)
+    {
+        bool is_same = true;
+        dto.for_each([&lhs, &rhs, &is_same](const auto& column) {
+            if(!column.column_info().has_settings(query_craft::column_settings::primary_key))
+                return;
+
+            is_same = is_same_property_value(lhs, rhs, column.property());
+        });
+
+        return is_same;
+    }
+
+    /**
+     * Сравнить значения свойства двух сущностей, для типов с std::hash значения сравниваются напрямую
+     */
+    template<typename Entity, typename Property,
+        typename Key = std::decay_t<decltype(std::declval<const Property&>().value(std::declval<const Entity&>()))>,
+        std::enable_if_t<sfinae::is_hashable_v<Key>, bool> = true>
+    static bool is_same_property_value(const Entity& lhs, const Entity& rhs, const Property& property)
+    {
+        return property.value(lhs) == property.value(rhs);
+    }
+
+    /**
+     * Сравнить значения свойства двух сущностей для типов без std::hash по их текстовому представлению
+     */
+    template<typename Entity, typename Property,
+        typename Key = std::decay_t<decltype(std::declval<const Property&>().value(std::declval<const Entity&>()))>,
+        std::enable_if_t<!sfinae::is_hashable_v<Key>, bool> = true>
+    static bool is_same_property_value(const Entity& lhs, const Entity& rhs, const Property& property)
+    {
+        const auto converter = property.property_converter();
+
+        return converter->convert_to_string(property.value(lhs)) == converter->convert_to_string(property.value(rhs));
+    }
+
+    /**
+     * Разбить сущности на группы по значению primary_key
+     * @param entities Сущности
+     * @param dto Информация о таблице
+     * @param groups Номер группы для каждой сущности, группы нумеруются в порядке первого появления primary_key
+     * @return Количество групп
+     * @note При нескольких колонках primary_key группировка выполняется только по последней
+     */
+    template<typename Entity, typename Dto>
+    static size_t group_by_primary_key(const std::vector<Entity>& entities, Dto& dto, std::vector<size_t>& groups)
+    {
+        groups.clear();
+        groups.reserve(entities.size());
+
+        std::function<size_t()> group_by_key;
+        dto.for_each([&entities, &groups, &group_by_key](const auto& column) {
+            if(!column.column_info().has_settings(query_craft::column_settings::primary_key))
+                return;
+
+            group_by_key = [&entities, &groups, property = column.property()]() {
+                return group_by_property(entities, property, groups);
+            };
+        });
+
+        if(!group_by_key) {
+            groups.assign(entities.size(), 0);
+            return entities.empty() ? 0 : 1;
+        }
+
+        return group_by_key();
+    }
+
+    /**
+     * Разбить сущности на группы по значению свойства, тип значения используется как ключ хэш таблицы
+     */
+    template<typename Entity, typename Property,
+        typename Key = std::decay_t<decltype(std::declval<const Property&>().value(std::declval<const Entity&>()))>,
+        std::enable_if_t<sfinae::is_hashable_v<Key>, bool> = true>
+    static size_t group_by_property(const std::vector<Entity>& entities, const Property& property, std::vector<size_t>& groups)
+    {
+        std::unordered_map<Key, size_t> mapping;
+        mapping.reserve(entities.size());
+        for(const auto& entity : entities) {
+            const auto group = mapping.size();
+            groups.emplace_back(mapping.emplace(property.value(entity), group).first->second);
+        }
+
+        return mapping.size();
+    }
+
+    /**
+     * Разбить сущности на группы по значению свойства для типов без std::hash, ключом служит текстовое представление значения
+     */
+    template<typename Entity, typename Property,
+        typename Key = std::decay_t<decltype(std::declval<const Property&>().value(std::declval<const Entity&>()))>,
+        std::enable_if_t<!sfinae::is_hashable_v<Key>, bool> = true>
+    static size_t group_by_property(const std::vector<Entity>& entities, const Property& property, std::vector<size_t>& groups)
+    {
+        const auto converter = property.property_converter();
+
+        std::unordered_map<std::string, size_t> mapping;
+        mapping.reserve(entities.size());
+        for(const auto& entity : entities) {
+            const auto group = mapping.size();
+            groups.emplace_back(mapping.emplace(converter->convert_to_string(property.value(entity)), group).first->second);
+        }
+
+        return mapping.size();
+    }
+
     /**
      * Получить информацию о колонке с флагом primary_key
      * @param dto Таблица из которой нужно получить информаю
@@ -811,22 +1199,14 @@ private:
             append_join_columns(columns, reference_table);
         }));
 
-        // Удаление дублирующих колонок
-        std::unordered_map<std::string, query_craft::column_info> columnsByName;
-        for(const auto& column : columns) {
-            if(columnsByName.find(column.full_name()) != columnsByName.end()) {
-                continue;
-            }
-
-            columnsByName.insert({ column.full_name(), column });
-        }
-
-        columns.clear();
-        columns.reserve(columnsByName.size());
+        // Удаление дублирующих колонок с сохранением порядка первого вхождения
+        std::unordered_set<std::string> names;
+        names.reserve(columns.size());
 
-        for(const auto& column : columnsByName) {
-            columns.emplace_back(column.second);
-        }
+        columns.erase(std::remove_if(columns.begin(), columns.end(), [&names](const query_craft::column_info& column) {
+            return !names.insert(column.full_name()).second;
+        }),
+            columns.end());
     }
 
     /**
@@ -875,16 +1255,19 @@ private:
             it->second.condition = table.condition || it->second.condition;
         }
 
-        std::set<std::string> duplicate;
+        // Соединения располагаются в порядке последнего вхождения таблицы: список собирается с конца и разворачивается
+        std::unordered_set<std::string> duplicate;
         std::vector<query_craft::join_column> joined_columns_mapped;
         joined_columns_mapped.reserve(joined_table_by_name.size());
         std::for_each(joined_columns.rbegin(), joined_columns.rend(), [&duplicate, &joined_columns_mapped, &joined_table_by_name](const auto& table) {
-            if(duplicate.find(table.joined_table.table_name()) == duplicate.end()) {
-                duplicate.insert(table.joined_table.table_name());
-                joined_columns_mapped.insert(joined_columns_mapped.begin(), joined_table_by_name.at(table.joined_table.table_name()));
+            auto table_name = table.joined_table.table_name();
+            if(duplicate.insert(table_name).second) {
+                joined_columns_mapped.emplace_back(joined_table_by_name.at(table_name));
             }
         });
 
+        std::reverse(joined_columns_mapped.begin(), joined_columns_mapped.end());
+
         return joined_columns_mapped;
     }
 
@@ -895,19 +1278,18 @@ private:
      * @param entity Сущность в которой находится связанное поле
      */
     template<typename Column_, typename Entity_>
-    static void parse_property_after_insert(Column_& column, const database_adapter::query_result::row& query_result, Entity_& entity)
+    static void parse_property_after_insert(Column_& column, const database_adapter::query_result::row_view& query_result, Entity_& entity)
     {
         const auto column_info = column.column_info();
 
-        auto property = column.property();
+        const auto column_index = query_result.column_index(column_info.name());
+        if(column_index == database_adapter::query_result::npos || query_result.is_null(column_index))
+            return;
 
-        const auto it = query_result.find(column_info.name());
-        if(it == query_result.end() || it->second == query_craft::column_info::null_value())
+        if(query_result.at(column_index) == query_craft::column_info::null_value())
             return;
 
-        auto property_value = property.empty_property();
-        property.property_converter()->fill_from_string(property_value, it->second);
-        property.set_value(entity, property_value);
+        column.fill_from_cell(entity, query_result, column_index);
     }
 
     /**
@@ -917,7 +1299,7 @@ private:
      * @param query_result Результат запроса
      */
     template<typename ClassType_, typename... ClassColumn_>
-    static void parse_entity_after_insert(ClassType_& entity, table<ClassType_, ClassColumn_...>& dto, const database_adapter::query_result::row& query_result)
+    static void parse_entity_after_insert(ClassType_& entity, table<ClassType_, ClassColumn_...>& dto, const database_adapter::query_result::row_view& query_result)
     {
         dto.for_each(visitor::make_any_column_visitor(
             [&entity, &query_result](auto& column) {
@@ -946,19 +1328,18 @@ private:
      * @param entity Сущность в которой находится связанное поле
      */
     template<typename Column_, typename Entity_>
-    static void parse_property_from_sql(Column_& column, const database_adapter::query_result::row& query_result, Entity_& entity)
+    static void parse_property_from_sql(Column_& column, const database_adapter::query_result::row_view& query_result, Entity_& entity)
     {
         const auto column_info = column.column_info();
 
-        auto property = column.property();
+        const auto column_index = query_result.column_index(column_info.alias());
+        if(column_index == database_adapter::query_result::npos || query_result.is_null(column_index))
+            return;
 
-        const auto it = query_result.find(column_info.alias());
-        if(it == query_result.end() || it->second == query_craft::column_info::null_value())
+        if(query_result.at(column_index) == query_craft::column_info::null_value())
             return;
 
-        auto property_value = property.empty_property();
-        property.property_converter()->fill_from_string(property_value, it->second);
-        property.set_value(entity, property_value);
+        column.fill_from_cell(entity, query_result, column_index);
     }
 
     /**
@@ -1027,89 +1408,153 @@ private:
 
 private:
     /**
-     * Заполнить сущность по данным из sql запроса
-     * @param dto DTO для заполнения
-     * @param query_result Результат запроса
-     * @param without_relation_entity Флаг на догрузку полей с типом связи one to many
-     * @return
+     * Получить декодер строк результата выборки для описания таблицы
+     * @param dto Описание таблицы
+     * @return Декодер, сформированный при первом вызове и общий для всех копий описания таблицы
      */
     template<typename JoinClassType, typename... JoinClassColumn>
-    JoinClassType parse_entity_from_sql(table<JoinClassType, JoinClassColumn...>& dto,
-        const database_adapter::query_result::row& query_result,
-        bool without_relation_entity)
+    static const std::shared_ptr<const entity_decoder<JoinClassType>>& cached_decoder(const table<JoinClassType, JoinClassColumn...>& dto)
     {
-        auto entity = dto.empty_entity();
+        return dto.cached_decoder([&dto]() {
+            return make_entity_decoder(dto);
+        });
+    }
+
+    /**
+     * Сформировать декодер строк результата выборки
+     * Для каждой колонки заводится слот по её псевдониму, для связей заранее вычисляются слоты колонок соединения
+     * и подключаются декодеры связанных таблиц. Для связей one to many добавляются шаги склейки сущностей по primary_key
+     * @param dto Описание таблицы
+     * @return Декодер строк результата выборки
+     */
+    template<typename JoinClassType, typename... JoinClassColumn>
+    static std::shared_ptr<const entity_decoder<JoinClassType>> make_entity_decoder(const table<JoinClassType, JoinClassColumn...>& dto)
+    {
+        using row_view = database_adapter::query_result::row_view;
+        using connection = std::shared_ptr<database_adapter::IConnection>;
+
+        auto decoder = std::make_shared<entity_decoder<JoinClassType>>();
 
         dto.for_each(visitor::make_any_column_visitor(
-            [&entity, &query_result](auto& column) {
-                parse_property_from_sql(column, query_result, entity);
+            [&decoder](auto& column) {
+                const size_t slot = decoder->add_slot(column.column_info().alias());
+                decoder->add_step([column, slot](JoinClassType& entity, const row_view& row, const size_t* positions, const connection& /*database*/) {
+                    const auto column_index = positions[slot];
+                    if(column_index == database_adapter::query_result::npos || row.is_null(column_index))
+                        return;
+
+                    if(row.at(column_index) == query_craft::column_info::null_value())
+                        return;
+
+                    column.fill_from_cell(entity, row, column_index);
+                });
             },
-            [this, &entity, &query_result, &without_relation_entity, &dto](auto& reference_column) {
-                auto reference_propery = reference_column.property();
+            [&decoder, &dto](auto& reference_column) {
                 auto reference_table = reference_column.reference_table();
+                using reference_entity_type = decltype(reference_table.empty_entity());
 
-                auto reference_entity = this->parse_entity_from_sql(reference_table, query_result, without_relation_entity);
+                const auto reference_decoder = cached_decoder(reference_table);
+                const size_t reference_offset = decoder->add_slots(reference_decoder->aliases());
 
-                // Флаг для проверки на то что связанная сущность существует
-                bool isValid = true;
-                reference_table.for_each([&reference_entity, &isValid](const auto& column) {
-                    auto reference_column_info = column.column_info();
-                    if(!reference_column_info.has_settings(query_craft::column_settings::primary_key))
+                // Проверка на то что связанная сущность существует
+                std::function<bool(const reference_entity_type&)> has_primary_key = [](const reference_entity_type&) {
+                    return true;
+                };
+                reference_table.for_each([&has_primary_key](const auto& column) {
+                    if(!column.column_info().has_settings(query_craft::column_settings::primary_key))
                         return;
 
-                    const auto reference_propery_value = column.property().value(reference_entity);
-                    isValid = !column.null_cheker()->is_null(reference_propery_value);
+                    has_primary_key = [property = column.property(), null_cheker = column.null_cheker()](const reference_entity_type& reference_entity) {
+                        return !null_cheker->is_null(property.value(reference_entity));
+                    };
                 });
-                if(!isValid) {
-                    return;
-                }
 
-                std::string target_column_alias;
-                std::string joined_column_alias;
+                size_t target_slot = 0;
+                size_t joined_slot = 0;
                 switch(reference_column.type()) {
                     case relation_type::one_to_one:
                     case relation_type::many_to_one: {
-                        target_column_alias = reference_column.column_info().alias();
-                        joined_column_alias = primary_key_column(reference_table).alias();
+                        target_slot = decoder->add_slot(reference_column.column_info().alias());
+                        joined_slot = decoder->add_slot(primary_key_column(reference_table).alias());
                         break;
                     }
                     case relation_type::one_to_many:
                     case relation_type::one_to_one_inverted: {
-                        target_column_alias = primary_key_column(dto).alias();
-                        joined_column_alias = reference_table.table_info().column(reference_column.column_info().name()).alias();
+                        target_slot = decoder->add_slot(primary_key_column(dto).alias());
+                        joined_slot = decoder->add_slot(reference_table.table_info().column(reference_column.column_info().name()).alias());
                         break;
                     }
                 }
 
-                // Проверка что сущность была присоединена по нужному ключу
-                if(query_result.at(target_column_alias) != query_result.at(joined_column_alias)) {
-                    return;
-                }
+                decoder->add_step([reference_decoder,
+                                      reference_offset,
+                                      has_primary_key,
+                                      target_slot,
+                                      joined_slot,
+                                      type = reference_column.type(),
+                                      reference_propery = reference_column.property(),
+                                      inserter = reference_column.inserter(),
+                                      empty_property = reference_column.empty_property(),
+                                      reference_table](JoinClassType& entity, const row_view& row, const size_t* positions, const connection& database) {
+                    const auto target_index = positions[target_slot];
+                    const auto joined_index = positions[joined_slot];
+                    // Связанная таблица не участвовала в выборке
+                    if(target_index == database_adapter::query_result::npos || joined_index == database_adapter::query_result::npos) {
+                        return;
+                    }
 
-                if(reference_table.has_reques_callback()) {
-                    reference_table.reques_callback()->post_request_callback(reference_entity, request_callback_type::select, _database);
-                }
+                    auto reference_entity = reference_decoder->decode(row, positions + reference_offset, database);
+                    if(!has_primary_key(reference_entity)) {
+                        return;
+                    }
 
-                switch(reference_column.type()) {
-                    case relation_type::many_to_one:
-                    case relation_type::one_to_one_inverted:
-                    case relation_type::one_to_one: {
-                        reference_propery.set_value(entity, reference_entity);
-                        break;
+                    // Проверка что сущность была присоединена по нужному ключу
+                    if(row.at(target_index) != row.at(joined_index)) {
+                        return;
                     }
-                    case relation_type::one_to_many: {
-                        std::vector<decltype(reference_entity)> reference_entity_container;
-                        reference_entity_container.emplace_back(reference_entity);
-                        auto property_value = reference_column.empty_property();
-                        reference_column.inserter().convert_to_target(property_value, reference_entity_container);
 
-                        reference_propery.set_value(entity, property_value);
-                        break;
+                    if(reference_table.has_reques_callback()) {
+                        reference_table.reques_callback()->post_request_callback(reference_entity, request_callback_type::select, database);
                     }
+
+                    switch(type) {
+                        case relation_type::many_to_one:
+                        case relation_type::one_to_one_inverted:
+                        case relation_type::one_to_one: {
+                            reference_propery.set_value(entity, reference_entity);
+                            break;
+                        }
+                        case relation_type::one_to_many: {
+                            std::vector<reference_entity_type> reference_entity_container;
+                            reference_entity_container.emplace_back(std::move(reference_entity));
+                            auto property_value = empty_property;
+                            inserter.convert_to_target(property_value, reference_entity_container);
+
+                            reference_propery.set_value(entity, property_value);
+                            break;
+                        }
+                    }
+                });
+
+                if(reference_column.type() != relation_type::one_to_many) {
+                    return;
                 }
+
+                // Связанные сущности остальных сущностей группы переносятся в первую и склеиваются по своему primary_key
+                decoder->add_merge_step([reference_property = reference_column.property(),
+                                            inserter = reference_column.inserter(),
+                                            reference_table](typename entity_decoder<JoinClassType>::entity_iterator first, typename entity_decoder<JoinClassType>::entity_iterator last) {
+                    auto target_array = reference_property.take_value(*first);
+                    for(auto it = std::next(first); it != last; ++it) {
+                        inserter.move_to_target(target_array, reference_property.take_value(*it));
+                    }
+
+                    target_array = merge_result_by_id(target_array, reference_table, inserter);
+                    reference_property.move_value(*first, std::move(target_array));
+                });
             }));
 
-        return entity;
+        return decoder;
     }
 
     /**
@@ -1119,7 +1564,7 @@ private:
      * @param columns_for_update
      * @param row
      */
-    void prepare_to_update(const ClassType& value, query_craft::condition_group& condition_for_update, std::vector<query_craft::column_info>& columns_for_update, query_craft::sql_table::row& row)
+    void prepare_to_update(ClassType& value, query_craft::condition_group& condition_for_update, std::vector<query_craft::column_info>& columns_for_update, query_craft::sql_table::row& row)
     {
         _dto.for_each(visitor::make_any_column_visitor(
             [&row, &condition_for_update, &columns_for_update, &value](auto& column) {
@@ -1155,6 +1600,83 @@ private:
             }));
     }
 
+    /**
+     * Потоковая выборка сущностей
+     * @param callback Функция, которая вызывается для каждой полученной сущности
+     * @param use_export Использовать протокол выгрузки драйвера вместо обычного выполнения запроса
+     */
+    template<typename Callback>
+    void stream_select(Callback&& callback, const bool use_export)
+    {
+        const bool without_relation_entity = _without_relation_entity;
+
+        if(!without_relation_entity) {
+            _sortColumns.emplace_back(query_craft::asc_sort(cached_plan().primary_key));
+        }
+
+        auto parameters = make_parameters();
+        const auto sql = use_export ? select_literal_query() : select_query(parameters, false);
+
+        clear_select_settings();
+
+        // Сущности с одинаковым primary_key, которые нужно склеить перед передачей в callback
+        std::vector<ClassType> group;
+
+        auto flush_group = [this, &group, &callback]() {
+            if(group.empty()) {
+                return;
+            }
+
+            auto merged = merge_result_by_id(group, _dto, type_converter_api::container_converter<std::vector<ClassType>>());
+            for(auto& entity : merged) {
+                callback(entity);
+            }
+
+            group.clear();
+        };
+
+        const auto& decoder = cached_decoder(_dto);
+        // Номера колонок вычисляются по первой строке, все строки потока имеют одинаковый набор колонок
+        std::vector<size_t> positions;
+
+        const auto on_row = [this, &callback, &group, &flush_group, &decoder, &positions, without_relation_entity](const database_adapter::query_result::row_view& row) {
+            if(positions.empty()) {
+                positions = decoder->bind(row);
+            }
+
+            auto entity = decoder->decode(row, positions.data(), _database);
+            if(_dto.has_reques_callback()) {
+                _dto.reques_callback()->post_request_callback(entity, request_callback_type::select, _database);
+            }
+
+            if(without_relation_entity) {
+                callback(entity);
+                return;
+            }
+
+            if(!group.empty() && !has_same_primary_key(group.front(), entity, _dto)) {
+                flush_group();
+            }
+
+            group.emplace_back(std::move(entity));
+        };
+
+        // Функции обратного вызова таблиц получают соединение и могут выполнять через него запросы,
+        // что невозможно пока соединение занято потоковой выборкой. Поэтому результат сначала читается целиком
+        if(cached_plan().has_request_callbacks) {
+            const auto result = use_export ? _database->exec(sql) : _database->exec_prepared(sql, parameters.values());
+            for(const auto& row : result) {
+                on_row(row);
+            }
+        } else if(use_export) {
+            _database->export_stream(sql, on_row);
+        } else {
+            _database->exec_stream(sql, parameters.values(), on_row);
+        }
+
+        flush_group();
+    }
+
     /**
      * Функция для подготовки данных для генерации запросов на вставку
      * Так же функция занимается добавлением объектов с типом связи many_to_one или one_to_one
@@ -1167,27 +1689,75 @@ private:
         std::vector<query_craft::column_info>& columns_for_returning,
         query_craft::sql_table& sql_table, ClassType& value)
     {
-        // Переменная чтобы только один раз записать названия колонок для вставки
-        bool need_update_column_for_insert = columns_for_insert.empty();
-        bool need_update_column_returning = columns_for_returning.empty();
+        // Названия колонок записываются только один раз
+        if(columns_for_insert.empty() && columns_for_returning.empty()) {
+            prepare_insert_columns(columns_for_insert, columns_for_returning);
+        }
 
         query_craft::sql_table::row row;
+        prepare_insert_row(value, row, true);
+
+        sql_table.add_row(row);
+    }
+
+    /// Проверка есть ли у таблицы связи, объекты которых вставляются каскадно вместе с объектом
+    bool has_cascade_insert()
+    {
+        bool has_cascade = false;
+        _dto.for_each(visitor::make_reference_column_visitor([&has_cascade](auto& reference_column) {
+            if(reference_column.has_cascade(cascade_type::all) || reference_column.has_cascade(cascade_type::persist)) {
+                has_cascade = true;
+            }
+        }));
+
+        return has_cascade;
+    }
 
+    /**
+     * Функция для получения списка колонок для генерации запросов на вставку
+     * @param columns_for_insert Список колонок которые будут использоваться для генерации INSERT запроса
+     * @param columns_for_returning Список колонок которые необходимо вернуть после вставки
+     */
+    void prepare_insert_columns(std::vector<query_craft::column_info>& columns_for_insert, std::vector<query_craft::column_info>& columns_for_returning)
+    {
         _dto.for_each(visitor::make_any_column_visitor(
-            [this, &row, &value, &need_update_column_for_insert, &columns_for_insert, &need_update_column_returning, &columns_for_returning](auto& column) {
+            [&columns_for_insert, &columns_for_returning](auto& column) {
                 const auto column_info = column.column_info();
 
-                if(need_update_column_returning) {
-                    columns_for_returning.emplace_back(column.column_info());
-                }
+                columns_for_returning.emplace_back(column_info);
 
                 if(column_info.has_settings(query_craft::column_settings::auto_increment)) {
                     return;
                 }
 
-                if(need_update_column_for_insert) {
-                    // Добавляем имена колонок для блока INSERT INTO (column1, column2, ...);
-                    columns_for_insert.emplace_back(column.column_info());
+                // Добавляем имена колонок для блока INSERT INTO (column1, column2, ...);
+                columns_for_insert.emplace_back(column_info);
+            },
+            [&columns_for_insert](auto& reference_column) {
+                if(reference_column.type() != relation_type::many_to_one && reference_column.type() != relation_type::one_to_one) {
+                    return;
+                }
+
+                // Добавляем эту колонку так как при таком типе связи ссылочная информация хранится в текущей таблице а не в ссылочной
+                columns_for_insert.emplace_back(reference_column.column_info());
+            }));
+    }
+
+    /**
+     * Функция для получения значений строки для вставки в порядке колонок prepare_insert_columns
+     * Так же функция занимается добавлением объектов с типом связи many_to_one или one_to_one
+     * @param value Значение типа из которого будут браться значение полей
+     * @param row Строка в которую будут добавлены значения
+     * @param with_cascade Разрешена ли каскадная вставка связанных объектов
+     */
+    void prepare_insert_row(ClassType& value, query_craft::sql_table::row& row, const bool with_cascade)
+    {
+        _dto.for_each(visitor::make_any_column_visitor(
+            [&row, &value](auto& column) {
+                const auto column_info = column.column_info();
+
+                if(column_info.has_settings(query_craft::column_settings::auto_increment)) {
+                    return;
                 }
 
                 auto property = column.property();
@@ -1205,24 +1775,16 @@ private:
                     row.emplace_back(property.property_converter()->convert_to_string(property_value));
                 }
             },
-            [this, &value, &row, &columns_for_insert, &need_update_column_for_insert](auto& reference_column) {
+            [this, &value, &row, with_cascade](auto& reference_column) {
                 // Обработка других типов отношений находится дальше,
                 // так как для корректности ссылок нужно сначала вставить объекты на которые будет создаваться ссылка
                 if(reference_column.type() != relation_type::many_to_one && reference_column.type() != relation_type::one_to_one) {
                     return;
                 }
 
-                if(need_update_column_for_insert) {
-                    // Добавляем имена колонок для блока INSERT INTO (column1, column2, ...);
-                    // Добавляем эту колонку так как при таком типе связи ссылочная информация хранится в текущей таблице а не в ссылочной
-                    columns_for_insert.emplace_back(reference_column.column_info());
-                }
-
-                bool cascade = reference_column.has_cascade(cascade_type::all) || reference_column.has_cascade(cascade_type::persist);
+                bool cascade = with_cascade && (reference_column.has_cascade(cascade_type::all) || reference_column.has_cascade(cascade_type::persist));
                 this->upsert_relation_property_with_type_one_to_one_or_many_to_one(reference_column, row, value, cascade);
             }));
-
-        sql_table.add_row(row);
     }
 
     /**
@@ -1243,8 +1805,17 @@ private:
         auto reference_table = reference_column.reference_table();
 
         // Если установлены права на каскадную вставку добавляем объект если у него не пустой primary_key
-        if(cascad) {
-            auto reference_storage = make_storage(_database, reference_table, false);
+        bool is_empty_property = false;
+        reference_table.for_each([&reference_property_value, &is_empty_property](const auto& column) {
+            if(!column.column_info().has_settings(query_craft::column_settings::primary_key)) {
+                return;
+            }
+
+            is_empty_property = column.null_cheker()->is_null(column.property().value(reference_property_value));
+        });
+
+        if(cascad && !is_empty_property) {
+            auto reference_storage = make_nested_storage(reference_table);
             reference_storage.upsert(reference_property_value);
             property.set_value(value, reference_property_value);
         }
@@ -1280,7 +1851,7 @@ private:
     void upsert_relation_property_with_type_one_to_one_inverted_or_one_to_many(ReferenceCoulmn_& reference_column, const ClassType& value)
     {
         auto reference_table = reference_column.reference_table();
-        auto reference_storage = make_storage(_database, reference_table, false);
+        auto reference_storage = make_nested_storage(reference_table);
 
         bool is_empty_property = false;
         auto property_value = reference_column.property().value(value);
@@ -1306,16 +1877,16 @@ private:
     /**
      * Функция для отслеживания и очистки удалённых связей
      * @param value Значение из которого будет браться информация для отслеживания
+     * @param old_state Текущее состояние значения в базе данных
      * @param reference_column Колонка из которой будет браться информация о связанной таблице
      */
     template<typename ReferenceCoulmn_>
-    void sync_deleted_reference(const ClassType& value, ReferenceCoulmn_& reference_column)
+    void sync_deleted_reference(const ClassType& value, const ClassType& old_state, ReferenceCoulmn_& reference_column)
     {
         auto reference_table = reference_column.reference_table();
-        auto reference_storage = make_storage(this->_database, reference_table, false);
+        auto reference_storage = make_nested_storage(reference_table);
 
         const auto property_value = reference_column.property().value(value);
-        const auto old_state = get_old_state(value);
 
         auto removed_items = check_need_remove(reference_column.property().value(old_state), property_value, reference_table);
 
@@ -1329,16 +1900,16 @@ private:
     /**
      * Функция для отслеживания и очистки удалённых связей
      * @param value Значение из которого будет браться информация для отслеживания
+     * @param old_state Текущее состояние значения в базе данных
      * @param reference_column Колонка из которой будет браться информация о связанной таблице
      */
-    template<typename Value_, typename ReferenceCoulmn_>
-    void update_deleted_reference(const Value_& value, ReferenceCoulmn_& reference_column)
+    template<typename ReferenceCoulmn_>
+    void update_deleted_reference(const ClassType& value, const ClassType& old_state, ReferenceCoulmn_& reference_column)
     {
         auto reference_table = reference_column.reference_table();
-        auto reference_storage = make_storage(_database, reference_table, false);
+        auto reference_storage = make_nested_storage(reference_table);
 
         const auto property_value = reference_column.property().value(value);
-        const auto old_state = get_old_state(value);
 
         auto removed_items = check_need_remove(reference_column.property().value(old_state), property_value, reference_table);
 
@@ -1361,6 +1932,35 @@ private:
         reference_storage.update(removed_items);
     }
 
+    /**
+     * Получить текущее состояние в базе данных, прочитав его только при первом обращении
+     * @param value обновлённое сосотяние
+     * @param old_state Прочитанное ранее состояние, заполняется при первом обращении
+     * @return Текущее состояние в базе данных
+     */
+    const ClassType& cached_old_state(const ClassType& value, std::unique_ptr<ClassType>& old_state)
+    {
+        if(old_state == nullptr) {
+            old_state = std::make_unique<ClassType>(get_old_state(value));
+        }
+
+        return *old_state;
+    }
+
+    /**
+     * Создать хранилище связанной таблицы, работающее в транзакции и в режиме пакетного обновления текущего хранилища
+     * @param reference_table Описание связанной таблицы
+     */
+    template<typename Table_>
+    auto make_nested_storage(const Table_& reference_table) const
+    {
+        auto reference_storage = make_storage(_database, reference_table, false);
+        reference_storage._defer_updates = _defer_updates;
+        reference_storage._escape_backslashes = _escape_backslashes;
+
+        return reference_storage;
+    }
+
     /**
      * Получить текущее состояние в базе данных на основе обновленного значения
      * @param value обновлённое сосотяние
@@ -1402,6 +2002,10 @@ private:
     std::shared_ptr<database_adapter::IConnection> _database;
     table<ClassType, Columns...> _dto;
     bool _auto_commit;
+    /// @brief Откладывать запросы обновления до конца пакетного обновления
+    bool _defer_updates = false;
+    /// @brief Экранировать обратную косую черту в сохраняемых значениях
+    bool _escape_backslashes = true;
 
     // Настройки для select
     query_craft::condition_group _condition_group;
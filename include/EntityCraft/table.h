@@ -1,6 +1,8 @@
 #pragma once
 
+#include "entitydecoder.h"
 #include "requestcallback.h"
+#include "selectplan.h"
 
 #include <ReflectionApi/entity.h>
 
@@ -23,7 +25,7 @@ public:
         : _table_info(std::move(table_name), std::move(scheme))
         , _columns(std::make_tuple<Columns...>(std::move(properties)...))
     {
-        for_each([this](auto& column) {
+        reflection_api::helper::for_each(_columns, [this](auto& column) {
             try {
                 // При отношениях one to many/one to one inverted может происходить дублирования колонок при
                 _table_info.add_column(column.mutable_column_info());
@@ -41,25 +43,46 @@ public:
     table& operator=(const table& other) = default;
     table& operator=(table&& other) noexcept = default;
 
+    /**
+     * Изменить колонку свойства с заданным именем
+     * @note План выборки и декодер этой таблицы формируются заново, копии таблицы продолжают использовать прежние
+     */
     template<typename Action_>
     void visit_property(const std::string& property_name, Action_&& action)
     {
+        reset_caches();
+
         reflection_api::helper::perform_if(
             _columns,
             [&](const auto& column) {
-                return column.name() == property_name;
+                return column.property().name() == property_name;
             },
             std::forward<Action_>(action));
     }
 
+    /// Обойти колонки таблицы без возможности их изменения
     template<typename Action_>
-    void for_each(Action_&& action)
+    void for_each(Action_&& action) const
     {
         reflection_api::helper::for_each(
             _columns,
             std::forward<Action_>(action));
     }
 
+    /**
+     * Обойти колонки таблицы с возможностью их изменения
+     * @note План выборки и декодер этой таблицы формируются заново, копии таблицы продолжают использовать прежние
+     */
+    template<typename Action_>
+    void mutable_for_each(Action_&& action)
+    {
+        reset_caches();
+
+        reflection_api::helper::for_each(
+            _columns,
+            std::forward<Action_>(action));
+    }
+
     query_craft::table table_info() const
     {
         return _table_info;
@@ -77,6 +100,9 @@ public:
 
     table& set_reques_callback(const std::shared_ptr<IRequestCallback<ClassType>>& reques_callback)
     {
+        // План выборки хранит признак наличия функций обратного вызова
+        reset_caches();
+
         _reques_callback = reques_callback;
         return *this;
     }
@@ -86,12 +112,60 @@ public:
         return _reques_callback != nullptr;
     }
 
+    /**
+     * Получить план выборки, при первом вызове план формируется функцией build
+     * @param build Функция формирования плана
+     * @return План выборки, общий для копий таблицы, которые не изменялись после копирования
+     * @note Потокобезопасно, план формируется только один раз
+     */
+    template<typename Build_>
+    const select_plan& cached_select_plan(Build_&& build) const
+    {
+        auto& cache = *_select_plan;
+        std::call_once(cache.once, [&cache, &build]() {
+            cache.plan = build();
+        });
+
+        return cache.plan;
+    }
+
+    /**
+     * Получить декодер строк результата выборки, при первом вызове декодер формируется функцией build
+     * @param build Функция формирования декодера
+     * @return Декодер, общий для копий таблицы, которые не изменялись после копирования
+     * @note Потокобезопасно, декодер формируется только один раз
+     */
+    template<typename Build_>
+    const std::shared_ptr<const entity_decoder<ClassType>>& cached_decoder(Build_&& build) const
+    {
+        auto& cache = *_decoder;
+        std::call_once(cache.once, [&cache, &build]() {
+            cache.decoder = build();
+        });
+
+        return cache.decoder;
+    }
+
+private:
+    /// Отвязать таблицу от плана выборки и декодера, которые разделяют её копии
+    void reset_caches()
+    {
+        _select_plan = std::make_shared<select_plan_cache>();
+        _decoder = std::make_shared<entity_decoder_cache<ClassType>>();
+    }
+
 private:
     query_craft::table _table_info;
     std::tuple<Columns...> _columns = {};
     std::vector<query_craft::column_info> _duplicate_column;
 
     std::shared_ptr<IRequestCallback<ClassType>> _reques_callback = nullptr;
+
+    /// План выборки, указатель копируется вместе с таблицей, поэтому план вычисляется один раз для описания таблицы.
+    /// При изменении таблицы указатель заменяется, чтобы не влиять на копии
+    std::shared_ptr<select_plan_cache> _select_plan = std::make_shared<select_plan_cache>();
+    /// Декодер строк результата выборки, разделяется копиями таблицы так же как план выборки
+    std::shared_ptr<entity_decoder_cache<ClassType>> _decoder = std::make_shared<entity_decoder_cache<ClassType>>();
 };
 
 template<typename ClassType, typename... Properties>
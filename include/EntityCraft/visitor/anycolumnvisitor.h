@@ -27,6 +27,15 @@ public:
         _column_action(column);
     }
 
+    template<typename ClassType,
+        typename PropertyType,
+        typename Setter,
+        typename Getter>
+    void operator()(const column<ClassType, PropertyType, Setter, Getter>& column)
+    {
+        _column_action(column);
+    }
+
     template<typename ClassType,
         typename PropertyType,
         typename Setter,
@@ -37,6 +46,16 @@ public:
         _reference_column_action(reference_column);
     }
 
+    template<typename ClassType,
+        typename PropertyType,
+        typename Setter,
+        typename Getter,
+        typename... ReferenceColumns>
+    void operator()(const reference_column<ClassType, PropertyType, Setter, Getter, ReferenceColumns...>& reference_column)
+    {
+        _reference_column_action(reference_column);
+    }
+
 private:
     ColumnAction _column_action;
     ReferenceColumnAction _reference_column_action;
@@ -26,6 +26,15 @@ public:
         _column_action(column);
     }
 
+    template<typename ClassType,
+        typename PropertyType,
+        typename Setter,
+        typename Getter>
+    void operator()(const column<ClassType, PropertyType, Setter, Getter>& column)
+    {
+        _column_action(column);
+    }
+
     template<typename ClassType,
         typename PropertyType,
         typename Setter,
@@ -35,6 +44,15 @@ public:
     {
     }
 
+    template<typename ClassType,
+        typename PropertyType,
+        typename Setter,
+        typename Getter,
+        typename... ReferenceColumns>
+    void operator()(const reference_column<ClassType, PropertyType, Setter, Getter, ReferenceColumns...>& /*reference_column*/)
+    {
+    }
+
 private:
     ColumnAction _column_action;
 };
@@ -25,6 +25,14 @@ public:
     {
     }
 
+    template<typename ClassType,
+        typename PropertyType,
+        typename Setter,
+        typename Getter>
+    void operator()(const column<ClassType, PropertyType, Setter, Getter>& /*column*/)
+    {
+    }
+
     template<typename ClassType,
         typename PropertyType,
         typename Setter,
@@ -35,6 +43,16 @@ public:
         _reference_column_action(reference_column);
     }
 
+    template<typename ClassType,
+        typename PropertyType,
+        typename Setter,
+        typename Getter,
+        typename... ReferenceColumns>
+    void operator()(const reference_column<ClassType, PropertyType, Setter, Getter, ReferenceColumns...>& reference_column)
+    {
+        _reference_column_action(reference_column);
+    }
+
 private:
     ReferenceColumnAction _reference_column_action;
 };
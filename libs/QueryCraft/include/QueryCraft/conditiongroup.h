@@ -10,6 +10,7 @@
 #include "operator/moreorequalsoperator.h"
 #include "operator/notequalsoperator.h"
 #include "operator/notinoperator.h"
+#include "sqlparameters.h"
 
 #include <TypeConverterApi/typeconverterapi.h>
 
@@ -401,6 +402,14 @@ struct condition_group
          */
         std::string unwrap(condion_view_type view_type = condion_view_type::name) const;
 
+        /**
+         * Возвращает параметризованное представление текущего условия.
+         * @param parameters Параметры запроса, в которые будут добавлены значения условия.
+         * @param view_type Настройки для отображения названия колонки.
+         * @return Строковое представление текущего условия, где значения заменены на placeholder.
+         */
+        std::string unwrap(sql_parameters& parameters, condion_view_type view_type = condion_view_type::name) const;
+
         /**
          * Возвращает информацию о столбце текущего условия.
          * @return Объект ColumnInfo, содержащий информацию о столбце.
@@ -425,6 +434,17 @@ struct condition_group
          */
         bool is_valid() const;
 
+    private:
+        friend struct condition_group;
+
+        /**
+         * Формирует строковое представление условия.
+         * @param view_type Настройки для отображения названия колонки.
+         * @param parameters Параметры запроса. Если nullptr, то значения подставляются в запрос напрямую.
+         * @return Строковое представление текущего условия.
+         */
+        std::string unwrap_condition(condion_view_type view_type, sql_parameters* parameters) const;
+
     private:
         std::shared_ptr<operators::IOperator> _condition_operator {};
         column _column {};
@@ -484,6 +504,15 @@ struct condition_group
      */
     std::string unwrap(condion_view_type view_type = condion_view_type::name, bool compressed = true) const;
 
+    /**
+     * Возвращает параметризованное представление текущего условия.
+     * @param parameters Параметры запроса, в которые будут добавлены значения условий.
+     * @param view_type Настройки для отображения названия колонки.
+     * @param compressed Сжать выходную строку, если это возможно.
+     * @return Строковое представление текущего условия, где значения заменены на placeholder.
+     */
+    std::string unwrap(sql_parameters& parameters, condion_view_type view_type = condion_view_type::name, bool compressed = true) const;
+
     /**
      * Проверяет, является ли текущее условие валидным.
      * @return true, если было создано условие, иначе false.
@@ -503,8 +532,9 @@ private:
      * @param stream Строковый поток, куда будут добавляться условия.
      * @param view_type Настройки для отображения названия колонки.
      * @param compressed Сжать выходную строку.
+     * @param parameters Параметры запроса. Если nullptr, то значения подставляются в запрос напрямую.
      */
-    static void unwrap_tree(const condition_group* node, std::stringstream& stream, condion_view_type view_type, bool compressed);
+    static void unwrap_tree(const condition_group* node, std::stringstream& stream, condion_view_type view_type, bool compressed, sql_parameters* parameters);
 
 private:
     /**
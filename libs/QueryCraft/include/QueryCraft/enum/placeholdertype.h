@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace query_craft {
+
+/// @brief Перечисление форматов обозначения параметров в параметризованных запросах.
+enum class placeholder_type : uint8_t
+{
+    /// Параметры обозначаются знаком вопроса (?). Используется в sqlite.
+    question,
+    /// Параметры обозначаются порядковым номером ($1, $2, ...). Используется в PostgreSQL.
+    numbered
+};
+
+} // namespace query_craft
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace query_craft {
+namespace helper {
+
+/**
+ * @brief Реализации поиска символов, требующих экранирования.
+ */
+enum class escape_kernel : uint8_t
+{
+    /// Побайтовый поиск, доступен на любой платформе.
+    scalar,
+
+    /// Поиск по 16 байт инструкциями SSE2.
+    sse2,
+
+    /// Поиск по 32 байта инструкциями AVX2.
+    avx2
+};
+
+/**
+ * @brief Лучшая реализация, поддерживаемая процессором. Определяется один раз при первом вызове.
+ */
+escape_kernel best_escape_kernel();
+
+/**
+ * @brief Проверка, поддерживается ли реализация процессором и компилятором.
+ */
+bool is_escape_kernel_supported(escape_kernel kernel);
+
+/**
+ * @brief Размер значения после экранирования, без обрамляющих кавычек.
+ *
+ * Одинарная кавычка удваивается, обратная косая черта удваивается, если за ней не следует двойная кавычка (экранирование json).
+ *
+ * @param data Начало значения.
+ * @param size Размер значения в байтах.
+ * @param kernel Реализация поиска, должна поддерживаться процессором.
+ */
+size_t escaped_literal_size(const char* data, size_t size, escape_kernel kernel = best_escape_kernel());
+
+/**
+ * @brief Запись экранированного значения без обрамляющих кавычек.
+ *
+ * Участки без специальных символов копируются целиком.
+ *
+ * @param data Начало значения.
+ * @param size Размер значения в байтах.
+ * @param output Буфер размером не меньше escaped_literal_size().
+ * @param kernel Реализация поиска, должна поддерживаться процессором.
+ * @return Указатель на байт после последнего записанного.
+ */
+char* escape_literal(const char* data, size_t size, char* output, escape_kernel kernel = best_escape_kernel());
+
+/**
+ * @brief Значение с удвоенной обратной косой чертой, за которой не следует двойная кавычка.
+ *
+ * Передача такого значения параметром сохраняет в базе то же, что и подстановка экранированного литерала.
+ *
+ * @param value Исходное значение.
+ */
+std::string escape_backslashes(const std::string& value);
+
+} // namespace helper
+} // namespace query_craft
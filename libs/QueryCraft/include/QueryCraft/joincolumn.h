@@ -1,5 +1,6 @@
 #pragma once
 
+#include "sqlbuilder.h"
 #include "table.h"
 
 #include <cstdint>
@@ -37,4 +38,12 @@ struct join_column
 
 std::ostream& operator<<(std::ostream& os, const join_column& obj);
 
+/**
+ * Добавление соединения в запрос в том же виде, что и operator<<.
+ *
+ * @param builder Запрос.
+ * @param obj     Соединение.
+ */
+void append_join(sql_builder& builder, const join_column& obj);
+
 } // namespace query_craft
\ No newline at end of file
@@ -3,8 +3,12 @@
 #include "conditiongroup.h"
 #include "enum/conditionviewtype.h"
 #include "enum/logicaloperator.h"
+#include "enum/placeholdertype.h"
 #include "operator/ioperator.h"
 #include "sortcolumn.h"
+#include "sqlbuilder.h"
+#include "sqlfingerprint.h"
+#include "sqlparameters.h"
 #include "sqltable.h"
 #include "table.h"
 
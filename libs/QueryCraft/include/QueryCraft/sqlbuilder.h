@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace query_craft {
+
+/// Класс, формирующий текст запроса в одном буфере.
+/// Буфер сохраняет выделенную память между запросами, поэтому один объект можно переиспользовать для формирования множества запросов.
+class sql_builder
+{
+public:
+    sql_builder() = default;
+
+    /**
+     * Конструктор с резервированием памяти.
+     *
+     * @param capacity Ожидаемый размер запроса в байтах.
+     */
+    explicit sql_builder(size_t capacity);
+
+    /// Резервирование памяти под запрос ожидаемого размера.
+    void reserve(size_t capacity);
+
+    /// Удаление текста запроса с сохранением выделенной памяти.
+    void clear();
+
+    /// Добавление фрагмента запроса.
+    sql_builder& append(const char* data, size_t size);
+
+    /// Добавление фрагмента запроса.
+    sql_builder& append(const std::string& value);
+
+    /// Добавление строкового литерала без вычисления его длины.
+    template<size_t Size>
+    sql_builder& append(const char (&literal)[Size])
+    {
+        return append(literal, Size - 1);
+    }
+
+    /// Добавление символа.
+    sql_builder& append(char symbol);
+
+    /// Добавление целого числа в десятичной записи.
+    sql_builder& append_number(size_t value);
+
+    /// Добавление имени в двойных кавычках.
+    sql_builder& append_identifier(const std::string& name);
+
+    /**
+     * Добавление значения как строкового литерала в одинарных кавычках с экранированием.
+     *
+     * @param value Значение.
+     * @note Значение column_info::null_value() добавляется как NULL без кавычек.
+     */
+    sql_builder& append_literal(const std::string& value);
+
+    /// Текст запроса.
+    const std::string& str() const;
+
+    /// Размер текста запроса.
+    size_t size() const;
+
+    /**
+     * Передача текста запроса без копирования.
+     *
+     * @return Текст запроса. После вызова буфер пуст и не имеет выделенной памяти.
+     */
+    std::string release();
+
+private:
+    std::string _buffer {};
+};
+
+} // namespace query_craft
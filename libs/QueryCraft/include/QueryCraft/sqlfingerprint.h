@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace query_craft {
+
+/**
+ * Приведение запроса к форме, не зависящей от значений.
+ *
+ * Строковые и числовые литералы, NULL, TRUE, FALSE и параметры ($1, ?, ?1, :name, @name) заменяются на ?,
+ * списки из одних значений (IN (1, 2, 3), строки VALUES) сворачиваются в (...), повторяющиеся строки VALUES
+ * отбрасываются, комментарии удаляются, ключевые слова и идентификаторы без кавычек переводятся в верхний регистр,
+ * а пробелы остаются только между словами.
+ *
+ * @param query Текст запроса.
+ * @return Форма запроса, например "SELECT * FROM A WHERE ID IN(...)AND NAME=?".
+ */
+std::string sql_shape(const std::string& query);
+
+/**
+ * Отпечаток запроса - хэш FNV-1a 64 его формы (см. sql_shape).
+ * Запросы, различающиеся только значениями, размером списков и пробелами, имеют одинаковый отпечаток.
+ *
+ * @param query Текст запроса.
+ */
+uint64_t sql_fingerprint(const std::string& query);
+
+} // namespace query_craft
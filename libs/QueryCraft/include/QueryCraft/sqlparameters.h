@@ -0,0 +1,73 @@
+#pragma once
+
+#include "enum/placeholdertype.h"
+#include "sqlbuilder.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace query_craft {
+
+/// Класс, накапливающий значения параметров при генерации параметризованного запроса.
+/// Вместо значения в запрос записывается placeholder, а само значение сохраняется в порядке следования в запросе.
+class sql_parameters
+{
+public:
+    /**
+     * Конструктор с указанием формата placeholder.
+     *
+     * @param type Формат обозначения параметров в запросе.
+     * @param escape_backslashes Удваивать обратную косую черту в значениях колонок так же, как при подстановке литералов.
+     */
+    explicit sql_parameters(placeholder_type type = placeholder_type::question, bool escape_backslashes = true);
+
+    /**
+     * Добавление значения параметра.
+     *
+     * @param stream Поток, в который записывается placeholder.
+     * @param value  Значение параметра.
+     * @note Значение column_info::null_value() передаётся как NULL.
+     */
+    void bind(std::ostream& stream, const std::string& value);
+
+    /**
+     * Добавление значения параметра.
+     *
+     * @param builder Запрос, в который записывается placeholder.
+     * @param value   Значение параметра.
+     */
+    void bind(sql_builder& builder, const std::string& value);
+
+    /**
+     * Добавление значения колонки для вставки или обновления.
+     * Если включено экранирование, обратная косая черта удваивается, если за ней не следует двойная кавычка,
+     * чтобы в базу попадало то же значение, что и при подстановке литерала.
+     *
+     * @param builder Запрос, в который записывается placeholder.
+     * @param value   Значение колонки.
+     */
+    void bind_value(sql_builder& builder, const std::string& value);
+
+    /// Удваивается ли обратная косая черта в значениях колонок.
+    bool escape_backslashes() const;
+
+    /// Формат обозначения параметров в запросе.
+    placeholder_type type() const;
+
+    /// Значения параметров в порядке их следования в запросе.
+    const std::vector<std::string>& values() const;
+
+    /// Количество добавленных параметров.
+    size_t size() const;
+
+    /// Удаление всех добавленных параметров.
+    void clear();
+
+private:
+    placeholder_type _type;
+    bool _escape_backslashes;
+    std::vector<std::string> _values {};
+};
+
+} // namespace query_craft
@@ -2,7 +2,9 @@
 
 #include "helper/tuplehelper.h"
 #include "joincolumn.h"
+#include "sqlbuilder.h"
 #include "sortcolumn.h"
+#include "sqlparameters.h"
 #include "table.h"
 
 namespace query_craft {
@@ -130,6 +132,41 @@ public:
      */
     std::string insert_sql(const std::vector<column_info>& columns = {}, bool need_returning = false, const std::vector<column_info>& returning_columns = {});
 
+    /**
+     * Генерация параметризованного SQL-запроса для вставки строки в таблицу.
+     *
+     * @param parameters Параметры запроса, в которые будут добавлены вставляемые значения.
+     * @param columns Столбцы для вставки. По умолчанию все столбцы.
+     * @param need_returning Флаг означающий что в конце запроса необходимо вернуть вставленные колонки
+     * @param returning_columns Колонки которые необходимо вернуть после вставки
+     * @return SQL-запрос для вставки, в котором значения заменены на placeholder.
+     * @note Очищает добавленные строки
+     */
+    std::string insert_sql(sql_parameters& parameters, const std::vector<column_info>& columns = {}, bool need_returning = false, const std::vector<column_info>& returning_columns = {});
+
+    /**
+     * Генерация SQL-запроса для вставки строки в таблицу в переиспользуемый буфер.
+     *
+     * @param builder Буфер запроса. Предыдущее содержимое удаляется, выделенная память переиспользуется.
+     * @param columns Столбцы для вставки. По умолчанию все столбцы.
+     * @param need_returning Флаг означающий что в конце запроса необходимо вернуть вставленные колонки
+     * @param returning_columns Колонки которые необходимо вернуть после вставки
+     * @note Очищает добавленные строки
+     */
+    void insert_sql(sql_builder& builder, const std::vector<column_info>& columns = {}, bool need_returning = false, const std::vector<column_info>& returning_columns = {});
+
+    /**
+     * Генерация параметризованного SQL-запроса для вставки строки в таблицу в переиспользуемый буфер.
+     *
+     * @param builder Буфер запроса. Предыдущее содержимое удаляется, выделенная память переиспользуется.
+     * @param parameters Параметры запроса, в которые будут добавлены вставляемые значения.
+     * @param columns Столбцы для вставки. По умолчанию все столбцы.
+     * @param need_returning Флаг означающий что в конце запроса необходимо вернуть вставленные колонки
+     * @param returning_columns Колонки которые необходимо вернуть после вставки
+     * @note Очищает добавленные строки
+     */
+    void insert_sql(sql_builder& builder, sql_parameters& parameters, const std::vector<column_info>& columns = {}, bool need_returning = false, const std::vector<column_info>& returning_columns = {});
+
     /**
      * Генерация SQL-запроса для обновления строки в таблице.
      *
@@ -151,6 +188,17 @@ public:
      */
     std::string update_sql(const condition_group& condition = {}, const std::vector<column_info>& columns = {});
 
+    /**
+     * Генерация параметризованного SQL-запроса для обновления строки в таблице.
+     *
+     * @param parameters Параметры запроса, в которые будут добавлены значения и значения условия.
+     * @param condition Условие для выбора строки.
+     * @param columns   Столбцы для обновления. По умолчанию все столбцы.
+     * @return SQL-запрос для обновления, в котором значения заменены на placeholder.
+     * @note Очищает добавленные строки
+     */
+    std::string update_sql(sql_parameters& parameters, const condition_group& condition = {}, const std::vector<column_info>& columns = {});
+
     /**
      * Генерация SQL-запроса для удаления строки из таблицы.
      *
@@ -159,6 +207,15 @@ public:
      */
     std::string remove_sql(const condition_group& condition = {}) const;
 
+    /**
+     * Генерация параметризованного SQL-запроса для удаления строки из таблицы.
+     *
+     * @param parameters Параметры запроса, в которые будут добавлены значения условия.
+     * @param condition Условие для выбора строки.
+     * @return SQL-запрос для удаления, в котором значения заменены на placeholder.
+     */
+    std::string remove_sql(sql_parameters& parameters, const condition_group& condition = {}) const;
+
     /**
      * Генерация SQL-запроса для выборки строк из таблицы.
      *
@@ -198,6 +255,27 @@ public:
         size_t offset = 0,
         const std::vector<column_info>& columns = {}) const;
 
+    /**
+     * Генерация параметризованного SQL-запроса для выборки строк из таблицы.
+     *
+     * @param parameters    Параметры запроса, в которые будут добавлены значения условия.
+     * @param join_columns   Информация о join соединениях
+     * @param condition     Условие для выбора строк.
+     * @param sort_columns   Информация о колонках необходимых для сортировок
+     * @param limit         Лимит выборки.
+     * @param offset        Смещение выборки.
+     * @param columns       Столбцы для выборки. По умолчанию все столбцы.
+     * @return SQL-запрос для выборки, в котором значения условия заменены на placeholder.
+     */
+    std::string select_sql(
+        sql_parameters& parameters,
+        const std::vector<join_column>& join_columns = {},
+        const condition_group& condition = {},
+        const std::vector<sort_column>& sort_columns = {},
+        size_t limit = 0,
+        size_t offset = 0,
+        const std::vector<column_info>& columns = {}) const;
+
     /**
      * Генерация SQL-запроса для выборки строк из таблицы c блокировкой.
      *
@@ -237,6 +315,48 @@ public:
         size_t offset = 0,
         const std::vector<column_info>& columns = {}) const;
 
+    /**
+     * Генерация параметризованного SQL-запроса для выборки строк из таблицы c блокировкой.
+     *
+     * @param parameters    Параметры запроса, в которые будут добавлены значения условия.
+     * @param join_columns   Информация о join соединениях
+     * @param condition     Условие для выбора строк.
+     * @param sort_columns   Информация о колонках необходимых для сортировок
+     * @param limit         Лимит выборки.
+     * @param offset        Смещение выборки.
+     * @param columns       Столбцы для выборки. По умолчанию все столбцы.
+     * @return SQL-запрос для выборки, в котором значения условия заменены на placeholder.
+     */
+    std::string select_for_update_sql(
+        sql_parameters& parameters,
+        const std::vector<join_column>& join_columns = {},
+        const condition_group& condition = {},
+        const std::vector<sort_column>& sort_columns = {},
+        size_t limit = 0,
+        size_t offset = 0,
+        const std::vector<column_info>& columns = {}) const;
+
+private:
+    /// Генерация запроса на вставку в builder. Если parameters равен nullptr, то значения подставляются в запрос напрямую.
+    void build_insert_sql(sql_builder& builder, sql_parameters* parameters, const std::vector<column_info>& columns, bool need_returning, const std::vector<column_info>& returning_columns);
+
+    /// Генерация запроса на обновление в builder. Если parameters равен nullptr, то значения подставляются в запрос напрямую.
+    void build_update_sql(sql_builder& builder, sql_parameters* parameters, const condition_group& condition, const std::vector<column_info>& columns);
+
+    /// Генерация запроса на удаление. Если parameters равен nullptr, то значения подставляются в запрос напрямую.
+    std::string build_remove_sql(sql_parameters* parameters, const condition_group& condition) const;
+
+    /// Генерация запроса на выборку, при for_update с блокировкой строк. Если parameters равен nullptr, то значения подставляются в запрос напрямую.
+    std::string build_select_sql(
+        sql_parameters* parameters,
+        const std::vector<join_column>& join_columns,
+        const condition_group& condition,
+        const std::vector<sort_column>& sort_columns,
+        size_t limit,
+        size_t offset,
+        const std::vector<column_info>& columns,
+        bool for_update) const;
+
 private:
     /// Вектор, содержащий строки таблицы.
     /// Каждая строка представляется в виде вектора значений столбцов.
@@ -181,6 +181,16 @@ condition_group condition_group::condition::operator||(const condition_group& rh
 }
 
 std::string condition_group::condition::unwrap(const condion_view_type view_type) const
+{
+    return unwrap_condition(view_type, nullptr);
+}
+
+std::string condition_group::condition::unwrap(sql_parameters& parameters, const condion_view_type view_type) const
+{
+    return unwrap_condition(view_type, &parameters);
+}
+
+std::string condition_group::condition::unwrap_condition(const condion_view_type view_type, sql_parameters* parameters) const
 {
     if(_values.empty())
         return "";
@@ -207,14 +217,19 @@ std::string condition_group::condition::unwrap(const condion_view_type view_type
     if(_condition_operator->need_bracket())
         stream << "(";
 
-    std::for_each(_values.begin(), _values.end(), [&stream, this](const auto& value) {
-        if(value != column::null_value() && _need_forging)
-            stream << "'";
+    std::for_each(_values.begin(), _values.end(), [&stream, parameters, this](const auto& value) {
+        // Ссылки на колонки и NULL остаются частью запроса, параметрами передаются только значения
+        if(parameters != nullptr && value != column::null_value() && _need_forging) {
+            parameters->bind(stream, value);
+        } else {
+            if(value != column::null_value() && _need_forging)
+                stream << "'";
 
-        stream << value;
+            stream << value;
 
-        if(value != column::null_value() && _need_forging)
-            stream << "'";
+            if(value != column::null_value() && _need_forging)
+                stream << "'";
+        }
 
         if(_condition_operator->need_bracket())
             stream << ", ";
@@ -310,7 +325,15 @@ condition_group condition_group::operator||(const condition& rhd) const
 std::string condition_group::unwrap(const condion_view_type view_type, const bool compressed) const
 {
     std::stringstream stream;
-    unwrap_tree(this, stream, view_type, compressed);
+    unwrap_tree(this, stream, view_type, compressed, nullptr);
+
+    return stream.str();
+}
+
+std::string condition_group::unwrap(sql_parameters& parameters, const condion_view_type view_type, const bool compressed) const
+{
+    std::stringstream stream;
+    unwrap_tree(this, stream, view_type, compressed, &parameters);
 
     return stream.str();
 }
@@ -325,17 +348,17 @@ bool condition_group::is_sheet() const
     return _left == _right && _left == nullptr;
 }
 
-void condition_group::unwrap_tree(const condition_group* node, std::stringstream& stream, const condion_view_type view_type, const bool compressed)
+void condition_group::unwrap_tree(const condition_group* node, std::stringstream& stream, const condion_view_type view_type, const bool compressed, sql_parameters* parameters)
 {
     if(node->is_sheet()) {
-        stream << std::get<1>(node->_node).unwrap(view_type);
+        stream << std::get<1>(node->_node).unwrap_condition(view_type, parameters);
         return;
     }
 
     stream << "(";
 
     if(node->_left != nullptr)
-        unwrap_tree(node->_left.get(), stream, view_type, compressed);
+        unwrap_tree(node->_left.get(), stream, view_type, compressed, parameters);
 
     if(!compressed)
         stream << "\n";
@@ -352,7 +375,7 @@ void condition_group::unwrap_tree(const condition_group* node, std::stringstream
     }
 
     if(node->_right != nullptr)
-        unwrap_tree(node->_right.get(), stream, view_type, compressed);
+        unwrap_tree(node->_right.get(), stream, view_type, compressed, parameters);
 
     stream << ")";
 }
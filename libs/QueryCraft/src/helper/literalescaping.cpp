@@ -0,0 +1,209 @@
+#include "QueryCraft/helper/literalescaping.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUERY_CRAFT_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 включается для отдельных функций, поэтому библиотека работает и на процессорах без AVX2
+#if defined(QUERY_CRAFT_HAS_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define QUERY_CRAFT_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using query_craft::helper::escape_kernel;
+
+/// Функция поиска первого символа ' или \ начиная с позиции from. Возвращает size, если символ не найден
+using find_function = size_t (*)(const char* data, size_t size, size_t from);
+
+bool is_special(const char symbol)
+{
+    return symbol == '\'' || symbol == '\\';
+}
+
+size_t find_scalar(const char* data, const size_t size, size_t from)
+{
+    while(from < size && !is_special(data[from])) {
+        from++;
+    }
+
+    return from;
+}
+
+#ifdef QUERY_CRAFT_HAS_SSE2
+/// Индекс младшего установленного бита, mask не равен 0
+unsigned lowest_bit(const unsigned mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned index = 0;
+    while(((mask >> index) & 1) == 0) {
+        index++;
+    }
+
+    return index;
+#endif
+}
+
+size_t find_sse2(const char* data, const size_t size, size_t from)
+{
+    const auto quote = _mm_set1_epi8('\'');
+    const auto backslash = _mm_set1_epi8('\\');
+
+    for(; from + 16 <= size; from += 16) {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + from));
+        const auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash))));
+
+        if(mask != 0) {
+            return from + lowest_bit(mask);
+        }
+    }
+
+    return find_scalar(data, size, from);
+}
+#endif
+
+#ifdef QUERY_CRAFT_HAS_AVX2
+__attribute__((target("avx2"))) size_t find_avx2(const char* data, const size_t size, size_t from)
+{
+    const auto quote = _mm256_set1_epi8('\'');
+    const auto backslash = _mm256_set1_epi8('\\');
+
+    for(; from + 32 <= size; from += 32) {
+        const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + from));
+        const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash))));
+
+        if(mask != 0) {
+            return from + static_cast<unsigned>(__builtin_ctz(mask));
+        }
+    }
+
+    // Остаток обрабатывается здесь же: переход из AVX2 в код SSE без vzeroupper замедляет выполнение
+    if(from + 16 <= size) {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + from));
+        const auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\'')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\\')))));
+
+        if(mask != 0) {
+            return from + static_cast<unsigned>(__builtin_ctz(mask));
+        }
+
+        from += 16;
+    }
+
+    while(from < size && !is_special(data[from])) {
+        from++;
+    }
+
+    return from;
+}
+#endif
+
+find_function find_for(const escape_kernel kernel)
+{
+    switch(kernel) {
+#ifdef QUERY_CRAFT_HAS_AVX2
+        case escape_kernel::avx2:
+            return &find_avx2;
+#endif
+#ifdef QUERY_CRAFT_HAS_SSE2
+        case escape_kernel::sse2:
+            return &find_sse2;
+#endif
+        default:
+            return &find_scalar;
+    }
+}
+
+/// Обратная косая черта перед двойной кавычкой не экранируется (json)
+bool is_escaped(const char* data, const size_t size, const size_t position)
+{
+    return data[position] == '\'' || position + 1 >= size || data[position + 1] != '"';
+}
+
+escape_kernel detect_kernel()
+{
+#ifdef QUERY_CRAFT_HAS_AVX2
+    if(__builtin_cpu_supports("avx2")) {
+        return escape_kernel::avx2;
+    }
+#endif
+
+#ifdef QUERY_CRAFT_HAS_SSE2
+    return escape_kernel::sse2;
+#else
+    return escape_kernel::scalar;
+#endif
+}
+
+} // namespace
+
+namespace query_craft {
+namespace helper {
+
+escape_kernel best_escape_kernel()
+{
+    static const auto kernel = detect_kernel();
+    return kernel;
+}
+
+bool is_escape_kernel_supported(const escape_kernel kernel)
+{
+    return static_cast<uint8_t>(kernel) <= static_cast<uint8_t>(best_escape_kernel());
+}
+
+size_t escaped_literal_size(const char* data, const size_t size, const escape_kernel kernel)
+{
+    const auto find = find_for(kernel);
+
+    size_t escaped_size = size;
+    for(auto position = find(data, size, 0); position < size; position = find(data, size, position + 1)) {
+        escaped_size += is_escaped(data, size, position) ? 1 : 0;
+    }
+
+    return escaped_size;
+}
+
+char* escape_literal(const char* data, const size_t size, char* output, const escape_kernel kernel)
+{
+    const auto find = find_for(kernel);
+
+    size_t begin = 0;
+    for(auto position = find(data, size, 0); position < size; position = find(data, size, begin)) {
+        std::memcpy(output, data + begin, position - begin);
+        output += position - begin;
+
+        *output++ = data[position];
+        if(is_escaped(data, size, position)) {
+            *output++ = data[position];
+        }
+
+        begin = position + 1;
+    }
+
+    std::memcpy(output, data + begin, size - begin);
+    return output + (size - begin);
+}
+
+std::string escape_backslashes(const std::string& value)
+{
+    std::string result;
+    result.reserve(value.size() + 8);
+
+    for(size_t i = 0; i < value.size(); i++) {
+        result.push_back(value[i]);
+
+        if(value[i] == '\\' && (i + 1 == value.size() || value[i + 1] != '"')) {
+            result.push_back('\\');
+        }
+    }
+
+    return result;
+}
+
+} // namespace helper
+} // namespace query_craft
@@ -1,31 +1,39 @@
 #include "QueryCraft/joincolumn.h"
 
 std::ostream& query_craft::operator<<(std::ostream& os, const join_column& obj)
+{
+    sql_builder builder;
+    append_join(builder, obj);
+
+    os << builder.str();
+
+    return os;
+}
+
+void query_craft::append_join(sql_builder& builder, const join_column& obj)
 {
     switch(obj.join_type) {
         case join_column::type::inner: {
-            os << " INNER ";
+            builder.append(" INNER ");
             break;
         }
         case join_column::type::outer: {
-            os << " OUTER ";
+            builder.append(" OUTER ");
             break;
         }
         case join_column::type::left: {
-            os << " LEFT ";
+            builder.append(" LEFT ");
             break;
         }
         case join_column::type::right: {
-            os << " RIGHT ";
+            builder.append(" RIGHT ");
             break;
         }
         case join_column::type::cross: {
-            os << " CROSS ";
+            builder.append(" CROSS ");
             break;
         }
     }
 
-    os << "JOIN " << obj.joined_table.table_name() << " ON " << obj.condition.unwrap(condion_view_type::full_name);
-
-    return os;
+    builder.append("JOIN ").append(obj.joined_table.table_name()).append(" ON ").append(obj.condition.unwrap(condion_view_type::full_name));
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "QueryCraft/sqlbuilder.h"
+
+#include "QueryCraft/conditiongroup.h"
+#include "QueryCraft/helper/literalescaping.h"
+
+#include <algorithm>
+
+namespace query_craft {
+
+sql_builder::sql_builder(const size_t capacity)
+{
+    _buffer.reserve(capacity);
+}
+
+void sql_builder::reserve(const size_t capacity)
+{
+    _buffer.reserve(capacity);
+}
+
+void sql_builder::clear()
+{
+    _buffer.clear();
+}
+
+sql_builder& sql_builder::append(const char* data, const size_t size)
+{
+    _buffer.append(data, size);
+    return *this;
+}
+
+sql_builder& sql_builder::append(const std::string& value)
+{
+    _buffer.append(value);
+    return *this;
+}
+
+sql_builder& sql_builder::append(const char symbol)
+{
+    _buffer.push_back(symbol);
+    return *this;
+}
+
+sql_builder& sql_builder::append_number(size_t value)
+{
+    char digits[20];
+    size_t size = 0;
+
+    do {
+        digits[sizeof(digits) - ++size] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while(value != 0);
+
+    _buffer.append(digits + sizeof(digits) - size, size);
+    return *this;
+}
+
+sql_builder& sql_builder::append_identifier(const std::string& name)
+{
+    _buffer.push_back('"');
+    _buffer.append(name);
+    _buffer.push_back('"');
+    return *this;
+}
+
+sql_builder& sql_builder::append_literal(const std::string& value)
+{
+    if(value == column_info::null_value()) {
+        _buffer.append(value);
+        return *this;
+    }
+
+    const auto escaped_size = helper::escaped_literal_size(value.data(), value.size());
+    const auto offset = _buffer.size();
+
+    _buffer.resize(offset + escaped_size + 2);
+    _buffer[offset] = '\'';
+
+    // Значение без специальных символов копируется целиком без повторного поиска
+    if(escaped_size == value.size()) {
+        std::copy(value.begin(), value.end(), &_buffer[offset + 1]);
+    } else {
+        helper::escape_literal(value.data(), value.size(), &_buffer[offset + 1]);
+    }
+
+    _buffer.back() = '\'';
+
+    return *this;
+}
+
+const std::string& sql_builder::str() const
+{
+    return _buffer;
+}
+
+size_t sql_builder::size() const
+{
+    return _buffer.size();
+}
+
+std::string sql_builder::release()
+{
+    std::string result;
+    result.swap(_buffer);
+    return result;
+}
+
+} // namespace query_craft
@@ -0,0 +1,362 @@
+#include "QueryCraft/sqlfingerprint.h"
+
+#include <cctype>
+#include <vector>
+
+namespace {
+
+/// Свёрнутый список значений
+const char* const collapsed_list = "(...)";
+
+/// Открытая скобка в форме запроса
+struct open_bracket
+{
+    /// Позиция скобки в форме запроса
+    size_t position;
+    /// В скобках встречались только значения и запятые
+    bool only_values;
+    /// В скобках встретилось хотя бы одно значение
+    bool has_values;
+};
+
+bool is_word_start(const char symbol)
+{
+    return std::isalpha(static_cast<unsigned char>(symbol)) || symbol == '_';
+}
+
+bool is_word_symbol(const char symbol)
+{
+    return std::isalnum(static_cast<unsigned char>(symbol)) || symbol == '_' || symbol == '$';
+}
+
+bool is_digit(const char symbol)
+{
+    return std::isdigit(static_cast<unsigned char>(symbol)) != 0;
+}
+
+bool is_value_keyword(const char* word, const size_t word_size)
+{
+    static const char* const keywords[] = { "NULL", "TRUE", "FALSE" };
+
+    for(const auto* keyword : keywords) {
+        const auto size = std::char_traits<char>::length(keyword);
+        if(word_size != size) {
+            continue;
+        }
+
+        bool equal = true;
+        for(size_t i = 0; i < size && equal; i++) {
+            equal = std::toupper(static_cast<unsigned char>(word[i])) == keyword[i];
+        }
+
+        if(equal) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// Символы, между которыми в форме запроса сохраняется пробел
+bool is_spaced_symbol(const char symbol)
+{
+    return is_word_symbol(symbol) || symbol == '?' || symbol == '"' || symbol == '`' || symbol == '[' || symbol == ']';
+}
+
+/// Формирует форму запроса, последовательно разбирая его на лексемы
+class shape_builder
+{
+public:
+    explicit shape_builder(const std::string& query)
+        : _query(query)
+    {
+        _shape.reserve(query.size());
+    }
+
+    std::string build()
+    {
+        while(_index < _query.size()) {
+            const char symbol = _query[_index];
+            const char next = _index + 1 < _query.size() ? _query[_index + 1] : '\0';
+
+            if(std::isspace(static_cast<unsigned char>(symbol))) {
+                _pending_space = true;
+                _index++;
+            } else if(symbol == '-' && next == '-') {
+                skip_line_comment();
+            } else if(symbol == '/' && next == '*') {
+                skip_block_comment();
+            } else if(symbol == '\'') {
+                skip_string_literal();
+            } else if(symbol == '"' || symbol == '`' || symbol == '[') {
+                copy_quoted_identifier(symbol == '[' ? ']' : symbol);
+            } else if(is_digit(symbol) || (symbol == '.' && is_digit(next))) {
+                skip_number();
+            } else if(symbol == '-' && (is_digit(next) || next == '.') && is_unary_minus()) {
+                _index++;
+                skip_number();
+            } else if(symbol == '$' && is_digit(next)) {
+                skip_placeholder();
+            } else if(symbol == '?') {
+                skip_placeholder();
+            } else if((symbol == ':' || symbol == '@') && is_word_start(next) && !is_cast()) {
+                skip_placeholder();
+            } else if(is_word_start(symbol)) {
+                copy_word();
+            } else if(symbol == '(') {
+                open();
+            } else if(symbol == ')') {
+                close();
+            } else {
+                append_symbol(symbol);
+                _index++;
+            }
+        }
+
+        return std::move(_shape);
+    }
+
+private:
+    void skip_line_comment()
+    {
+        while(_index < _query.size() && _query[_index] != '\n') {
+            _index++;
+        }
+
+        _pending_space = true;
+    }
+
+    void skip_block_comment()
+    {
+        const auto end = _query.find("*/", _index + 2);
+        _index = end == std::string::npos ? _query.size() : end + 2;
+        _pending_space = true;
+    }
+
+    void skip_string_literal()
+    {
+        // Префикс строки (E'', X'', N'', B'') относится к литералу
+        if(_last_word_size == 1 && !_pending_space && !_shape.empty()) {
+            const char prefix = _shape.back();
+            if(prefix == 'E' || prefix == 'X' || prefix == 'N' || prefix == 'B') {
+                _shape.pop_back();
+                _pending_space = _had_space_before_word;
+
+                if(!_brackets.empty()) {
+                    _brackets.back().only_values = _only_values_before_word;
+                }
+            }
+        }
+
+        _index++;
+        while(_index < _query.size()) {
+            if(_query[_index] == '\'') {
+                // Кавычка внутри строки экранируется удвоением
+                if(_index + 1 < _query.size() && _query[_index + 1] == '\'') {
+                    _index += 2;
+                    continue;
+                }
+
+                _index++;
+                break;
+            }
+
+            _index++;
+        }
+
+        append_value();
+    }
+
+    void copy_quoted_identifier(const char close_symbol)
+    {
+        const auto end = _query.find(close_symbol, _index + 1);
+        const auto size = (end == std::string::npos ? _query.size() : end + 1) - _index;
+
+        append_token(_query.data() + _index, size);
+        _index += size;
+    }
+
+    void skip_number()
+    {
+        while(_index < _query.size()) {
+            const char symbol = _query[_index];
+            const bool exponent_sign = (symbol == '+' || symbol == '-') && (_query[_index - 1] == 'e' || _query[_index - 1] == 'E');
+
+            if(!is_word_symbol(symbol) && symbol != '.' && !exponent_sign) {
+                break;
+            }
+
+            _index++;
+        }
+
+        append_value();
+    }
+
+    void skip_placeholder()
+    {
+        _index++;
+        while(_index < _query.size() && is_word_symbol(_query[_index])) {
+            _index++;
+        }
+
+        append_value();
+    }
+
+    void copy_word()
+    {
+        const auto begin = _index;
+        while(_index < _query.size() && is_word_symbol(_query[_index])) {
+            _index++;
+        }
+
+        // NULL и логические значения являются значениями так же, как литералы
+        if(is_value_keyword(_query.data() + begin, _index - begin)) {
+            append_value();
+            return;
+        }
+
+        _had_space_before_word = _pending_space;
+        _only_values_before_word = _brackets.empty() || _brackets.back().only_values;
+        append_token(_query.data() + begin, _index - begin);
+
+        for(auto i = _shape.size() - (_index - begin); i < _shape.size(); i++) {
+            _shape[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(_shape[i])));
+        }
+
+        _last_word_size = _index - begin;
+    }
+
+    void open()
+    {
+        mark_not_value();
+
+        _pending_space = false;
+        _brackets.push_back({ _shape.size(), true, false });
+        _shape.push_back('(');
+        _index++;
+    }
+
+    void close()
+    {
+        _index++;
+        _pending_space = false;
+
+        if(_brackets.empty()) {
+            append_symbol(')');
+            return;
+        }
+
+        const auto bracket = _brackets.back();
+        _brackets.pop_back();
+
+        if(!bracket.only_values || !bracket.has_values) {
+            _shape.push_back(')');
+            return;
+        }
+
+        _shape.resize(bracket.position);
+        _shape += collapsed_list;
+
+        // Строки VALUES одинаковой формы сворачиваются в одну
+        static const std::string repeated = std::string(collapsed_list) + "," + collapsed_list;
+        if(_shape.size() >= repeated.size() && _shape.compare(_shape.size() - repeated.size(), repeated.size(), repeated) == 0) {
+            _shape.resize(_shape.size() - repeated.size() + std::char_traits<char>::length(collapsed_list));
+        }
+    }
+
+    /// Минус относится к числу, если перед ним нет операнда
+    bool is_unary_minus() const
+    {
+        if(_shape.empty()) {
+            return true;
+        }
+
+        const char last = _shape.back();
+        return !is_spaced_symbol(last) && last != ')' && last != '.';
+    }
+
+    /// Двоеточие является частью приведения типа ::
+    bool is_cast() const
+    {
+        return _query[_index] == ':' && _index > 0 && _query[_index - 1] == ':';
+    }
+
+    void append_value()
+    {
+        append_token("?", 1);
+
+        if(!_brackets.empty()) {
+            _brackets.back().has_values = true;
+        }
+    }
+
+    void append_symbol(const char symbol)
+    {
+        if(symbol != ',') {
+            mark_not_value();
+        }
+
+        _shape.push_back(symbol);
+        _pending_space = false;
+        _last_word_size = 0;
+    }
+
+    void append_token(const char* data, const size_t size)
+    {
+        if(data[0] != '?') {
+            mark_not_value();
+        }
+
+        if(_pending_space && !_shape.empty() && is_spaced_symbol(_shape.back()) && is_spaced_symbol(data[0])) {
+            _shape.push_back(' ');
+        }
+
+        _shape.append(data, size);
+        _pending_space = false;
+        _last_word_size = 0;
+    }
+
+    void mark_not_value()
+    {
+        if(!_brackets.empty()) {
+            _brackets.back().only_values = false;
+        }
+    }
+
+private:
+    const std::string& _query;
+    std::string _shape {};
+    size_t _index = 0;
+    bool _pending_space = false;
+    /// Размер последнего слова, если оно было последней лексемой
+    size_t _last_word_size = 0;
+    /// Перед последним словом был пробел
+    bool _had_space_before_word = false;
+    /// В текущих скобках перед последним словом были только значения
+    bool _only_values_before_word = false;
+    std::vector<open_bracket> _brackets {};
+};
+
+} // namespace
+
+namespace query_craft {
+
+std::string sql_shape(const std::string& query)
+{
+    return shape_builder(query).build();
+}
+
+uint64_t sql_fingerprint(const std::string& query)
+{
+    const auto shape = sql_shape(query);
+
+    uint64_t hash = 14695981039346656037ULL;
+    for(const char symbol : shape) {
+        hash ^= static_cast<unsigned char>(symbol);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+} // namespace query_craft
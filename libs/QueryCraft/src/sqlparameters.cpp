@@ -0,0 +1,80 @@
+#include "QueryCraft/sqlparameters.h"
+
+#include "QueryCraft/conditiongroup.h"
+#include "QueryCraft/helper/literalescaping.h"
+
+namespace query_craft {
+
+sql_parameters::sql_parameters(const placeholder_type type, const bool escape_backslashes)
+    : _type(type)
+    , _escape_backslashes(escape_backslashes)
+{
+}
+
+void sql_parameters::bind(std::ostream& stream, const std::string& value)
+{
+    _values.emplace_back(value);
+
+    switch(_type) {
+        case placeholder_type::question: {
+            stream << "?";
+            break;
+        }
+        case placeholder_type::numbered: {
+            stream << "$" << _values.size();
+            break;
+        }
+    }
+}
+
+void sql_parameters::bind(sql_builder& builder, const std::string& value)
+{
+    _values.emplace_back(value);
+
+    switch(_type) {
+        case placeholder_type::question: {
+            builder.append('?');
+            break;
+        }
+        case placeholder_type::numbered: {
+            builder.append('$').append_number(_values.size());
+            break;
+        }
+    }
+}
+
+void sql_parameters::bind_value(sql_builder& builder, const std::string& value)
+{
+    if(_escape_backslashes && value != column_info::null_value() && value.find('\\') != std::string::npos) {
+        bind(builder, helper::escape_backslashes(value));
+    } else {
+        bind(builder, value);
+    }
+}
+
+bool sql_parameters::escape_backslashes() const
+{
+    return _escape_backslashes;
+}
+
+placeholder_type sql_parameters::type() const
+{
+    return _type;
+}
+
+const std::vector<std::string>& sql_parameters::values() const
+{
+    return _values;
+}
+
+size_t sql_parameters::size() const
+{
+    return _values.size();
+}
+
+void sql_parameters::clear()
+{
+    _values.clear();
+}
+
+} // namespace query_craft
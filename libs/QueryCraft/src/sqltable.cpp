@@ -1,41 +1,57 @@
 #include "QueryCraft/sqltable.h"
 
 namespace {
-void insert_with_escaping_character(std::stringstream& sql_stream, const std::string& value)
+/// Добавляет значение в запрос: как параметр, если передан parameters, иначе как экранированный литерал
+void insert_value(query_craft::sql_builder& builder, const std::string& value, query_craft::sql_parameters* parameters)
 {
-    if(value != query_craft::column_info::null_value()) {
-        sql_stream << "'";
+    if(parameters != nullptr) {
+        parameters->bind_value(builder, value);
+    } else {
+        builder.append_literal(value);
     }
+}
 
-    for(int i = 0; i < value.size(); i++) {
-        const auto ch = value[i];
+/// Формирует условие запроса: с параметрами, если передан parameters, иначе с подставленными значениями
+std::string unwrap_condition(const query_craft::condition_group& condition, const query_craft::condion_view_type view_type, query_craft::sql_parameters* parameters)
+{
+    return parameters != nullptr ? condition.unwrap(*parameters, view_type) : condition.unwrap(view_type);
+}
 
-        switch(ch) {
-            case '\'': {
-                sql_stream << "\'\'";
-                break;
-            }
+/// Добавляет список имён колонок в двойных кавычках через запятую
+void append_column_names(query_craft::sql_builder& builder, const std::vector<query_craft::column_info>& columns)
+{
+    for(size_t i = 0; i < columns.size(); i++) {
+        if(i != 0) {
+            builder.append(", ");
+        }
 
-            case '\\': {
-                // Доп обработка для json формата
-                if(i + 1 < value.size() && value[i + 1] == '"') {
-                    sql_stream << ch;
-                } else {
-                    sql_stream << "\\\\";
-                }
+        builder.append_identifier(columns[i].name());
+    }
+}
 
-                break;
-            }
+/// Оценивает размер запроса на вставку или обновление строк, чтобы буфер запроса выделялся один раз
+size_t estimate_query_size(const std::vector<query_craft::sql_table::row>& rows, const std::vector<query_craft::column_info>& columns, const bool parameterized)
+{
+    // Имя таблицы, ключевые слова и RETURNING
+    size_t size = 64;
 
-            default: {
-                sql_stream << ch;
+    for(const auto& column : columns) {
+        size += column.name().size() + 4;
+    }
+
+    // Каждое значение занимает placeholder или литерал в кавычках и разделитель, каждая строка - скобки и разделитель
+    const size_t value_overhead = parameterized ? 8 : 4;
+    size += rows.size() * (columns.size() * value_overhead + 4);
+
+    if(!parameterized) {
+        for(const auto& row : rows) {
+            for(const auto& value : row) {
+                size += value.size();
             }
         }
     }
 
-    if(value != query_craft::column_info::null_value()) {
-        sql_stream << "'";
-    }
+    return size;
 }
 } // namespace
 
@@ -75,9 +91,33 @@ std::string sql_table::insert_args(const std::initializer_list<column_info>& col
     return insert_sql(std::vector<column_info>(columns), need_returning, std::vector<column_info>(returning_columns));
 }
 
-std::string sql_table::insert_sql(const std::vector<column_info>& columns, bool need_returning, const std::vector<column_info>& returning_columns)
+std::string sql_table::insert_sql(const std::vector<column_info>& columns, const bool need_returning, const std::vector<column_info>& returning_columns)
 {
-    const auto insert_columns = columns.empty() ? _columns : columns;
+    sql_builder builder;
+    build_insert_sql(builder, nullptr, columns, need_returning, returning_columns);
+    return builder.release();
+}
+
+std::string sql_table::insert_sql(sql_parameters& parameters, const std::vector<column_info>& columns, const bool need_returning, const std::vector<column_info>& returning_columns)
+{
+    sql_builder builder;
+    build_insert_sql(builder, &parameters, columns, need_returning, returning_columns);
+    return builder.release();
+}
+
+void sql_table::insert_sql(sql_builder& builder, const std::vector<column_info>& columns, const bool need_returning, const std::vector<column_info>& returning_columns)
+{
+    build_insert_sql(builder, nullptr, columns, need_returning, returning_columns);
+}
+
+void sql_table::insert_sql(sql_builder& builder, sql_parameters& parameters, const std::vector<column_info>& columns, const bool need_returning, const std::vector<column_info>& returning_columns)
+{
+    build_insert_sql(builder, &parameters, columns, need_returning, returning_columns);
+}
+
+void sql_table::build_insert_sql(sql_builder& builder, sql_parameters* parameters, const std::vector<column_info>& columns, const bool need_returning, const std::vector<column_info>& returning_columns)
+{
+    const auto& insert_columns = columns.empty() ? _columns : columns;
 
     if(insert_columns.empty())
         throw std::invalid_argument("Ошибка. Отсутствует информация о колонках");
@@ -88,53 +128,41 @@ std::string sql_table::insert_sql(const std::vector<column_info>& columns, bool
     if(rows.front().size() != insert_columns.size())
         throw std::invalid_argument("Ошибка. Не совпадает колличество колонок с размером данных");
 
-    std::stringstream sql_stream;
-    sql_stream << "INSERT INTO " << table_name() << " (";
+    builder.clear();
+    builder.reserve(estimate_query_size(rows, insert_columns, parameters != nullptr));
 
-    for(const auto& column : insert_columns) {
-        sql_stream << "\"" << column.name() << "\""
-                   << ", ";
-    }
+    builder.append("INSERT INTO ").append(table_name()).append(" (");
+    append_column_names(builder, insert_columns);
+    builder.append(") VALUES");
 
-    sql_stream.seekp(-2, std::stringstream::cur);
+    for(size_t row_index = 0; row_index < rows.size(); row_index++) {
+        builder.append(row_index == 0 ? " (" : ", (");
 
-    sql_stream << ") VALUES";
-
-    for(const auto& row : rows) {
-        sql_stream << " (";
+        const auto& row = rows[row_index];
+        for(size_t i = 0; i < row.size(); i++) {
+            if(i != 0) {
+                builder.append(", ");
+            }
 
-        for(const auto& value : row) {
-            insert_with_escaping_character(sql_stream, value);
-            sql_stream << ", ";
+            insert_value(builder, row[i], parameters);
         }
 
-        sql_stream.seekp(-2, std::stringstream::cur);
-
-        sql_stream << "),";
+        builder.append(')');
     }
 
-    sql_stream.seekp(-1, std::stringstream::cur);
-
     if(need_returning) {
-        sql_stream << " RETURNING ";
+        builder.append(" RETURNING ");
 
         if(returning_columns.empty()) {
-            sql_stream << "*";
+            builder.append('*');
         } else {
-            for(const auto& returning_column : returning_columns) {
-                sql_stream << "\"" << returning_column.name() << "\""
-                           << ", ";
-            }
-
-            sql_stream.seekp(-2, std::stringstream::cur);
+            append_column_names(builder, returning_columns);
         }
     }
 
-    sql_stream << ";";
+    builder.append(';');
 
     rows.clear();
-
-    return sql_stream.str();
 }
 
 std::string sql_table::update_args_sql(const condition_group& condition, const std::initializer_list<column_info>& columns)
@@ -144,7 +172,21 @@ std::string sql_table::update_args_sql(const condition_group& condition, const s
 
 std::string sql_table::update_sql(const condition_group& condition, const std::vector<column_info>& columns)
 {
-    const auto update_columns = columns.empty() ? _columns : columns;
+    sql_builder builder;
+    build_update_sql(builder, nullptr, condition, columns);
+    return builder.release();
+}
+
+std::string sql_table::update_sql(sql_parameters& parameters, const condition_group& condition, const std::vector<column_info>& columns)
+{
+    sql_builder builder;
+    build_update_sql(builder, &parameters, condition, columns);
+    return builder.release();
+}
+
+void sql_table::build_update_sql(sql_builder& builder, sql_parameters* parameters, const condition_group& condition, const std::vector<column_info>& columns)
+{
+    const auto& update_columns = columns.empty() ? _columns : columns;
 
     if(update_columns.empty())
         throw std::invalid_argument("Ошибка. Отсутствует информация о колонках");
@@ -158,44 +200,51 @@ std::string sql_table::update_sql(const condition_group& condition, const std::v
     if(rows.size() != 1)
         throw std::invalid_argument("Ошибка. В рамках запроса update можно обновить использовать только 1 строку");
 
-    std::stringstream sql_stream;
+    builder.clear();
+    builder.reserve(estimate_query_size(rows, update_columns, parameters != nullptr));
 
-    sql_stream << "UPDATE " << table_name() << " SET ";
+    builder.append("UPDATE ").append(table_name()).append(" SET ");
 
     const auto& row = rows.front();
-    for(int i = 0; i < update_columns.size(); i++) {
-        sql_stream << "\"" << update_columns[i].name() << "\""
-                   << " = ";
-
-        insert_with_escaping_character(sql_stream, row[i]);
+    for(size_t i = 0; i < update_columns.size(); i++) {
+        if(i != 0) {
+            builder.append(", ");
+        }
 
-        sql_stream << ", ";
+        builder.append_identifier(update_columns[i].name()).append(" = ");
+        insert_value(builder, row[i], parameters);
     }
 
-    sql_stream.seekp(-2, std::stringstream::cur);
-
     if(condition.is_valid())
-        sql_stream << " WHERE " << condition.unwrap();
+        builder.append(" WHERE ").append(unwrap_condition(condition, condion_view_type::name, parameters));
 
-    sql_stream << ";";
+    builder.append(';');
 
     rows.clear();
-
-    return sql_stream.str();
 }
 
 std::string sql_table::remove_sql(const condition_group& condition) const
 {
-    std::stringstream sql_stream;
+    return build_remove_sql(nullptr, condition);
+}
 
-    sql_stream << "DELETE FROM " << table_name();
+std::string sql_table::remove_sql(sql_parameters& parameters, const condition_group& condition) const
+{
+    return build_remove_sql(&parameters, condition);
+}
+
+std::string sql_table::build_remove_sql(sql_parameters* parameters, const condition_group& condition) const
+{
+    sql_builder builder;
+
+    builder.append("DELETE FROM ").append(table_name());
 
     if(condition.is_valid())
-        sql_stream << " WHERE " << condition.unwrap();
+        builder.append(" WHERE ").append(unwrap_condition(condition, condion_view_type::name, parameters));
 
-    sql_stream << ";";
+    builder.append(';');
 
-    return sql_stream.str();
+    return builder.release();
 }
 
 std::string sql_table::select_args_sql(
@@ -222,60 +271,95 @@ std::string sql_table::select_sql(
     const size_t limit,
     const size_t offset,
     const std::vector<column_info>& columns) const
+{
+    return build_select_sql(nullptr, join_columns, condition, sort_columns, limit, offset, columns, false);
+}
+
+std::string sql_table::select_sql(
+    sql_parameters& parameters,
+    const std::vector<join_column>& join_columns,
+    const condition_group& condition,
+    const std::vector<sort_column>& sort_columns,
+    const size_t limit,
+    const size_t offset,
+    const std::vector<column_info>& columns) const
+{
+    return build_select_sql(&parameters, join_columns, condition, sort_columns, limit, offset, columns, false);
+}
+
+std::string sql_table::build_select_sql(
+    sql_parameters* parameters,
+    const std::vector<join_column>& join_columns,
+    const condition_group& condition,
+    const std::vector<sort_column>& sort_columns,
+    const size_t limit,
+    const size_t offset,
+    const std::vector<column_info>& columns,
+    const bool for_update) const
 {
     // TODO Добавить реализацию group by, having
 
-    const auto select_columns = columns.empty() ? _columns : columns;
+    const auto& select_columns = columns.empty() ? _columns : columns;
 
-    std::stringstream sql_stream;
+    sql_builder builder;
 
-    sql_stream << "SELECT ";
+    builder.append("SELECT ");
 
     if(!select_columns.empty()) {
-        for(const column_info& column : select_columns) {
-            sql_stream << column.full_name() << " AS " << column.alias() << ", ";
+        for(size_t i = 0; i < select_columns.size(); i++) {
+            if(i != 0) {
+                builder.append(", ");
+            }
+
+            builder.append(select_columns[i].full_name()).append(" AS ").append(select_columns[i].alias());
         }
-        sql_stream.seekp(-2, std::stringstream::cur);
     } else {
-        sql_stream << "*";
+        builder.append('*');
     }
 
-    sql_stream << " FROM " << table_name();
+    builder.append(" FROM ").append(table_name());
 
     for(const auto& joinColumn : join_columns) {
-        sql_stream << joinColumn << " ";
+        append_join(builder, joinColumn);
+        builder.append(' ');
     }
+
     if(condition.is_valid())
-        sql_stream << " WHERE " << condition.unwrap(condion_view_type::full_name);
+        builder.append(" WHERE ").append(unwrap_condition(condition, condion_view_type::full_name, parameters));
 
     if(!sort_columns.empty()) {
-        sql_stream << " ORDER BY ";
+        builder.append(" ORDER BY ");
 
-        for(const auto& sortColumn : sort_columns) {
-            sql_stream << sortColumn.column.alias();
+        for(size_t i = 0; i < sort_columns.size(); i++) {
+            if(i != 0) {
+                builder.append(", ");
+            }
 
-            switch(sortColumn.sort_type) {
+            builder.append(sort_columns[i].column.alias());
+
+            switch(sort_columns[i].sort_type) {
                 case sort_column::type::asc:
-                    sql_stream << " ASC, ";
+                    builder.append(" ASC");
                     break;
                 case sort_column::type::desc:
-                    sql_stream << " DESC, ";
+                    builder.append(" DESC");
                     break;
             }
         }
-
-        sql_stream.seekp(-2, std::stringstream::cur);
     }
 
     if(limit != 0)
-        sql_stream << " LIMIT " << limit;
+        builder.append(" LIMIT ").append_number(limit);
 
     if(offset != 0)
-        sql_stream << " OFFSET " << offset;
+        builder.append(" OFFSET ").append_number(offset);
 
-    sql_stream << ";";
+    if(for_update)
+        builder.append(" FOR UPDATE");
 
-    return sql_stream.str();
+    builder.append(';');
+
+    return builder.release();
 }
 
 std::string sql_table::select_for_update_args_sql(const std::initializer_list<join_column>& join_columns, const condition_group& condition, const std::initializer_list<sort_column>& sort_columns, size_t limit, size_t offset, const std::initializer_list<column_info>& columns) const
@@ -296,9 +380,18 @@ std::string sql_table::select_for_update_sql(const std::vector<join_column>& joi
     const size_t offset,
     const std::vector<column_info>& columns) const
 {
-    auto str = select_sql(join_columns, condition, sort_columns, limit, offset, columns);
-    str.replace(str.rfind(";"), 1, " FOR UPDATE;");
-    return str;
+    return build_select_sql(nullptr, join_columns, condition, sort_columns, limit, offset, columns, true);
+}
+
+std::string sql_table::select_for_update_sql(sql_parameters& parameters,
+    const std::vector<join_column>& join_columns,
+    const condition_group& condition,
+    const std::vector<sort_column>& sort_columns,
+    const size_t limit,
+    const size_t offset,
+    const std::vector<column_info>& columns) const
+{
+    return build_select_sql(&parameters, join_columns, condition, sort_columns, limit, offset, columns, true);
 }
 
 } // namespace query_craft
\ No newline at end of file
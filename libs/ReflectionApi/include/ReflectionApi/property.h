@@ -6,6 +6,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace reflection_api {
 
@@ -68,7 +69,7 @@ public:
      * @param classValue Объект, в котором находится переменная.
      * @param data Новое значение переменной.
      */
-    void set_value(ClassType& classValue, const PropertyType& data)
+    void set_value(ClassType& classValue, const PropertyType& data) const
     {
         if(_variable == nullptr)
             (classValue.*_setter)(data);
@@ -76,11 +77,26 @@ public:
             classValue.*_variable = data;
     }
 
+    /**
+     * @brief Устанавливает значение переменной, перемещая данные в объект.
+     * @note Если переменная связана с членами-функциями, значение копируется через setter.
+     *
+     * @param classValue Объект, в котором находится переменная.
+     * @param data Новое значение переменной.
+     */
+    void move_value(ClassType& classValue, PropertyType&& data) const
+    {
+        if(_variable == nullptr)
+            (classValue.*_setter)(data);
+        else
+            classValue.*_variable = std::move(data);
+    }
+
     /**
      * @brief Заглушка для работы рефлексии
      */
     template<typename Type>
-    void set_value(ClassType& /*classValue*/, const Type& /*data*/)
+    void set_value(ClassType& /*classValue*/, const Type& /*data*/) const
     {
         throw std::invalid_argument("type is not valid");
     }
@@ -96,6 +112,21 @@ public:
         return _variable == nullptr ? (classValue.*_getter)() : classValue.*_variable;
     }
 
+    /**
+     * @brief Забирает значение переменной, перемещая его из объекта.
+     * @note Если переменная связана с членами-функциями, значение копируется через getter.
+     *
+     * @param classValue Объект, в котором находится переменная. После вызова переменная находится в перемещённом состоянии
+     * @return Значение переменной.
+     */
+    PropertyType take_value(ClassType& classValue) const
+    {
+        if(_variable == nullptr)
+            return (classValue.*_getter)();
+
+        return std::move(classValue.*_variable);
+    }
+
     /**
      * @brief Заглушка для работы рефлексии
      */
@@ -3,7 +3,9 @@
 #include "sfinae.h"
 
 #include <sstream>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
 #include <vector>
 
 namespace type_converter_api {
@@ -19,6 +21,15 @@ void convert_to_target(TargetContainer& relation_property, const CurrentContaine
     }
 }
 
+template<typename TargetContainer, typename Type, typename CurrentContainer = std::vector<Type>,
+    std::enable_if_t<sfinae::has_left_shift_container_operator_v<TargetContainer, Type>, bool> = true>
+void move_to_target(TargetContainer& relation_property, CurrentContainer& result, int)
+{
+    for(auto& value : result) {
+        relation_property << std::move(value);
+    }
+}
+
 #endif
 
 template<typename TargetContainer, typename Type, typename CurrentContainer = std::vector<Type>,
@@ -30,6 +41,15 @@ void convert_to_target(TargetContainer& relation_property, const CurrentContaine
     }
 }
 
+template<typename TargetContainer, typename Type, typename CurrentContainer = std::vector<Type>,
+    std::enable_if_t<sfinae::has_emplace_back_v<TargetContainer, Type>, bool> = true>
+void move_to_target(TargetContainer& relation_property, CurrentContainer& result, int)
+{
+    for(auto& value : result) {
+        relation_property.emplace_back(std::move(value));
+    }
+}
+
 template<typename TargetContainer, typename Type, typename CurrentContainer = std::vector<Type>>
 void convert_to_target(TargetContainer&, const CurrentContainer&, ...)
 {
@@ -38,6 +58,12 @@ void convert_to_target(TargetContainer&, const CurrentContainer&, ...)
 
     throw std::runtime_error(message.str());
 }
+
+template<typename TargetContainer, typename Type, typename CurrentContainer = std::vector<Type>>
+void move_to_target(TargetContainer& relation_property, CurrentContainer& result, ...)
+{
+    convert_to_target<TargetContainer, Type, CurrentContainer>(relation_property, result, 0);
+}
 } // namespace impl
 
 template<typename TargetContainer, typename Type = typename TargetContainer::value_type>
@@ -45,10 +71,20 @@ class container_converter
 {
 public:
     template<typename CurrentContainer = std::vector<Type>>
-    void convert_to_target(TargetContainer& relation_property, const CurrentContainer& result)
+    void convert_to_target(TargetContainer& relation_property, const CurrentContainer& result) const
     {
         impl::convert_to_target<TargetContainer, Type, CurrentContainer>(relation_property, result, 0);
     }
+
+    /**
+     * Переместить элементы result в конец relation_property
+     * @note После вызова элементы result находятся в перемещённом состоянии
+     */
+    template<typename CurrentContainer = std::vector<Type>>
+    void move_to_target(TargetContainer& relation_property, CurrentContainer&& result) const
+    {
+        impl::move_to_target<TargetContainer, Type, std::decay_t<CurrentContainer>>(relation_property, result, 0);
+    }
 };
 
 } // namespace type_converter_api
@@ -112,6 +112,16 @@ public:
 
     virtual void fill_from_string(bool& value, const std::string& str) const
     {
+        // Кроме true/false принимаются значения, которые возвращают базы данных: t/f в PostgreSQL и 1/0
+        if(str == "t" || str == "1") {
+            value = true;
+            return;
+        }
+        if(str == "f" || str == "0") {
+            value = false;
+            return;
+        }
+
         std::stringstream stream;
         stream << str;
         stream >> std::boolalpha >> value;
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ilogger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace database_adapter {
+
+/**
+ * @brief Логгер, который передаёт сообщения другому логгеру из отдельного потока
+ * @note Сообщения складываются в ограниченный кольцевой буфер без блокировок, поэтому выполнение запроса не ждёт запись журнала.
+ * Если буфер заполнен, сообщение отбрасывается и учитывается в dropped().
+ * Логгер-приёмник вызывается только из потока логгера и может не быть потокобезопасным
+ */
+class async_logger final : public ILogger
+{
+public:
+    /**
+     * @brief Конструктор, который запускает поток записи журнала
+     * @param sink Логгер, которому передаются сообщения
+     * @param capacity Ёмкость буфера сообщений, округляется вверх до степени двойки
+     * @param level Минимальный уровень сообщений
+     * @throws std::invalid_argument Если sink равен nullptr
+     */
+    explicit async_logger(std::shared_ptr<ILogger> sink, size_t capacity = 8192, log_level level = log_level::sql);
+
+    async_logger(const async_logger& other) = delete;
+    async_logger(async_logger&& other) noexcept = delete;
+    async_logger& operator=(const async_logger& other) = delete;
+    async_logger& operator=(async_logger&& other) noexcept = delete;
+
+    /// @brief Передаёт приёмнику оставшиеся сообщения и останавливает поток
+    ~async_logger() override;
+
+    void log_error(const std::string& message) override;
+    void log_sql(const std::string& message) override;
+    bool is_enabled(log_level level) const override;
+
+    /// @brief Изменить минимальный уровень сообщений
+    void set_level(log_level level);
+
+    /// @brief Дождаться передачи приёмнику всех сообщений, добавленных до вызова
+    void flush();
+
+    /// @brief Количество сообщений, отброшенных из-за заполненного буфера
+    size_t dropped() const;
+
+private:
+    /// @brief Ячейка кольцевого буфера
+    struct slot
+    {
+        /// @brief Номер операции, для которой ячейка доступна: запись при sequence == позиции, чтение при sequence == позиции + 1
+        std::atomic<size_t> sequence { 0 };
+        log_level level = log_level::sql;
+        std::string message {};
+    };
+
+private:
+    /// @brief Добавить сообщение в буфер без блокировки
+    void push(log_level level, const std::string& message);
+
+    /// @brief Извлечь сообщение из буфера. Вызывается только из потока логгера
+    bool pop(log_level& level, std::string& message);
+
+    /// @brief Есть ли в буфере сообщение для чтения
+    bool has_message() const;
+
+    /// @brief Передать сообщение приёмнику
+    void deliver(log_level level, const std::string& message);
+
+    /// @brief Цикл потока логгера
+    void drain_loop();
+
+private:
+    std::shared_ptr<ILogger> _sink;
+    std::atomic<log_level> _level;
+
+    std::unique_ptr<slot[]> _slots;
+    size_t _mask;
+
+    /// @brief Позиции записи и чтения разнесены по разным кэш-линиям, чтобы пишущие потоки не мешали потоку логгера
+    char _enqueue_padding[64] {};
+    std::atomic<size_t> _enqueue_position { 0 };
+    char _dequeue_padding[64] {};
+    std::atomic<size_t> _dequeue_position { 0 };
+
+    std::atomic<size_t> _dropped { 0 };
+    /// @brief Количество сообщений, переданных приёмнику
+    std::atomic<size_t> _processed { 0 };
+
+    /// @brief Поток логгера ожидает новые сообщения
+    std::atomic<bool> _sleeping { false };
+    std::atomic<bool> _stopped { false };
+    std::mutex _lock {};
+    std::condition_variable _wake_up {};
+    std::condition_variable _drained {};
+
+    std::thread _thread {};
+};
+
+} // namespace database_adapter
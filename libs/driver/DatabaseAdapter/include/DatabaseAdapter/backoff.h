@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+
+namespace database_adapter {
+
+/// @brief Экспоненциально растущая задержка между повторными попытками со случайным разбросом
+class exponential_backoff
+{
+public:
+    /**
+     * @brief Конструктор
+     * @param initial_delay Задержка перед первой повторной попыткой
+     * @param max_delay Максимальная задержка
+     */
+    exponential_backoff(std::chrono::milliseconds initial_delay, std::chrono::milliseconds max_delay);
+
+    /**
+     * @brief Получить задержку перед следующей попыткой
+     * @return Случайная задержка в диапазоне [delay / 2, delay], где delay удваивается с каждой попыткой до max_delay
+     * @note Разброс нужен, чтобы соединения пула, разорванные одновременно, не переподключались в один момент
+     */
+    std::chrono::milliseconds next_delay();
+
+    /// @brief Вернуться к начальной задержке
+    void reset();
+
+private:
+    std::chrono::milliseconds _initial_delay;
+    std::chrono::milliseconds _max_delay;
+    std::chrono::milliseconds _delay;
+};
+
+} // namespace database_adapter
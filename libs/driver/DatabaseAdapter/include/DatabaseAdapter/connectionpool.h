@@ -1,60 +1,174 @@
 #pragma once
 
 #include "DatabaseAdapter/model/databasesettings.h"
+#include "DatabaseAdapter/model/poolhealthsettings.h"
+#include "DatabaseAdapter/model/poolmetrics.h"
 #include "iconnection.h"
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 namespace database_adapter {
 
+struct connection_pool_state;
+
+/// @brief Владение соединением, взятым из пула. При уничтожении соединение возвращается в пул
+class connection_lease
+{
+public:
+    connection_lease() = default;
+
+    connection_lease(const connection_lease& other) = delete;
+    connection_lease(connection_lease&& other) noexcept = default;
+    connection_lease& operator=(const connection_lease& other) = delete;
+    connection_lease& operator=(connection_lease&& other) noexcept;
+
+    ~connection_lease();
+
+    /// @brief Получить соединение, nullptr если соединение не было получено
+    IConnection* get() const;
+
+    IConnection* operator->() const;
+
+    IConnection& operator*() const;
+
+    /// @brief Получено ли соединение из пула
+    explicit operator bool() const;
+
+    /// @brief Вернуть соединение в пул до уничтожения объекта
+    void release();
+
+private:
+    friend class IConnectionPool;
+
+    connection_lease(std::shared_ptr<connection_pool_state> state, std::shared_ptr<IConnection> connection, size_t generation, std::chrono::steady_clock::time_point created_at);
+
+private:
+    std::shared_ptr<connection_pool_state> _state {};
+    std::shared_ptr<IConnection> _connection {};
+    /// @brief Поколение настроек пула, с которыми было создано соединение
+    size_t _generation = 0;
+    /// @brief Время создания соединения
+    std::chrono::steady_clock::time_point _created_at {};
+};
+
 class IConnectionPool
 {
 public:
-    IConnectionPool() = default;
+    /// @brief Функция получения статистики пула
+    using metrics_callback = std::function<void(const pool_metrics&)>;
+
+    /**
+     * @brief Функция создания соединения пула
+     * @note Вызывается из фоновых потоков пула, поэтому не должна обращаться к объекту наследника пула:
+     * всё необходимое для создания соединения захватывается по значению
+     */
+    using connection_factory = std::function<std::shared_ptr<IConnection>(const database_connection_settings& settings)>;
+
+public:
+    explicit IConnectionPool(connection_factory factory);
 
-    explicit IConnectionPool(database_connection_settings settings,
+    explicit IConnectionPool(connection_factory factory,
+        database_connection_settings settings,
         size_t start_pool_size,
         size_t max_pool_size,
-        std::chrono::seconds wait_time = std::chrono::seconds(10));
+        std::chrono::milliseconds wait_time = std::chrono::seconds(10));
 
-    explicit IConnectionPool(database_connection_settings settings,
+    explicit IConnectionPool(connection_factory factory,
+        database_connection_settings settings,
         size_t start_pool_size = 5,
-        std::chrono::seconds wait_time = std::chrono::seconds(10));
+        std::chrono::milliseconds wait_time = std::chrono::seconds(10));
 
     IConnectionPool(const IConnectionPool& other) = delete;
     IConnectionPool(IConnectionPool&& other) noexcept = delete;
     IConnectionPool& operator=(const IConnectionPool& other) = delete;
     IConnectionPool& operator=(IConnectionPool&& other) noexcept = delete;
 
-    virtual ~IConnectionPool() = default;
+    virtual ~IConnectionPool();
 
     void set_max_pool_size(size_t max_pool_size);
 
+    /**
+     * @brief Изменить настройки подключения
+     * @note Свободные соединения пересоздаются, занятые закрываются при возврате в пул
+     */
     void set_settings(const database_connection_settings& settings);
 
-    void set_wait_time(const std::chrono::seconds& wait_time);
-
+    void set_wait_time(const std::chrono::milliseconds& wait_time);
+
+    /**
+     * @brief Изменить количество соединений, готовность которых ожидается при прогреве пула
+     * @param min_ready Количество соединений. Остальные стартовые соединения создаются в фоне
+     * @note По умолчанию ожидаются все стартовые соединения
+     */
+    void set_warm_up_min_ready(size_t min_ready);
+
+    /**
+     * @brief Изменить настройки фоновой проверки соединений
+     * @note Фоновая проверка запускается при первом получении соединения из пула
+     */
+    void set_health_settings(const pool_health_settings& settings);
+
+    /**
+     * @brief Установить функцию периодического получения статистики пула
+     * @param callback Функция, nullptr - отключить
+     * @param interval Период вызова функции
+     * @note Функция вызывается из фонового потока пула без блокировки пула
+     */
+    void set_metrics_callback(metrics_callback callback, std::chrono::milliseconds interval);
+
+    /// @brief Получить снимок статистики пула
+    pool_metrics metrics() const;
+
+    /**
+     * @brief Взять соединение из пула
+     * @param wait_time Максимальное время ожидания свободного соединения
+     * @return Владение соединением, пустое если за время ожидания соединение не освободилось
+     * @note Ожидающие потоки получают соединения в порядке очереди
+     * @throws open_database_exception Выбрасывает исключение в случае ошибки создания нового соединения
+     */
+    connection_lease acquire(std::chrono::milliseconds wait_time);
+
+    /// @brief Взять соединение из пула с временем ожидания из настроек пула
+    connection_lease acquire();
+
+    /**
+     * @brief Взять соединение из пула
+     * @return Соединение, которое возвращается в пул после уничтожения последней копии, или nullptr если за время ожидания соединение не освободилось
+     */
     std::shared_ptr<IConnection> open_connection();
 
 private:
+    connection_lease acquire_connection(std::chrono::milliseconds wait_time);
+
     void init_start_conncetions();
 
-protected:
-    virtual std::shared_ptr<IConnection> create_connection(const database_connection_settings& settings) = 0;
+    /// @brief Создать соединение под зарезервированное место в пуле. В случае ошибки место освобождается
+    connection_lease create_reserved_connection(size_t generation);
 
-private:
-    std::mutex _lock;
+    void start_health_check();
 
-    database_connection_settings _settings {};
+    /// @brief Цикл фонового потока пула: проверка соединений и периодическая передача статистики
+    void health_check_loop();
 
-    size_t _start_pool_size = 2;
-    size_t _max_pool_size = 10;
-    std::chrono::seconds _wait_time = std::chrono::seconds(2);
+    /// @brief Закрыть разорванные, устаревшие и простаивающие соединения и пополнить пул до min_idle. Вызывается под блокировкой пула
+    void validate_connections(std::unique_lock<std::mutex>& lock_guard);
+
+    /// @brief Остановить фоновые потоки пула и дождаться их завершения
+    void stop_health_check();
+
+private:
+    std::shared_ptr<connection_pool_state> _state;
+    /// @brief Функция создания соединений. Принадлежит пулу, поэтому живёт до остановки фоновых потоков
+    const connection_factory _factory;
 
-    std::vector<std::shared_ptr<IConnection>> _connections {};
+    std::thread _health_check_thread {};
+    /// @brief Потоки параллельного создания стартовых соединений
+    std::vector<std::thread> _warm_up_threads {};
 };
 
-} // namespace database_adapter
\ No newline at end of file
+} // namespace database_adapter
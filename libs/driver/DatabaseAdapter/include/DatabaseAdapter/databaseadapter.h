@@ -1,9 +1,23 @@
 #pragma once
 
+#include "asynclogger.h"
+#include "backoff.h"
 #include "connectionpool.h"
 #include "exception/opendatabaseexception.h"
 #include "exception/sqlexception.h"
 #include "iconnection.h"
 #include "ilogger.h"
+#include "imetricssink.h"
+#include "instrumentedconnection.h"
+#include "model/batchstatement.h"
+#include "model/bindparameter.h"
 #include "model/databasesettings.h"
-#include "model/queryresult.h"
\ No newline at end of file
+#include "model/poolhealthsettings.h"
+#include "model/poolmetrics.h"
+#include "model/querymetrics.h"
+#include "model/queryresult.h"
+#include "model/statementsummary.h"
+#include "model/textview.h"
+#include "querysource.h"
+#include "statementcache.h"
+#include "statementstatistics.h"
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "model/batchstatement.h"
+#include "model/bindparameter.h"
 #include "model/queryresult.h"
+#include "statementcache.h"
 
+#include <functional>
 #include <vector>
 
 namespace database_adapter {
@@ -13,6 +17,13 @@ namespace database_adapter {
 /// @brief Класс который инкапсулирует всю логику взаимодействия с базой данных. От выполнения запросов и открытие транзакций до кеширования запросов
 class IConnection
 {
+public:
+    /// @brief Функция обработки одной строки результата при потоковом чтении
+    using row_callback = std::function<void(const query_result::row_view&)>;
+
+    /// @brief Функция получения следующей строки для массовой вставки. Возвращает false, когда строки закончились
+    using row_source = std::function<bool(std::vector<std::string>& row)>;
+
 public:
     /**
      * @brief Конструктор, который принимает в себя информацию о подключении к базе данных
@@ -31,6 +42,13 @@ public:
      */
     virtual bool is_valid();
 
+    /**
+     * @brief Быстрая проверка состояния соединения без обращения к базе данных
+     * @return Возвращает false, если соединение точно разорвано, иначе true
+     * @note Не гарантирует, что следующий запрос выполнится успешно. Для полной проверки используется is_valid
+     */
+    virtual bool is_alive() const;
+
     /**
      * @brief Проверка открыта ли транзакция в текущем соединении
      * @return Возвращает true, если в текущем соединении имеется активная транзакция, иначе false.
@@ -45,6 +63,37 @@ public:
      */
     virtual query_result exec(const std::string& query) = 0;
 
+    /**
+     * @brief Выполняет SQL-запрос и передаёт строки результата в callback по мере их получения
+     * @param query SQL-запрос.
+     * @param callback Функция, которая вызывается для каждой строки результата
+     * @note Представление строки действительно только во время вызова callback.
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    virtual void exec_stream(const std::string& query, const row_callback& callback);
+
+    /**
+     * @brief Выполняет параметризованный SQL-запрос и передаёт строки результата в callback по мере их получения
+     * @param query SQL-запрос, в котором параметры обозначены placeholder (см. numbered_placeholders)
+     * @param params Значения параметров в порядке их следования в запросе, значение NULL_VALUE передаётся как NULL
+     * @param callback Функция, которая вызывается для каждой строки результата
+     * @note Представление строки действительно только во время вызова callback.
+     * В базовой реализации результат полностью загружается в память, драйверы переопределяют метод для чтения с постоянным расходом памяти
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    virtual void exec_stream(const std::string& query, const std::vector<std::string>& params, const row_callback& callback);
+
+    /**
+     * @brief Выгружает результат запроса и передаёт строки в callback по мере их получения. Предназначен для чтения больших таблиц целиком
+     * @param query SQL-запрос выборки без параметров
+     * @param callback Функция, которая вызывается для каждой строки результата
+     * @note Представление строки действительно только во время вызова callback.
+     * В базовой реализации вызывается exec_stream, драйверы могут использовать более быстрый протокол выгрузки.
+     * Значения ячеек могут передаваться только в текстовом виде
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    virtual void export_stream(const std::string& query, const row_callback& callback);
+
     /**
      * @brief Выполняет подготовку запроса для возможности динамической подстановки параметров и кэширования запросов
      * @param query Запрос который необходимо подготовить
@@ -60,6 +109,80 @@ public:
      */
     virtual query_result exec_prepared(const std::vector<std::string>& params, const std::string& name) = 0;
 
+    /**
+     * @brief Выполнить параметризованный запрос. Запросы с одинаковым текстом используют один подготовленный запрос
+     * @param query SQL-запрос, в котором параметры обозначены placeholder (см. numbered_placeholders)
+     * @param params Значения параметров в порядке их следования в запросе, значение NULL_VALUE передаётся как NULL
+     * @return Результат выполнения SQL-запроса.
+     * @note В базовой реализации запрос каждый раз подготавливается через prepare и выполняется через exec_prepared
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    virtual query_result exec_prepared(const std::string& query, const std::vector<std::string>& params);
+
+    /**
+     * @brief Выполнить параметризованный запрос с типизированными значениями параметров
+     * @param query SQL-запрос, в котором параметры обозначены placeholder (см. numbered_placeholders)
+     * @param params Значения параметров в порядке их следования в запросе. Текст и бинарные данные не копируются
+     * @return Результат выполнения SQL-запроса.
+     * @note В базовой реализации значения преобразуются в строки и выполняются через exec_prepared, драйверы передают их в базу без преобразования
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    virtual query_result exec_typed(const std::string& query, const bind_parameters& params);
+
+    /**
+     * @brief Выполнить несколько параметризованных запросов за один обмен с базой данных, если драйвер это поддерживает
+     * @param statements Запросы в порядке выполнения
+     * @return Результаты запросов в том же порядке
+     * @note В базовой реализации запросы выполняются последовательно через exec_prepared
+     * @throws sql_exception Выбрасывает исключение с первой ошибкой, запросы после ошибочного не выполняются
+     */
+    virtual std::vector<query_result> exec_batch(const std::vector<batch_statement>& statements);
+
+    /**
+     * @brief Поставить в очередь запрос, результат которого не нужен
+     * @param query SQL-запрос, в котором параметры обозначены placeholder
+     * @param params Значения параметров в порядке их следования в запросе
+     * @note Очередь выполняется одним пакетом через exec_batch перед любым другим запросом или при вызове flush_deferred.
+     * Поэтому ошибка выполнения такого запроса будет выброшена позже, из следующего обращения к базе данных
+     */
+    void exec_deferred(std::string query, std::vector<std::string> params);
+
+    /**
+     * @brief Выполнить запросы из очереди exec_deferred
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    void flush_deferred();
+
+    /**
+     * @brief Массовая вставка строк в таблицу
+     * @param table Имя таблицы в виде, пригодном для подстановки в запрос (в кавычках и со схемой)
+     * @param columns Имена колонок, в которые вставляются значения
+     * @param next_row Функция получения следующей строки. Строка передаётся пустой, значение NULL_VALUE вставляется как NULL
+     * @param returning Имена колонок, значения которых нужно вернуть после вставки. Пустой список - ничего не возвращать
+     * @return Значения колонок returning для вставленных строк в порядке их получения из next_row
+     * @note В базовой реализации строки вставляются пачками INSERT ... VALUES в пределах max_bind_parameters
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    virtual query_result bulk_insert(const std::string& table, const std::vector<std::string>& columns, const row_source& next_row, const std::vector<std::string>& returning);
+
+    /**
+     * @brief Формат обозначения параметров в запросах для exec_prepared
+     * @return true, если параметры обозначаются порядковым номером ($1, $2, ...), false - если знаком вопроса (?)
+     */
+    virtual bool numbered_placeholders() const;
+
+    /**
+     * @brief Максимальное количество параметров в одном запросе для exec_prepared
+     * @return Ограничение базы данных на количество параметров запроса
+     */
+    virtual size_t max_bind_parameters() const;
+
+    /**
+     * @brief Получить статистику кэша подготовленных запросов, который используется при выполнении exec
+     * @note В базовой реализации кэш отсутствует и возвращается пустая статистика
+     */
+    virtual statement_cache_stats cache_stats() const;
+
     /**
      * @brief Открывает новую транзакцию с уровнем изоляции по умолчанию.
      * @return Возвращает true, если транзакция была успешно открыта, иначе false
@@ -76,7 +199,7 @@ public:
     /**
      * @brief Фиксирует изменения в базе данных с момента начала текущей транзакции.
      */
-    void commit();
+    virtual void commit();
 
     /**
      * @brief Добавляет точку сохранения в текущую транзакцию.
@@ -89,14 +212,22 @@ public:
      * @param save_point Точка сохранения, до которой необходимо откатить изменения.
      * @note Если строка пустая произойдёт откат всех изменений
      */
-    void rollback_to_save_point(const std::string& save_point);
+    virtual void rollback_to_save_point(const std::string& save_point);
 
     /// @brief Откатить все в текущей транзакции.
     void rollback();
 
+protected:
+    /// @brief Удалить запросы из очереди exec_deferred без выполнения
+    void clear_deferred();
+
 protected:
     /// @brief Флаг обозначающий имеется ли открытая транзакция или нет.
     bool _has_transaction = false;
+
+private:
+    /// @brief Очередь запросов exec_deferred
+    std::vector<batch_statement> _deferred {};
 };
 
 } // namespace database_adapter
\ No newline at end of file
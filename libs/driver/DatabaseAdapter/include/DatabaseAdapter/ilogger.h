@@ -1,9 +1,19 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace database_adapter {
 
+/// Уровень сообщений журнала, сообщения уровня ниже заданного не формируются
+enum class log_level : uint8_t
+{
+    sql = 0, ///< Выполняемые запросы
+    error, ///< Ошибки выполнения запросов
+    none ///< Журналирование отключено
+};
+
 /// Класс для добавления логирования запросов и ошибок выполнения
 class ILogger
 {
@@ -19,5 +29,25 @@ public:
      * @param message Сообщения содержащее sql выражение
      */
     virtual void log_sql(const std::string& message) = 0;
+    /**
+     * Проверка нужны ли логгеру сообщения заданного уровня. Вызывается до формирования сообщения
+     * @param level Уровень сообщения
+     * @note В базовой реализации принимаются сообщения всех уровней
+     */
+    virtual bool is_enabled(log_level level) const
+    {
+        return level != log_level::none;
+    }
 };
-} // namespace database_adapter
\ No newline at end of file
+
+/**
+ * Проверка нужно ли формировать сообщение для логгера
+ * @param logger Логгер, может быть nullptr
+ * @param level Уровень сообщения
+ */
+inline bool is_log_enabled(const std::shared_ptr<ILogger>& logger, const log_level level)
+{
+    return logger != nullptr && logger->is_enabled(level);
+}
+
+} // namespace database_adapter
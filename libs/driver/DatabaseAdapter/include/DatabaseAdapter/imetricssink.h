@@ -0,0 +1,20 @@
+#pragma once
+
+#include "model/querymetrics.h"
+
+namespace database_adapter {
+
+/// Класс для получения измерений запросов от instrumented_connection
+class IMetricsSink
+{
+public:
+    virtual ~IMetricsSink() = default;
+    /**
+     * Функция получения измерений одного обращения к базе данных
+     * @param metrics Измерения запроса
+     * @note Вызывается в потоке, который выполнял запрос, сразу после его завершения
+     */
+    virtual void record(const query_metrics& metrics) = 0;
+};
+
+} // namespace database_adapter
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "iconnection.h"
+#include "imetricssink.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace database_adapter {
+
+/**
+ * @brief Соединение, которое передаёт вызовы другому соединению и измеряет каждое обращение к базе данных
+ * @note Измерения передаются в IMetricsSink: время подготовки, выполнения и получения строк,
+ * количество строк, объём переданных данных и отпечаток запроса
+ */
+class instrumented_connection final : public IConnection
+{
+public:
+    /// @brief Функция вычисления отпечатка запроса
+    using fingerprint_function = std::function<uint64_t(const std::string& query)>;
+
+public:
+    /**
+     * @brief Конструктор
+     * @param connection Соединение, к которому передаются вызовы
+     * @param sink Получатель измерений
+     * @param fingerprint Функция вычисления отпечатка запроса, nullptr - хэш нормализованного запроса (см. normalize_sql)
+     * @throws std::invalid_argument Если connection или sink равны nullptr
+     */
+    instrumented_connection(std::shared_ptr<IConnection> connection, std::shared_ptr<IMetricsSink> sink, fingerprint_function fingerprint = nullptr);
+
+    /// @brief Соединение, к которому передаются вызовы
+    std::shared_ptr<IConnection> connection() const;
+
+    bool is_valid() override;
+    bool is_alive() const override;
+    query_result exec(const std::string& query) override;
+    using IConnection::exec_stream;
+    void exec_stream(const std::string& query, const std::vector<std::string>& params, const row_callback& callback) override;
+    void export_stream(const std::string& query, const row_callback& callback) override;
+
+    void prepare(const std::string& query, const std::string& name) override;
+    query_result exec_prepared(const std::vector<std::string>& params, const std::string& name) override;
+    query_result exec_prepared(const std::string& query, const std::vector<std::string>& params) override;
+    query_result exec_typed(const std::string& query, const bind_parameters& params) override;
+    std::vector<query_result> exec_batch(const std::vector<batch_statement>& statements) override;
+    query_result bulk_insert(const std::string& table, const std::vector<std::string>& columns, const row_source& next_row, const std::vector<std::string>& returning) override;
+
+    bool numbered_placeholders() const override;
+    size_t max_bind_parameters() const override;
+    statement_cache_stats cache_stats() const override;
+
+    bool open_transaction(int type) override;
+    void commit() override;
+    void rollback_to_save_point(const std::string& save_point) override;
+
+    /// @brief Отпечаток по умолчанию: хэш запроса, приведённого через normalize_sql
+    static uint64_t default_fingerprint(const std::string& query);
+
+private:
+    /**
+     * @brief Выполняет действие и передаёт его измерения получателю
+     * @param metrics Измерения, в которых уже заполнены описание запроса и объём переданных данных
+     * @param action Действие, которое возвращает результат запроса
+     */
+    query_result measure(query_metrics metrics, const std::function<query_result()>& action);
+
+    /**
+     * @brief Выполняет потоковую выборку и передаёт её измерения получателю
+     * @param metrics Измерения, в которых уже заполнено описание запроса
+     * @param callback Функция обработки строк пользователя
+     * @param action Действие, которое выполняет выборку с переданной функцией обработки строк
+     */
+    void measure_stream(query_metrics metrics, const row_callback& callback, const std::function<void(const row_callback&)>& action);
+
+    /// @brief Заполняет описание запроса
+    query_metrics make_metrics(const char* call, const std::string& query, size_t bytes_sent) const;
+
+    /// @brief Передаёт измерения получателю, ошибки получателя не влияют на выполнение запроса
+    void publish(const query_metrics& metrics);
+
+private:
+    std::shared_ptr<IConnection> _connection;
+    std::shared_ptr<IMetricsSink> _sink;
+    fingerprint_function _fingerprint;
+
+    /// @brief Тексты именованных подготовленных запросов для измерений exec_prepared по имени
+    std::unordered_map<std::string, std::string> _prepared {};
+};
+
+} // namespace database_adapter
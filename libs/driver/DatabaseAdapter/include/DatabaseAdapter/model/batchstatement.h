@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace database_adapter {
+
+/// @brief Запрос пакетного выполнения
+struct batch_statement
+{
+    /// @brief SQL-запрос, в котором параметры обозначены placeholder
+    std::string query {};
+    /// @brief Значения параметров в порядке их следования в запросе
+    std::vector<std::string> params {};
+};
+
+} // namespace database_adapter
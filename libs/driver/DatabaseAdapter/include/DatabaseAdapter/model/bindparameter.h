@@ -0,0 +1,133 @@
+#pragma once
+
+#include "textview.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace database_adapter {
+
+/**
+ * @brief Типизированное значение параметра запроса
+ * @note Текст и бинарные данные не копируются, поэтому они должны жить до окончания выполнения запроса
+ */
+class bind_parameter
+{
+public:
+    /// @brief Тип значения параметра
+    enum class value_type : uint8_t
+    {
+        null, ///< Значение NULL
+        integer, ///< Целое число
+        real, ///< Число с плавающей точкой
+        text, ///< Текстовое значение
+        blob ///< Бинарное значение
+    };
+
+public:
+    /// @brief Размер буфера, достаточный для текстового представления любого числа вместе с завершающим нулём
+    static constexpr size_t max_number_length = 32;
+
+public:
+    /// @brief Значение NULL
+    bind_parameter() = default;
+
+    /// @brief Значение NULL
+    bind_parameter(std::nullptr_t);
+
+    /// @brief Целое число, bool передаётся как 0 или 1
+    template<typename Integer, std::enable_if_t<std::is_integral<Integer>::value, bool> = true>
+    bind_parameter(const Integer value)
+        : _type(value_type::integer)
+        , _integer(static_cast<int64_t>(value))
+    {
+    }
+
+    /// @brief Число с плавающей точкой
+    template<typename Real, std::enable_if_t<std::is_floating_point<Real>::value, bool> = true>
+    bind_parameter(const Real value)
+        : _type(value_type::real)
+        , _real(static_cast<double>(value))
+    {
+    }
+
+    /**
+     * @brief Текстовое значение
+     * @note Для совместимости со строковыми параметрами значение NULL_VALUE передаётся как NULL
+     */
+    bind_parameter(const std::string& value);
+
+    /// @brief Текстовое значение, nullptr передаётся как NULL
+    bind_parameter(const char* value);
+
+    /// @brief Текстовое значение
+    bind_parameter(text_view value);
+
+    /**
+     * @brief Создаёт бинарное значение
+     * @param data Указатель на начало данных
+     * @param size Размер данных в байтах
+     */
+    static bind_parameter blob(const void* data, size_t size);
+
+    /// @brief Тип значения
+    value_type type() const;
+
+    /// @brief Проверка на NULL
+    bool is_null() const;
+
+    /// @brief Целое число, для других типов возвращается 0
+    int64_t as_int64() const;
+
+    /// @brief Число с плавающей точкой, для других типов возвращается 0
+    double as_double() const;
+
+    /// @brief Указатель на начало текстового или бинарного значения
+    const char* data() const;
+
+    /// @brief Размер текстового или бинарного значения в байтах
+    size_t size() const;
+
+    /// @brief Завершается ли текстовое значение нулевым символом, что позволяет передать его без копирования в API, ожидающие C-строку
+    bool is_null_terminated() const;
+
+    /**
+     * @brief Записывает текстовое представление числа в буфер без выделения памяти
+     * @param buffer Буфер размером не меньше max_number_length
+     * @return Количество записанных символов без завершающего нуля, 0 если значение не является числом
+     */
+    size_t format_number(char* buffer) const;
+
+    /**
+     * @brief Текстовое представление значения
+     * @return Строка, для NULL возвращается NULL_VALUE
+     */
+    std::string to_string() const;
+
+private:
+    value_type _type = value_type::null;
+    bool _null_terminated = false;
+
+    union
+    {
+        int64_t _integer = 0;
+        double _real;
+    };
+
+    const char* _data = nullptr;
+    size_t _size = 0;
+};
+
+/// @brief Значения параметров запроса в порядке их следования в запросе
+using bind_parameters = std::vector<bind_parameter>;
+
+/// @brief Формирует строку со значениями параметров для логирования
+std::string params_to_string(const std::vector<std::string>& params);
+
+/// @brief Формирует строку со значениями типизированных параметров для логирования, бинарные данные заменяются их размером
+std::string params_to_string(const bind_parameters& params);
+
+} // namespace database_adapter
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <string>
 
 namespace database_adapter {
@@ -17,6 +19,10 @@ struct database_connection_settings
     std::string login {};
     /// @brief Пароль пользователя для авторизации
     std::string password {};
+    /// @brief Максимальное количество подготовленных запросов, которые соединение хранит в кэше. 0 - кэширование отключено
+    size_t statement_cache_size = 64;
+    /// @brief Максимальное время установки одного подключения
+    std::chrono::milliseconds connect_timeout = std::chrono::seconds(10);
 };
 
 } // namespace DatabaseAdapter
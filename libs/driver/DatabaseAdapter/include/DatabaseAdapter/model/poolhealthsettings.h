@@ -0,0 +1,21 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace database_adapter {
+
+/// @brief Настройки фоновой проверки соединений пула
+struct pool_health_settings
+{
+    /// @brief Период проверки свободных соединений. Запросом к серверу проверяются соединения, не использовавшиеся дольше этого времени. 0 - фоновая проверка отключена
+    std::chrono::milliseconds validation_interval = std::chrono::seconds(30);
+    /// @brief Максимальное время жизни соединения, после которого оно пересоздаётся. 0 - не ограничено
+    std::chrono::milliseconds max_lifetime = std::chrono::milliseconds(0);
+    /// @brief Время простоя, после которого свободное соединение закрывается, если свободных соединений больше min_idle. 0 - не ограничено
+    std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(0);
+    /// @brief Минимальное количество свободных соединений, которое поддерживает фоновая проверка
+    size_t min_idle = 0;
+};
+
+} // namespace database_adapter
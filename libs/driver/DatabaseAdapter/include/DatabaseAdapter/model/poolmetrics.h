@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace database_adapter {
+
+/// @brief Гистограмма времени ожидания соединения из пула
+struct pool_wait_histogram
+{
+    /// @brief Количество корзин гистограммы
+    static constexpr size_t bucket_count = 10;
+
+    /**
+     * @brief Получить верхнюю границу корзины
+     * @param bucket Индекс корзины
+     * @return Верхняя граница времени ожидания, для последней корзины - std::chrono::microseconds::max()
+     */
+    static std::chrono::microseconds upper_bound(size_t bucket);
+
+    /// @brief Добавить время ожидания в соответствующую корзину
+    void add(std::chrono::microseconds wait_time);
+
+    /// @brief Общее количество измерений
+    size_t count() const;
+
+    /// @brief Количество измерений в каждой корзине
+    std::array<size_t, bucket_count> buckets {};
+};
+
+/// @brief Снимок статистики пула соединений
+struct pool_metrics
+{
+    /// @brief Количество выданных соединений
+    size_t active = 0;
+    /// @brief Количество свободных соединений
+    size_t idle = 0;
+    /// @brief Количество соединений пула, включая создаваемые и проверяемые в данный момент
+    size_t total = 0;
+    /// @brief Количество потоков, ожидающих соединение
+    size_t waiting = 0;
+
+    /// @brief Количество успешных получений соединения
+    size_t checkouts = 0;
+    /// @brief Количество получений соединения, завершившихся по истечению времени ожидания
+    size_t timeouts = 0;
+    /// @brief Количество созданных соединений
+    size_t creations = 0;
+    /// @brief Количество ошибок создания соединения
+    size_t creation_failures = 0;
+    /// @brief Количество соединений, закрытых из-за разрыва или неуспешной проверки
+    size_t validation_failures = 0;
+    /// @brief Количество соединений, закрытых из-за истечения времени жизни или простоя
+    size_t evictions = 0;
+    /// @brief Количество откатов транзакций, оставленных открытыми при возврате соединения в пул
+    size_t leaked_transaction_rollbacks = 0;
+
+    /// @brief Время ожидания соединения, включая создание нового
+    pool_wait_histogram wait_histogram {};
+};
+
+} // namespace database_adapter
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace database_adapter {
+
+/// @brief Измерения одного обращения к базе данных
+struct query_metrics
+{
+    /// @brief Метод соединения, через который выполнялся запрос (exec_prepared, exec_stream, ...)
+    const char* call = "";
+    /// @brief Операция, которая выполняла запрос (см. query_source), пустая строка если не задана
+    const char* source = "";
+    /// @brief Текст запроса, для пакета запросов - текст первого запроса
+    std::string query {};
+    /// @brief Отпечаток запроса для группировки одинаковых запросов (см. instrumented_connection::fingerprint_function)
+    uint64_t fingerprint = 0;
+    /// @brief Количество запросов, для пакета запросов больше одного
+    size_t statements = 1;
+
+    /// @brief Время подготовки запроса
+    std::chrono::nanoseconds prepare_time { 0 };
+    /// @brief Время выполнения запроса до получения первой строки. Для запросов с полным результатом включает получение всех строк
+    std::chrono::nanoseconds execute_time { 0 };
+    /// @brief Время получения строк потоковой выборки без учёта времени обработки строк
+    std::chrono::nanoseconds fetch_time { 0 };
+
+    /// @brief Количество полученных строк
+    size_t rows = 0;
+    /// @brief Размер текста запроса и значений параметров в байтах
+    size_t bytes_sent = 0;
+    /// @brief Размер значений полученных строк в байтах
+    size_t bytes_received = 0;
+    /// @brief Запрос завершился исключением
+    bool failed = false;
+};
+
+} // namespace database_adapter
@@ -1,13 +1,22 @@
 #pragma once
 
+#include "textview.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
 #include <list>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace database_adapter {
 
 /**
  * @brief Класс для хранения и представления результатов SQL-запросов
+ * @note Имена колонок хранятся один раз на весь результат, а значения всех ячеек лежат в одном непрерывном буфере.
+ * Доступ к строкам осуществляется через не владеющие представления row_view
  */
 class query_result
 {
@@ -18,44 +27,368 @@ public:
     /// @brief Псевдоним для значения столбца результата
     using value = std::string;
 
-    /// @brief Псевдоним для строки результата запроса
+    /// @brief Псевдоним для строки результата запроса в виде словаря (используется только для совместимости)
     using row = std::unordered_map<column_name, value>;
 
+    /// @brief Имена колонок результата вместе с таблицей поиска номера колонки по имени
+    struct column_set
+    {
+        /// @brief Имена колонок в порядке их следования
+        std::vector<column_name> names {};
+        /// @brief Таблица для поиска номера колонки по имени за O(1)
+        std::unordered_map<column_name, size_t> indexes {};
+    };
+
+    /// @brief Неизменяемый список колонок, который могут разделять несколько результатов без копирования имён
+    using shared_columns = std::shared_ptr<const column_set>;
+
+    /// @brief Представление бинарного значения ячейки
+    using blob_view = text_view;
+
+    /// @brief Значение возвращаемое при отсутствии колонки с заданным именем
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /// @brief Тип значения хранящегося в ячейке
+    enum class cell_type : uint8_t
+    {
+        null, ///< Значение NULL
+        integer, ///< Целое число, доступно без разбора строки
+        real, ///< Число с плавающей точкой, доступно без разбора строки
+        text, ///< Текстовое значение
+        blob ///< Бинарное значение
+    };
+
+    /// @brief Не владеющее представление строки результата
+    class row_view
+    {
+    public:
+        row_view(const query_result* result, size_t row_index);
+
+        /// @brief Количество колонок в строке
+        size_t size() const;
+
+        /// @brief Порядковый номер строки в результате
+        size_t index() const;
+
+        /**
+         * @brief Проверка наличия колонки в строке
+         * @param column Имя колонки
+         * @return Возвращает true, если колонка присутствует в результате, иначе false
+         */
+        bool contains(const column_name& column) const;
+
+        /**
+         * @brief Получить номер колонки по её имени
+         * @param column Имя колонки
+         * @return Номер колонки или npos, если колонки нет в результате
+         */
+        size_t column_index(const column_name& column) const;
+
+        /**
+         * @brief Получить значение ячейки по номеру колонки
+         * @param column_index Номер колонки
+         * @return Представление значения ячейки, для NULL возвращается пустое представление
+         * @throws std::out_of_range Если номер колонки вне диапазона
+         */
+        text_view at(size_t column_index) const;
+
+        /**
+         * @brief Получить значение ячейки по имени колонки
+         * @param column Имя колонки
+         * @return Представление значения ячейки, для NULL возвращается пустое представление
+         * @throws std::out_of_range Если колонки нет в результате
+         */
+        text_view at(const column_name& column) const;
+
+        /**
+         * @brief Проверка содержит ли ячейка NULL
+         * @param column_index Номер колонки
+         * @throws std::out_of_range Если номер колонки вне диапазона
+         */
+        bool is_null(size_t column_index) const;
+
+        /**
+         * @brief Проверка содержит ли ячейка NULL
+         * @param column Имя колонки
+         * @throws std::out_of_range Если колонки нет в результате
+         */
+        bool is_null(const column_name& column) const;
+
+        /**
+         * @brief Получить тип значения ячейки
+         * @param column_index Номер колонки
+         * @throws std::out_of_range Если номер колонки вне диапазона
+         */
+        cell_type type(size_t column_index) const;
+
+        /**
+         * @brief Получить значение ячейки в виде целого числа
+         * @param column_index Номер колонки
+         * @return Значение ячейки, для NULL возвращается 0
+         * @note Для текстовых значений выполняется разбор строки
+         * @throws std::out_of_range Если номер колонки вне диапазона
+         * @throws std::invalid_argument Если текстовое значение не является целым числом
+         */
+        int64_t as_int64(size_t column_index) const;
+
+        /**
+         * @brief Получить значение ячейки в виде числа с плавающей точкой
+         * @param column_index Номер колонки
+         * @return Значение ячейки, для NULL возвращается 0
+         * @note Для текстовых значений выполняется разбор строки
+         * @throws std::out_of_range Если номер колонки вне диапазона
+         * @throws std::invalid_argument Если текстовое значение не является числом
+         */
+        double as_double(size_t column_index) const;
+
+        /**
+         * @brief Получить текстовое значение ячейки
+         * @param column_index Номер колонки
+         * @return Представление значения ячейки, для NULL возвращается пустое представление
+         * @throws std::out_of_range Если номер колонки вне диапазона
+         */
+        text_view as_text(size_t column_index) const;
+
+        /**
+         * @brief Получить бинарное значение ячейки
+         * @param column_index Номер колонки
+         * @return Представление значения ячейки, для NULL возвращается пустое представление
+         * @throws std::out_of_range Если номер колонки вне диапазона
+         */
+        blob_view as_blob(size_t column_index) const;
+
+        /**
+         * @brief Создаёт копию строки в виде словаря
+         * @return Словарь имя колонки - значение
+         */
+        row to_row() const;
+
+    private:
+        const query_result* _result;
+        size_t _row_index;
+    };
+
+    /// @brief Итератор по строкам результата
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = row_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const row_view*;
+        using reference = row_view;
+
+        const_iterator(const query_result* result, size_t row_index);
+
+        row_view operator*() const;
+
+        const_iterator& operator++();
+        const_iterator operator++(int);
+
+        bool operator==(const const_iterator& rhs) const;
+        bool operator!=(const const_iterator& rhs) const;
+
+    private:
+        const query_result* _result;
+        size_t _row_index;
+    };
+
+public:
     query_result() = default;
 
     /**
-     * @brief Конструктор, который принимает список result_row и инициализирует результат запроса
-     * @param result Список result_row для инициализации результата
+     * @brief Конструктор, который инициализирует результат запроса списком колонок
+     * @param columns Имена колонок результата в порядке их следования
+     */
+    explicit query_result(std::vector<column_name> columns);
+
+    /**
+     * @brief Конструктор, который инициализирует результат запроса списком колонок
+     * @param columns Имена колонок результата в порядке их следования
+     * @note Позволяет записывать колонки списком { "id", "name" }, не путая его со списком строк
+     */
+    explicit query_result(std::initializer_list<column_name> columns);
+
+    /**
+     * @brief Конструктор, который принимает список строк и инициализирует результат запроса
+     * @param result Список строк, колонки берутся из первой строки
+     * @throws std::invalid_argument Если строки содержат разные колонки
      */
     explicit query_result(const std::list<row>& result);
 
     /**
-     * @brief Добавляет новую строку результата в конец списка
-     * @param value Строка результата для добавления
+     * @brief Задаёт список колонок результата
+     * @param columns Имена колонок результата в порядке их следования
+     * @note Очищает ранее добавленные значения
+     */
+    void set_columns(std::vector<column_name> columns);
+
+    /**
+     * @brief Задаёт результату готовый список колонок без копирования имён
+     * @param columns Список колонок, полученный через make_columns
+     * @note Очищает ранее добавленные значения
+     */
+    void set_columns(shared_columns columns);
+
+    /**
+     * @brief Формирует список колонок, который можно задать нескольким результатам
+     * @param columns Имена колонок результата в порядке их следования
+     */
+    static shared_columns make_columns(std::vector<column_name> columns);
+
+    /**
+     * @brief Резервирует память под ожидаемый объём результата
+     * @param rows Ожидаемое количество строк
+     * @param bytes Ожидаемый суммарный размер значений в байтах
+     */
+    void reserve(size_t rows, size_t bytes = 0);
+
+    /**
+     * @brief Удаляет все строки результата
+     * @note Список колонок и выделенная память сохраняются, что позволяет переиспользовать объект при построчном чтении
+     */
+    void clear();
+
+    /**
+     * @brief Добавляет значение следующей ячейки. Строки заполняются последовательно слева направо
+     * @param data Указатель на начало значения
+     * @param size Размер значения в байтах
+     * @note Если data равен nullptr, то ячейка считается NULL
+     * @throws std::length_error Если размер значения больше 4 ГиБ
+     */
+    void add_value(const char* data, size_t size);
+
+    /// @brief Добавляет в следующую ячейку значение NULL
+    void add_null();
+
+    /**
+     * @brief Добавляет новую строку результата в конец
+     * @param value Строка результата, если колонки ещё не заданы, они берутся из строки
+     * @throws std::invalid_argument Если колонки строки не совпадают с колонками результата
      */
     void add(const row& value);
 
     /**
-     * @brief Возвращает копию результата
-     * @return Возвращает копию списка строк полученных после выполнения запроса
+     * @brief Добавляет в конец все строки другого результата
+     * @param other Результат с теми же колонками
+     * @note Если колонки ещё не заданы, они берутся из other
+     * @throws std::invalid_argument Если количество колонок не совпадает
      */
-    std::list<row> data() const;
+    void append(const query_result& other);
 
     /**
-     * @brief Возвращает ссылку на результат
-     * @return Возвращает ссылку на список строк полученных после выполнения запроса
+     * @brief Добавляет в следующую ячейку целое число
+     * @param value Значение ячейки
+     * @note Текстовое представление формируется сразу, чтобы оно было доступно через at()
      */
-    std::list<row>& mutable_data();
+    void add_int64(int64_t value);
+
+    /**
+     * @brief Добавляет в следующую ячейку число с плавающей точкой
+     * @param value Значение ячейки
+     * @note Текстовое представление формируется в том же формате, что и у sqlite (15 значащих цифр)
+     */
+    void add_double(double value);
+
+    /**
+     * @brief Добавляет в следующую ячейку число с плавающей точкой с заданным текстовым представлением
+     * @param value Значение ячейки
+     * @param text Текстовое представление, возвращаемое через at()
+     * @param size Размер текстового представления в байтах
+     */
+    void add_double(double value, const char* text, size_t size);
+
+    /**
+     * @brief Добавляет в следующую ячейку бинарное значение
+     * @param data Указатель на начало значения
+     * @param size Размер значения в байтах
+     * @note Если data равен nullptr, то ячейка считается NULL
+     * @throws std::length_error Если размер значения больше 4 ГиБ
+     */
+    void add_blob(const void* data, size_t size);
+
+    /// @brief Имена колонок результата в порядке их следования
+    const std::vector<column_name>& columns() const;
+
+    /**
+     * @brief Получить номер колонки по её имени
+     * @param column Имя колонки
+     * @return Номер колонки или npos, если колонки нет в результате
+     */
+    size_t column_index(const column_name& column) const;
+
+    /// @brief Количество строк в результате
+    size_t size() const;
+
+    /// @brief Суммарный размер значений всех ячеек в байтах
+    size_t data_size() const;
 
     /**
      * @brief Проверка на пустоту полученного результата
-     * @return Возвращает true, если список пустой, иначе false
+     * @return Возвращает true, если строк нет, иначе false
      */
     bool empty() const;
 
+    /**
+     * @brief Получить строку по её номеру
+     * @param row_index Номер строки
+     * @throws std::out_of_range Если номер строки вне диапазона
+     */
+    row_view at(size_t row_index) const;
+
+    row_view operator[](size_t row_index) const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /**
+     * @brief Возвращает копию результата в виде списка словарей
+     * @return Возвращает копию списка строк полученных после выполнения запроса
+     * @note Оставлено для совместимости, для обхода результата стоит использовать итераторы
+     */
+    std::list<row> data() const;
+
+    /**
+     * @brief Возвращает копию результата в виде списка словарей
+     * @deprecated Результат хранится в едином буфере и не может изменяться через список. Для чтения стоит использовать итераторы, для заполнения add_value
+     */
+    [[deprecated("use begin()/end() to read rows and add_value() to fill the result")]] std::list<row> mutable_data() const;
+
+private:
+    /// @brief Расположение значения ячейки внутри буфера
+    struct cell
+    {
+        size_t offset = 0;
+        /// @brief Размер значения, 32 бита оставляют ячейку в 24 байтах. Значения больше 4 ГиБ не добавляются
+        uint32_t size = 0;
+        cell_type type = cell_type::text;
+        /// @brief Значение для ячеек с типом integer и real
+        union
+        {
+            int64_t integer;
+            double real;
+        };
+    };
+
+    const cell& cell_at(size_t row_index, size_t column_index) const;
+
+    /// @brief Копирует значение в буфер и добавляет ячейку заданного типа
+    cell& append_cell(const char* data, size_t size, cell_type type);
+
+private:
+    /// @brief Общий для всех результатов пустой список колонок
+    static const shared_columns& empty_columns();
+
+    /// @brief Список колонок результата, в том числе после перемещения результата
+    const column_set& column_info() const;
+
 private:
-    /// @brief Поле, которое хранит список всех строк результатов запроса
-    std::list<row> _result = {};
+    /// @brief Имена колонок результата
+    shared_columns _columns = empty_columns();
+    /// @brief Расположение значений всех ячеек построчно
+    std::vector<cell> _cells {};
+    /// @brief Буфер содержащий значения всех ячеек, каждое значение завершается нулевым символом
+    std::string _buffer {};
 };
 
 } // namespace database_adapter
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace database_adapter {
+
+/**
+ * @brief Гистограмма времени выполнения запросов
+ * @note Корзины растут в степенях двойки, каждая степень делится на 16 равных корзин,
+ * поэтому погрешность перцентиля не превышает 1/16 значения
+ */
+struct latency_histogram
+{
+    /// @brief Количество корзин внутри одной степени двойки
+    static constexpr size_t sub_bucket_count = 16;
+    /// @brief Количество корзин гистограммы. Значения от 2^40 нс (около 18 минут) попадают в последнюю корзину
+    static constexpr size_t bucket_count = 592;
+
+    /// @brief Получить нижнюю границу корзины в наносекундах
+    static uint64_t lower_bound(size_t bucket);
+
+    /// @brief Добавить время выполнения в соответствующую корзину
+    void add(std::chrono::nanoseconds time);
+
+    /**
+     * @brief Получить перцентиль времени выполнения
+     * @param percent Перцентиль от 0 до 100
+     * @return Верхняя граница корзины, в которую попадает перцентиль, 0 если измерений нет
+     */
+    std::chrono::nanoseconds percentile(double percent) const;
+
+    /// @brief Общее количество измерений
+    size_t count() const;
+
+    /// @brief Количество измерений в каждой корзине
+    std::array<uint32_t, bucket_count> buckets {};
+};
+
+/// @brief Накопленная статистика запросов с одинаковым отпечатком
+struct statement_summary
+{
+    /// @brief Отпечаток запроса
+    uint64_t fingerprint = 0;
+    /// @brief Текст первого запроса с этим отпечатком
+    std::string query {};
+    /// @brief Операция, которая первой выполнила запрос (см. query_source)
+    const char* source = "";
+
+    /// @brief Количество выполнений
+    size_t calls = 0;
+    /// @brief Количество выполнений, завершившихся исключением
+    size_t failures = 0;
+    /// @brief Суммарное количество полученных строк
+    size_t rows = 0;
+    /// @brief Суммарный размер текста запросов и значений параметров в байтах
+    size_t bytes_sent = 0;
+    /// @brief Суммарный размер полученных значений в байтах
+    size_t bytes_received = 0;
+
+    /// @brief Суммарное время подготовки, выполнения и получения строк
+    std::chrono::nanoseconds total_time { 0 };
+    /// @brief Минимальное время одного выполнения
+    std::chrono::nanoseconds min_time { 0 };
+    /// @brief Максимальное время одного выполнения
+    std::chrono::nanoseconds max_time { 0 };
+    /// @brief 99-й перцентиль времени одного выполнения
+    std::chrono::nanoseconds p99_time { 0 };
+};
+
+} // namespace database_adapter
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace database_adapter {
+
+/**
+ * @brief Не владеющее представление строки, указывающее на данные внутри результата запроса
+ * @note Живёт не дольше объекта из которого было получено
+ */
+class text_view
+{
+public:
+    text_view() = default;
+
+    /**
+     * @brief Конструктор, который принимает указатель на начало данных и их размер
+     * @param data Указатель на начало данных
+     * @param size Размер данных в байтах
+     */
+    text_view(const char* data, size_t size);
+
+    text_view(const text_view& other) = default;
+    text_view(text_view&& other) noexcept = default;
+    text_view& operator=(const text_view& other) = default;
+    text_view& operator=(text_view&& other) noexcept = default;
+
+    ~text_view() = default;
+
+    /// @brief Указатель на начало данных
+    const char* data() const;
+
+    /// @brief Размер данных в байтах
+    size_t size() const;
+
+    /// @brief Проверка на пустоту
+    bool empty() const;
+
+    /**
+     * @brief Создаёт копию данных
+     * @return Строка содержащая копию данных
+     */
+    std::string str() const;
+
+    bool operator==(const text_view& rhs) const;
+    bool operator!=(const text_view& rhs) const;
+
+    bool operator==(const std::string& rhs) const;
+    bool operator!=(const std::string& rhs) const;
+
+    bool operator==(const char* rhs) const;
+    bool operator!=(const char* rhs) const;
+
+private:
+    const char* _data = "";
+    size_t _size = 0;
+};
+
+} // namespace database_adapter
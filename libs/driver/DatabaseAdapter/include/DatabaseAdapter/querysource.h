@@ -0,0 +1,34 @@
+#pragma once
+
+namespace database_adapter {
+
+/**
+ * @brief Описание операции, которая выполняет запросы в текущем потоке
+ * @note Описание задаётся на время жизни объекта. Вложенные объекты описание не меняют,
+ * поэтому запросы относятся к самой внешней операции
+ */
+class query_source
+{
+public:
+    /**
+     * @brief Задаёт описание операции, если оно ещё не задано
+     * @param name Описание операции, строка должна жить до конца работы программы (строковый литерал)
+     */
+    explicit query_source(const char* name);
+
+    query_source(const query_source& other) = delete;
+    query_source(query_source&& other) noexcept = delete;
+    query_source& operator=(const query_source& other) = delete;
+    query_source& operator=(query_source&& other) noexcept = delete;
+
+    ~query_source();
+
+    /// @brief Описание текущей операции потока или nullptr, если оно не задано
+    static const char* current();
+
+private:
+    /// @brief Описание было задано этим объектом
+    bool _owner = false;
+};
+
+} // namespace database_adapter
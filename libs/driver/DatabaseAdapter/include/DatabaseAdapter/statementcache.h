@@ -0,0 +1,178 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace database_adapter {
+
+/// @brief Статистика работы кэша подготовленных запросов
+struct statement_cache_stats
+{
+    /// @brief Количество запросов, для которых был найден подготовленный запрос
+    size_t hits = 0;
+    /// @brief Количество запросов, которые пришлось подготовить заново
+    size_t misses = 0;
+    /// @brief Количество запросов вытесненных из кэша
+    size_t evictions = 0;
+    /// @brief Текущее количество запросов в кэше
+    size_t size = 0;
+    /// @brief Максимальное количество запросов в кэше
+    size_t capacity = 0;
+};
+
+/**
+ * @brief Найти конец фрагмента запроса, который переносится без изменений
+ * @param query SQL-запрос
+ * @param position Позиция начала фрагмента
+ * @return Позиция после строкового литерала ('...', E'...', $tag$...$tag$), идентификатора в кавычках или комментария,
+ * который начинается в позиции position, иначе position
+ */
+size_t verbatim_span_end(const std::string& query, size_t position);
+
+/**
+ * @brief Приводит SQL-запрос к виду, который используется как ключ кэша
+ * @param query SQL-запрос
+ * @return Запрос без пробелов по краям и завершающих ';', в котором последовательности пробельных символов
+ * вне строковых литералов, идентификаторов в кавычках и комментариев заменены одним пробелом
+ */
+std::string normalize_sql(const std::string& query);
+
+/**
+ * @brief Ограниченный по размеру кэш подготовленных запросов с вытеснением давно не используемых (LRU)
+ * @tparam Statement Тип подготовленного запроса драйвера
+ */
+template<typename Statement>
+class statement_cache
+{
+public:
+    /// @brief Функция освобождения подготовленного запроса при вытеснении из кэша
+    using deleter = std::function<void(Statement&)>;
+
+public:
+    /**
+     * @brief Конструктор кэша
+     * @param capacity Максимальное количество запросов в кэше, 0 - кэширование отключено
+     * @param deleter Функция освобождения подготовленного запроса
+     */
+    statement_cache(const size_t capacity, deleter deleter)
+        : _capacity(capacity)
+        , _deleter(std::move(deleter))
+    {
+    }
+
+    statement_cache(const statement_cache& other) = delete;
+    statement_cache(statement_cache&& other) noexcept = delete;
+    statement_cache& operator=(const statement_cache& other) = delete;
+    statement_cache& operator=(statement_cache&& other) noexcept = delete;
+
+    ~statement_cache()
+    {
+        clear();
+    }
+
+    /// @brief Включено ли кэширование
+    bool enabled() const
+    {
+        return _capacity != 0;
+    }
+
+    /**
+     * @brief Найти подготовленный запрос и отметить его как последний использованный
+     * @param key Нормализованный SQL-запрос
+     * @return Указатель на подготовленный запрос или nullptr, если запроса нет в кэше
+     */
+    Statement* find(const std::string& key)
+    {
+        const auto it = _index.find(key);
+        if(it == _index.end()) {
+            _stats.misses++;
+            return nullptr;
+        }
+
+        _stats.hits++;
+        _items.splice(_items.begin(), _items, it->second);
+
+        return &it->second->second;
+    }
+
+    /**
+     * @brief Добавить подготовленный запрос в кэш
+     * @param key Нормализованный SQL-запрос
+     * @param statement Подготовленный запрос
+     * @return Ссылка на запрос внутри кэша
+     * @note При переполнении вытесняется запрос, который дольше всех не использовался
+     */
+    Statement& insert(const std::string& key, Statement statement)
+    {
+        erase(key);
+
+        while(!_items.empty() && _items.size() >= _capacity) {
+            evict(std::prev(_items.end()));
+            _stats.evictions++;
+        }
+
+        _items.emplace_front(key, std::move(statement));
+        _index.emplace(key, _items.begin());
+
+        return _items.front().second;
+    }
+
+    /**
+     * @brief Удалить подготовленный запрос из кэша
+     * @param key Нормализованный SQL-запрос
+     */
+    void erase(const std::string& key)
+    {
+        const auto it = _index.find(key);
+        if(it != _index.end()) {
+            evict(it->second);
+        }
+    }
+
+    /// @brief Освободить все подготовленные запросы
+    void clear()
+    {
+        while(!_items.empty()) {
+            evict(_items.begin());
+        }
+    }
+
+    /// @brief Получить статистику работы кэша
+    statement_cache_stats stats() const
+    {
+        auto stats = _stats;
+        stats.size = _items.size();
+        stats.capacity = _capacity;
+
+        return stats;
+    }
+
+private:
+    using item = std::pair<std::string, Statement>;
+
+    void evict(typename std::list<item>::iterator it)
+    {
+        _index.erase(it->first);
+
+        if(_deleter != nullptr) {
+            _deleter(it->second);
+        }
+
+        _items.erase(it);
+    }
+
+private:
+    size_t _capacity;
+    deleter _deleter;
+
+    /// @brief Запросы в порядке использования, первым идёт последний использованный
+    std::list<item> _items {};
+    std::unordered_map<std::string, typename std::list<item>::iterator> _index {};
+
+    statement_cache_stats _stats {};
+};
+
+} // namespace database_adapter
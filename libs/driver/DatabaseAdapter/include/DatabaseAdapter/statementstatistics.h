@@ -0,0 +1,73 @@
+#pragma once
+
+#include "imetricssink.h"
+#include "model/statementsummary.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace database_adapter {
+
+/**
+ * @brief Таблица статистики запросов, сгруппированных по отпечатку
+ * @note Получает измерения от instrumented_connection. Чтобы запросы с разными значениями литералов попадали в одну строку,
+ * соединение создаётся с функцией отпечатка query_craft::sql_fingerprint. Таблица может использоваться несколькими соединениями
+ */
+class statement_statistics final : public IMetricsSink
+{
+public:
+    /**
+     * @brief Конструктор
+     * @param max_statements Максимальное количество отпечатков в таблице. Запросы с новыми отпечатками сверх него учитываются только в untracked()
+     */
+    explicit statement_statistics(size_t max_statements = 5000);
+
+    void record(const query_metrics& metrics) override;
+
+    /// @brief Снимок статистики всех запросов, отсортированный по убыванию суммарного времени
+    std::vector<statement_summary> snapshot() const;
+
+    /**
+     * @brief Получить статистику запроса
+     * @param fingerprint Отпечаток запроса
+     * @return Статистика запроса, calls == 0 если запрос не выполнялся
+     */
+    statement_summary get(uint64_t fingerprint) const;
+
+    /**
+     * @brief Вывести таблицу статистики в текстовом виде
+     * @param stream Поток вывода
+     * @param limit Количество запросов с наибольшим суммарным временем, 0 - все запросы
+     */
+    void dump(std::ostream& stream, size_t limit = 0) const;
+
+    /// @brief Удалить накопленную статистику
+    void reset();
+
+    /// @brief Количество выполнений запросов, не попавших в таблицу из-за ограничения max_statements
+    size_t untracked() const;
+
+private:
+    /// @brief Строка таблицы
+    struct entry
+    {
+        statement_summary summary {};
+        latency_histogram histogram {};
+    };
+
+    /// @brief Формирует снимок строки с вычисленным перцентилем
+    static statement_summary make_summary(const entry& value);
+
+private:
+    const size_t _max_statements;
+
+    mutable std::mutex _mutex {};
+    std::unordered_map<uint64_t, entry> _entries {};
+    size_t _untracked = 0;
+};
+
+} // namespace database_adapter
@@ -0,0 +1,196 @@
+#include "DatabaseAdapter/asynclogger.h"
+
+#include <stdexcept>
+
+namespace database_adapter {
+
+namespace {
+
+/// Ближайшая степень двойки не меньше value
+size_t round_up_to_power_of_two(const size_t value)
+{
+    size_t result = 2;
+    while(result < value) {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+} // namespace
+
+async_logger::async_logger(std::shared_ptr<ILogger> sink, const size_t capacity, const log_level level)
+    : _sink(std::move(sink))
+    , _level(level)
+    , _slots(new slot[round_up_to_power_of_two(capacity)])
+    , _mask(round_up_to_power_of_two(capacity) - 1)
+{
+    if(_sink == nullptr) {
+        throw std::invalid_argument("Logger sink is null");
+    }
+
+    for(size_t i = 0; i <= _mask; i++) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    _thread = std::thread(&async_logger::drain_loop, this);
+}
+
+async_logger::~async_logger()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(_lock);
+        _stopped = true;
+    }
+    _wake_up.notify_one();
+
+    _thread.join();
+}
+
+void async_logger::log_error(const std::string& message)
+{
+    push(log_level::error, message);
+}
+
+void async_logger::log_sql(const std::string& message)
+{
+    push(log_level::sql, message);
+}
+
+bool async_logger::is_enabled(const log_level level) const
+{
+    return level != log_level::none && level >= _level.load(std::memory_order_relaxed);
+}
+
+void async_logger::set_level(const log_level level)
+{
+    _level.store(level, std::memory_order_relaxed);
+}
+
+void async_logger::flush()
+{
+    const auto target = _enqueue_position.load(std::memory_order_acquire);
+
+    std::unique_lock<std::mutex> lock_guard(_lock);
+    _wake_up.notify_one();
+    _drained.wait(lock_guard, [this, target]() { return _processed.load(std::memory_order_acquire) >= target || _stopped; });
+}
+
+size_t async_logger::dropped() const
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+void async_logger::push(const log_level level, const std::string& message)
+{
+    if(!is_enabled(level)) {
+        return;
+    }
+
+    auto position = _enqueue_position.load(std::memory_order_relaxed);
+    slot* cell = nullptr;
+
+    while(true) {
+        cell = &_slots[position & _mask];
+        const auto sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if(difference == 0) {
+            if(_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if(difference < 0) {
+            // Буфер заполнен: сообщение отбрасывается, чтобы не задерживать выполнение запроса
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = _enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->level = level;
+    cell->message = message;
+    cell->sequence.store(position + 1, std::memory_order_release);
+
+    // Барьер парный барьеру в drain_loop: либо поток логгера увидит сообщение, либо этот поток увидит флаг ожидания
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(_sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock_guard(_lock);
+        _wake_up.notify_one();
+    }
+}
+
+bool async_logger::pop(log_level& level, std::string& message)
+{
+    const auto position = _dequeue_position.load(std::memory_order_relaxed);
+    auto& cell = _slots[position & _mask];
+
+    if(cell.sequence.load(std::memory_order_acquire) != position + 1) {
+        return false;
+    }
+
+    level = cell.level;
+    message.swap(cell.message);
+    cell.message.clear();
+
+    _dequeue_position.store(position + 1, std::memory_order_relaxed);
+    cell.sequence.store(position + _mask + 1, std::memory_order_release);
+
+    return true;
+}
+
+bool async_logger::has_message() const
+{
+    const auto position = _dequeue_position.load(std::memory_order_relaxed);
+    return _slots[position & _mask].sequence.load(std::memory_order_acquire) == position + 1;
+}
+
+void async_logger::deliver(const log_level level, const std::string& message)
+{
+    try {
+        if(level == log_level::error) {
+            _sink->log_error(message);
+        } else {
+            _sink->log_sql(message);
+        }
+    } catch(...) {
+        // Ошибка записи журнала не должна останавливать поток логгера
+    }
+
+    _processed.fetch_add(1, std::memory_order_release);
+}
+
+void async_logger::drain_loop()
+{
+    log_level level = log_level::sql;
+    std::string message;
+
+    while(true) {
+        while(pop(level, message)) {
+            deliver(level, message);
+        }
+
+        std::unique_lock<std::mutex> lock_guard(_lock);
+        _drained.notify_all();
+
+        if(_stopped) {
+            // Сообщения, добавленные после последнего чтения, также передаются приёмнику
+            lock_guard.unlock();
+            while(pop(level, message)) {
+                deliver(level, message);
+            }
+            return;
+        }
+
+        _sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Повторная проверка после установки флага, чтобы не пропустить сообщение, добавленное до него
+        if(!has_message()) {
+            _wake_up.wait(lock_guard);
+        }
+        _sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+} // namespace database_adapter
@@ -0,0 +1,31 @@
+#include "DatabaseAdapter/backoff.h"
+
+#include <algorithm>
+#include <random>
+
+namespace database_adapter {
+
+exponential_backoff::exponential_backoff(const std::chrono::milliseconds initial_delay, const std::chrono::milliseconds max_delay)
+    : _initial_delay(std::max(initial_delay, std::chrono::milliseconds(1)))
+    , _max_delay(std::max(max_delay, _initial_delay))
+    , _delay(_initial_delay)
+{
+}
+
+std::chrono::milliseconds exponential_backoff::next_delay()
+{
+    thread_local std::mt19937 generator(std::random_device {}());
+
+    const auto delay = _delay;
+    _delay = std::min(_delay * 2, _max_delay);
+
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> distribution(delay.count() / 2, delay.count());
+    return std::chrono::milliseconds(distribution(generator));
+}
+
+void exponential_backoff::reset()
+{
+    _delay = _initial_delay;
+}
+
+} // namespace database_adapter
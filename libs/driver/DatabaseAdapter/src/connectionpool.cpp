@@ -1,98 +1,807 @@
 #include "DatabaseAdapter/connectionpool.h"
 
 #include <algorithm>
-#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <vector>
 
 namespace database_adapter {
-IConnectionPool::IConnectionPool(database_connection_settings settings, const size_t start_pool_size, const size_t max_pool_size, const std::chrono::seconds wait_time)
-    : _settings(std::move(settings))
-    , _start_pool_size(start_pool_size)
-    , _max_pool_size(max_pool_size)
-    , _wait_time(wait_time)
+
+using pool_clock = std::chrono::steady_clock;
+
+/// @brief Поток, ожидающий освобождения соединения
+struct connection_waiter
+{
+    std::condition_variable condition {};
+    /// @brief Соединение, переданное ожидающему потоку при возврате в пул
+    std::shared_ptr<IConnection> connection {};
+    pool_clock::time_point created_at {};
+};
+
+/// @brief Свободное соединение пула
+struct idle_connection
+{
+    std::shared_ptr<IConnection> connection {};
+    pool_clock::time_point created_at {};
+    /// @brief Время возврата соединения в пул
+    pool_clock::time_point idle_since {};
+    /// @brief Время последней проверки соединения фоновым потоком
+    pool_clock::time_point validated_at {};
+};
+
+/// @brief Общее состояние пула. Разделяется с выданными соединениями, чтобы они могли вернуться в пул
+struct connection_pool_state
+{
+    std::mutex lock {};
+
+    database_connection_settings settings {};
+    pool_health_settings health_settings {};
+
+    size_t start_pool_size = 2;
+    size_t max_pool_size = 10;
+    /// @brief Количество стартовых соединений, готовность которых ожидается при прогреве
+    size_t warm_up_min_ready = std::numeric_limits<size_t>::max();
+    std::chrono::milliseconds wait_time = std::chrono::seconds(2);
+
+    /// @brief Поколение настроек, увеличивается при их изменении
+    size_t generation = 0;
+    /// @brief Количество созданных соединений, включая выданные, проверяемые и создаваемые в данный момент
+    size_t total = 0;
+    bool initialized = false;
+    bool closed = false;
+
+    /// @brief Свободные соединения, последним идёт последнее возвращённое
+    std::deque<idle_connection> idle {};
+    /// @brief Очередь ожидающих потоков, первым идёт самый давний
+    std::deque<connection_waiter*> waiters {};
+
+    /// @brief Флаг остановки фонового потока
+    bool stop_health_check = false;
+    std::condition_variable health_check_condition {};
+
+    /// @brief Накопленные счётчики статистики
+    pool_metrics counters {};
+    /// @brief Количество выданных соединений
+    size_t leased = 0;
+
+    IConnectionPool::metrics_callback metrics_callback {};
+    std::chrono::milliseconds metrics_interval = std::chrono::milliseconds(0);
+
+    /// @brief Разбудить первый ожидающий поток, чтобы он проверил появление свободного места. Вызывается под lock
+    void notify_first_waiter()
+    {
+        if(!waiters.empty()) {
+            waiters.front()->condition.notify_one();
+        }
+    }
+
+    /// @brief Истекло ли время жизни соединения. Вызывается под lock
+    bool is_expired(const pool_clock::time_point created_at, const pool_clock::time_point now) const
+    {
+        return health_settings.max_lifetime.count() > 0 && now - created_at >= health_settings.max_lifetime;
+    }
+
+    /**
+     * @brief Удалить соединение из пула. Вызывается под lock
+     * @param connection Соединение
+     * @param dead Список, в который переносится соединение, чтобы закрыть его после снятия блокировки
+     */
+    void discard(std::shared_ptr<IConnection>&& connection, std::vector<std::shared_ptr<IConnection>>& dead)
+    {
+        total--;
+        dead.push_back(std::move(connection));
+        notify_first_waiter();
+    }
+
+    /**
+     * @brief Взять последнее возвращённое свободное соединение, закрывая разорванные. Вызывается под lock
+     * @param item Полученное соединение
+     * @param dead Список, в который переносятся разорванные соединения
+     * @return true, если соединение получено
+     */
+    bool take_idle(idle_connection& item, std::vector<std::shared_ptr<IConnection>>& dead)
+    {
+        while(!idle.empty()) {
+            item = std::move(idle.back());
+            idle.pop_back();
+
+            if(item.connection->is_alive()) {
+                leased++;
+                return true;
+            }
+
+            counters.validation_failures++;
+            discard(std::move(item.connection), dead);
+        }
+
+        return false;
+    }
+
+    /// @brief Передать соединение первому ожидающему или положить в список свободных. Вызывается под lock
+    void put_idle(idle_connection&& item)
+    {
+        // Соединение передаётся напрямую первому ожидающему, чтобы его не перехватил вновь пришедший поток
+        if(!waiters.empty()) {
+            auto* waiter = waiters.front();
+            waiters.pop_front();
+
+            waiter->connection = std::move(item.connection);
+            waiter->created_at = item.created_at;
+            waiter->condition.notify_one();
+
+            leased++;
+            return;
+        }
+
+        idle.push_back(std::move(item));
+    }
+
+    /**
+     * @brief Вернуть соединение в пул
+     * @param connection Соединение
+     * @param generation Поколение настроек, с которыми было создано соединение
+     * @param created_at Время создания соединения
+     */
+    void return_connection(std::shared_ptr<IConnection> connection, const size_t generation, const pool_clock::time_point created_at)
+    {
+        // Незавершённая транзакция откатывается до блокировки пула, так как это запрос к базе данных
+        bool reusable = connection->is_alive();
+        const bool has_transaction = reusable && connection->is_transaction();
+        if(has_transaction) {
+            try {
+                connection->rollback();
+            } catch(...) {
+                reusable = false;
+            }
+        }
+
+        // Закрытие соединения выполняется без блокировки пула, поэтому список объявлен до lock_guard
+        std::vector<std::shared_ptr<IConnection>> dead;
+        const auto now = pool_clock::now();
+
+        std::lock_guard<std::mutex> lock_guard(lock);
+
+        leased--;
+        if(has_transaction) {
+            counters.leaked_transaction_rollbacks++;
+        }
+
+        if(!reusable) {
+            counters.validation_failures++;
+        } else if(is_expired(created_at, now)) {
+            counters.evictions++;
+        }
+
+        if(closed || !reusable || generation != this->generation || is_expired(created_at, now)) {
+            discard(std::move(connection), dead);
+            return;
+        }
+
+        put_idle({ std::move(connection), created_at, now });
+    }
+};
+
+connection_lease::connection_lease(std::shared_ptr<connection_pool_state> state, std::shared_ptr<IConnection> connection, const size_t generation, const std::chrono::steady_clock::time_point created_at)
+    : _state(std::move(state))
+    , _connection(std::move(connection))
+    , _generation(generation)
+    , _created_at(created_at)
+{
+}
+
+connection_lease& connection_lease::operator=(connection_lease&& other) noexcept
+{
+    if(this != &other) {
+        release();
+
+        _state = std::move(other._state);
+        _connection = std::move(other._connection);
+        _generation = other._generation;
+        _created_at = other._created_at;
+    }
+
+    return *this;
+}
+
+connection_lease::~connection_lease()
+{
+    release();
+}
+
+IConnection* connection_lease::get() const
+{
+    return _connection.get();
+}
+
+IConnection* connection_lease::operator->() const
+{
+    return _connection.get();
+}
+
+IConnection& connection_lease::operator*() const
 {
+    return *_connection;
 }
 
-IConnectionPool::IConnectionPool(database_connection_settings settings, const size_t start_pool_size, const std::chrono::seconds wait_time)
-    : IConnectionPool(std::move(settings), start_pool_size, start_pool_size, wait_time)
+connection_lease::operator bool() const
 {
+    return _connection != nullptr;
+}
+
+void connection_lease::release()
+{
+    if(_connection == nullptr) {
+        return;
+    }
+
+    auto state = std::move(_state);
+    state->return_connection(std::move(_connection), _generation, _created_at);
+}
+
+IConnectionPool::IConnectionPool(connection_factory factory)
+    : _state(std::make_shared<connection_pool_state>())
+    , _factory(std::move(factory))
+{
+}
+
+IConnectionPool::IConnectionPool(connection_factory factory, database_connection_settings settings, const size_t start_pool_size, const size_t max_pool_size, const std::chrono::milliseconds wait_time)
+    : IConnectionPool(std::move(factory))
+{
+    _state->settings = std::move(settings);
+    _state->start_pool_size = start_pool_size;
+    _state->max_pool_size = max_pool_size;
+    _state->wait_time = wait_time;
+}
+
+IConnectionPool::IConnectionPool(connection_factory factory, database_connection_settings settings, const size_t start_pool_size, const std::chrono::milliseconds wait_time)
+    : IConnectionPool(std::move(factory), std::move(settings), start_pool_size, start_pool_size, wait_time)
+{
+}
+
+IConnectionPool::~IConnectionPool()
+{
+    stop_health_check();
+
+    std::deque<idle_connection> idle;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+        // Выданные соединения закроются при возврате, так как пул уже уничтожен
+        _state->closed = true;
+        _state->total -= _state->idle.size();
+        idle.swap(_state->idle);
+    }
 }
 
 void IConnectionPool::set_max_pool_size(const size_t max_pool_size)
 {
-    _max_pool_size = max_pool_size;
+    std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+    _state->max_pool_size = max_pool_size;
+    _state->notify_first_waiter();
 }
 
 void IConnectionPool::set_settings(const database_connection_settings& settings)
 {
-    _settings = settings;
+    std::deque<idle_connection> idle;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+        _state->settings = settings;
+        _state->generation++;
+        _state->total -= _state->idle.size();
+        idle.swap(_state->idle);
+    }
+
+    idle.clear();
 
     init_start_conncetions();
 }
 
-void IConnectionPool::set_wait_time(const std::chrono::seconds& wait_time)
+void IConnectionPool::set_wait_time(const std::chrono::milliseconds& wait_time)
 {
-    _wait_time = wait_time;
+    std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+    _state->wait_time = wait_time;
 }
 
-std::shared_ptr<IConnection> IConnectionPool::open_connection()
+void IConnectionPool::set_warm_up_min_ready(const size_t min_ready)
+{
+    std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+    _state->warm_up_min_ready = min_ready;
+}
+
+void IConnectionPool::set_health_settings(const pool_health_settings& settings)
+{
+    stop_health_check();
+
+    bool initialized = false;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+        _state->health_settings = settings;
+        initialized = _state->initialized;
+    }
+
+    if(initialized) {
+        start_health_check();
+    }
+}
+
+connection_lease IConnectionPool::acquire()
+{
+    std::chrono::milliseconds wait_time;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+        wait_time = _state->wait_time;
+    }
+
+    return acquire(wait_time);
+}
+
+connection_lease IConnectionPool::acquire(const std::chrono::milliseconds wait_time)
+{
+    const auto start = pool_clock::now();
+
+    auto lease = acquire_connection(wait_time);
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(pool_clock::now() - start);
+
+    std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+    _state->counters.wait_histogram.add(elapsed);
+    if(lease) {
+        _state->counters.checkouts++;
+    } else {
+        _state->counters.timeouts++;
+    }
+
+    return lease;
+}
+
+pool_metrics IConnectionPool::metrics() const
+{
+    std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+    auto metrics = _state->counters;
+    metrics.active = _state->leased;
+    metrics.idle = _state->idle.size();
+    metrics.total = _state->total;
+    metrics.waiting = _state->waiters.size();
+
+    return metrics;
+}
+
+void IConnectionPool::set_metrics_callback(metrics_callback callback, const std::chrono::milliseconds interval)
+{
+    stop_health_check();
+
+    bool initialized = false;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+        _state->metrics_callback = std::move(callback);
+        _state->metrics_interval = interval;
+        initialized = _state->initialized;
+    }
+
+    if(initialized) {
+        start_health_check();
+    }
+}
+
+connection_lease IConnectionPool::acquire_connection(const std::chrono::milliseconds wait_time)
 {
-    std::lock_guard<std::mutex> lock_guard(_lock);
+    const auto deadline = pool_clock::now() + wait_time;
+
+    // Разорванные соединения закрываются после снятия блокировки, поэтому список объявлен до lock_guard
+    std::vector<std::shared_ptr<IConnection>> dead;
+    idle_connection item;
+
+    std::unique_lock<std::mutex> lock_guard(_state->lock);
 
-    _connections.erase(std::remove_if(_connections.begin(), _connections.end(), [](const auto& connection) {
-        if(connection.use_count() != 1) {
-            return false;
+    if(!_state->initialized) {
+        lock_guard.unlock();
+        init_start_conncetions();
+        lock_guard.lock();
+    }
+
+    // Без очереди ожидающих соединение выдаётся сразу, иначе поток встаёт в конец очереди
+    if(_state->waiters.empty()) {
+        if(_state->take_idle(item, dead)) {
+            return connection_lease(_state, std::move(item.connection), _state->generation, item.created_at);
         }
 
-        if(!connection->is_valid()) {
-            return true;
+        if(_state->total < _state->max_pool_size) {
+            _state->total++;
+            const auto generation = _state->generation;
+            lock_guard.unlock();
+
+            return create_reserved_connection(generation);
         }
+    }
+
+    connection_waiter waiter;
+    _state->waiters.push_back(&waiter);
 
-        if(connection->is_transaction()) {
-            connection->rollback();
+    while(true) {
+        // Соединение передано при возврате в пул, поток уже удалён из очереди
+        if(waiter.connection != nullptr) {
+            return connection_lease(_state, std::move(waiter.connection), _state->generation, waiter.created_at);
         }
 
-        return false;
-    }),
-        _connections.end());
+        if(_state->waiters.front() == &waiter && (!_state->idle.empty() || _state->total < _state->max_pool_size)) {
+            _state->waiters.pop_front();
 
-    if(_connections.empty()) {
-        init_start_conncetions();
+            if(_state->take_idle(item, dead)) {
+                _state->notify_first_waiter();
+                return connection_lease(_state, std::move(item.connection), _state->generation, item.created_at);
+            }
+
+            if(_state->total < _state->max_pool_size) {
+                _state->total++;
+                const auto generation = _state->generation;
+                _state->notify_first_waiter();
+                lock_guard.unlock();
+
+                return create_reserved_connection(generation);
+            }
+
+            // Все свободные соединения оказались разорваны и места в пуле не осталось, поэтому поток снова встаёт в начало очереди
+            _state->waiters.push_front(&waiter);
+        }
+
+        if(waiter.condition.wait_until(lock_guard, deadline) == std::cv_status::timeout && waiter.connection == nullptr) {
+            const bool is_first = _state->waiters.front() == &waiter;
+            _state->waiters.erase(std::find(_state->waiters.begin(), _state->waiters.end(), &waiter));
+
+            if(is_first) {
+                _state->notify_first_waiter();
+            }
+
+            return {};
+        }
     }
+}
+
+std::shared_ptr<IConnection> IConnectionPool::open_connection()
+{
+    auto lease = std::make_shared<connection_lease>(acquire());
+    if(!*lease) {
+        return nullptr;
+    }
+
+    // Соединение возвращается в пул, когда уничтожается последняя копия указателя
+    return std::shared_ptr<IConnection>(lease->get(), [lease](IConnection*) { lease->release(); });
+}
+
+void IConnectionPool::init_start_conncetions()
+{
+    size_t count = 0;
+    size_t min_ready = 0;
+    size_t generation = 0;
+    std::vector<std::thread> finished_threads;
 
-    for(const auto& connection : _connections) {
-        if(connection.use_count() == 1) {
-            return connection;
+    {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+        _state->initialized = true;
+
+        const auto start_pool_size = std::min(_state->start_pool_size, _state->max_pool_size);
+        if(_state->total < start_pool_size) {
+            count = start_pool_size - _state->total;
         }
+        _state->total += count;
+        min_ready = std::min(_state->warm_up_min_ready, count);
+        generation = _state->generation;
+
+        // Потоки предыдущего прогрева к этому моменту, как правило, уже завершены
+        finished_threads.swap(_warm_up_threads);
     }
 
-    if(_connections.size() < _max_pool_size) {
-        auto conn = create_connection(_settings);
-        _connections.push_back(conn);
-        return conn;
+    for(auto& thread : finished_threads) {
+        thread.join();
     }
 
-    const auto start = std::chrono::system_clock::now();
+    start_health_check();
+
+    if(count == 0) {
+        return;
+    }
 
-    while(std::chrono::system_clock::now() - start <= _wait_time) {
-        for(auto& connection : _connections) {
-            if(connection.use_count() == 1) {
-                return connection;
+    /// Состояние прогрева, разделяемое с потоками создания соединений
+    struct warm_up_progress
+    {
+        std::mutex lock {};
+        std::condition_variable condition {};
+        size_t ready = 0;
+        size_t failed = 0;
+        std::exception_ptr error {};
+    };
+
+    auto progress = std::make_shared<warm_up_progress>();
+
+    // Соединения создаются параллельно, так как подключение к удалённой базе занимает большую часть времени прогрева
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for(size_t i = 0; i < count; i++) {
+        threads.emplace_back([this, progress, generation]() {
+            std::exception_ptr error;
+
+            try {
+                create_reserved_connection(generation).release();
+            } catch(...) {
+                error = std::current_exception();
             }
+
+            std::lock_guard<std::mutex> lock_guard(progress->lock);
+
+            if(error != nullptr) {
+                progress->failed++;
+                progress->error = error;
+            } else {
+                progress->ready++;
+            }
+
+            progress->condition.notify_all();
+        });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+        for(auto& thread : threads) {
+            _warm_up_threads.push_back(std::move(thread));
         }
+    }
+
+    std::unique_lock<std::mutex> lock_guard(progress->lock);
+    progress->condition.wait(lock_guard, [&progress, count, min_ready]() {
+        return progress->ready >= min_ready || progress->ready + progress->failed == count;
+    });
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if(progress->ready < min_ready) {
+        std::rethrow_exception(progress->error);
     }
+}
+
+connection_lease IConnectionPool::create_reserved_connection(const size_t generation)
+{
+    database_connection_settings settings;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+        settings = _state->settings;
+    }
+
+    std::shared_ptr<IConnection> connection;
+
+    try {
+        connection = _factory(settings);
+    } catch(...) {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+        _state->counters.creation_failures++;
+        _state->total--;
+        _state->notify_first_waiter();
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock_guard(_state->lock);
 
-    return nullptr;
+    _state->counters.creations++;
+    _state->leased++;
+
+    return connection_lease(_state, std::move(connection), generation, pool_clock::now());
 }
 
-void IConnectionPool::init_start_conncetions()
+void IConnectionPool::start_health_check()
+{
+    std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+    const bool need_validation = _state->health_settings.validation_interval.count() > 0;
+    const bool need_metrics = _state->metrics_callback != nullptr && _state->metrics_interval.count() > 0;
+
+    if(_health_check_thread.joinable() || _state->closed || (!need_validation && !need_metrics)) {
+        return;
+    }
+
+    _state->stop_health_check = false;
+    _health_check_thread = std::thread(&IConnectionPool::health_check_loop, this);
+}
+
+void IConnectionPool::stop_health_check()
 {
-    _connections.clear();
+    std::thread thread;
+    std::vector<std::thread> warm_up_threads;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(_state->lock);
+
+        _state->stop_health_check = true;
+        _state->health_check_condition.notify_all();
+        thread.swap(_health_check_thread);
+        warm_up_threads.swap(_warm_up_threads);
+    }
+
+    if(thread.joinable()) {
+        thread.join();
+    }
+
+    for(auto& warm_up_thread : warm_up_threads) {
+        warm_up_thread.join();
+    }
+}
+
+void IConnectionPool::health_check_loop()
+{
+    std::unique_lock<std::mutex> lock_guard(_state->lock);
+
+    const auto validation_interval = _state->health_settings.validation_interval;
+    const auto metrics_interval = _state->metrics_callback != nullptr ? _state->metrics_interval : std::chrono::milliseconds(0);
+
+    // Отключённая задача планируется на максимально удалённое время
+    const auto schedule = [](const std::chrono::milliseconds interval) {
+        return interval.count() > 0 ? pool_clock::now() + interval : pool_clock::time_point::max();
+    };
+
+    auto next_validation = schedule(validation_interval);
+    auto next_metrics = schedule(metrics_interval);
+
+    while(true) {
+        if(_state->health_check_condition.wait_until(lock_guard, std::min(next_validation, next_metrics), [this]() { return _state->stop_health_check; })) {
+            return;
+        }
+
+        const auto now = pool_clock::now();
+
+        if(now >= next_metrics) {
+            auto callback = _state->metrics_callback;
+            lock_guard.unlock();
+
+            // Ошибка в пользовательской функции не должна останавливать фоновый поток
+            try {
+                callback(metrics());
+            } catch(...) {
+            }
 
-    _connections.reserve(_start_pool_size);
-    for(auto i = 0; i < _start_pool_size; i++) {
-        _connections.push_back(create_connection(_settings));
+            lock_guard.lock();
+            next_metrics = schedule(metrics_interval);
+        }
+
+        if(now >= next_validation && !_state->stop_health_check) {
+            validate_connections(lock_guard);
+            next_validation = schedule(validation_interval);
+        }
     }
 }
-} // namespace database_adapter
\ No newline at end of file
+
+void IConnectionPool::validate_connections(std::unique_lock<std::mutex>& lock_guard)
+{
+    const auto now = pool_clock::now();
+    const auto& settings = _state->health_settings;
+
+    // Разорванные, устаревшие и простаивающие соединения закрываются без обращения к серверу
+    std::vector<std::shared_ptr<IConnection>> dead;
+    std::deque<idle_connection> kept;
+
+    auto remaining = _state->idle.size();
+    for(auto& item : _state->idle) {
+        const bool is_idle_expired = settings.idle_timeout.count() > 0 && now - item.idle_since >= settings.idle_timeout && remaining > settings.min_idle;
+
+        const bool is_alive = item.connection->is_alive();
+        if(!is_alive || _state->is_expired(item.created_at, now) || is_idle_expired) {
+            if(is_alive) {
+                _state->counters.evictions++;
+            } else {
+                _state->counters.validation_failures++;
+            }
+
+            _state->total--;
+            dead.push_back(std::move(item.connection));
+            remaining--;
+            continue;
+        }
+
+        kept.push_back(std::move(item));
+    }
+    _state->idle.swap(kept);
+
+    // Освободившиеся места могут использовать ожидающие потоки
+    if(!dead.empty()) {
+        _state->notify_first_waiter();
+
+        lock_guard.unlock();
+        dead.clear();
+        lock_guard.lock();
+    }
+
+    // Запросом к серверу проверяется по одному соединению, не использовавшемуся дольше validation_interval.
+    // Остальные свободные соединения остаются доступными, а проверенное возвращается в пул сразу после проверки
+    const auto is_stale = [&settings, now](const idle_connection& item) {
+        return now - std::max(item.idle_since, item.validated_at) >= settings.validation_interval;
+    };
+
+    while(!_state->closed && !_state->stop_health_check) {
+        const auto it = std::find_if(_state->idle.begin(), _state->idle.end(), is_stale);
+        if(it == _state->idle.end()) {
+            break;
+        }
+
+        auto item = std::move(*it);
+        _state->idle.erase(it);
+        const auto generation = _state->generation;
+
+        lock_guard.unlock();
+
+        const bool valid = item.connection->is_valid();
+
+        lock_guard.lock();
+
+        item.validated_at = pool_clock::now();
+
+        if(!valid || _state->closed || generation != _state->generation) {
+            if(!valid) {
+                _state->counters.validation_failures++;
+            }
+
+            _state->discard(std::move(item.connection), dead);
+
+            lock_guard.unlock();
+            dead.clear();
+            lock_guard.lock();
+            continue;
+        }
+
+        if(!_state->waiters.empty()) {
+            _state->put_idle(std::move(item));
+            continue;
+        }
+
+        // Соединение возвращается на своё место, чтобы сохранить порядок простоя
+        const auto position = std::find_if(_state->idle.begin(), _state->idle.end(), [&item](const idle_connection& other) {
+            return other.idle_since > item.idle_since;
+        });
+        _state->idle.insert(position, std::move(item));
+    }
+
+    if(_state->stop_health_check) {
+        return;
+    }
+
+    // Пополнение свободных соединений до min_idle
+    size_t count = 0;
+    if(_state->idle.size() < settings.min_idle && _state->total < _state->max_pool_size) {
+        count = std::min(settings.min_idle - _state->idle.size(), _state->max_pool_size - _state->total);
+    }
+    _state->total += count;
+    const auto generation = _state->generation;
+
+    lock_guard.unlock();
+
+    for(size_t i = 0; i < count; i++) {
+        try {
+            create_reserved_connection(generation).release();
+        } catch(...) {
+            // Ошибка подключения не прерывает проверку, недостающие соединения будут созданы на следующей итерации
+            std::lock_guard<std::mutex> guard(_state->lock);
+
+            _state->total -= count - i - 1;
+            _state->notify_first_waiter();
+            break;
+        }
+    }
+
+    lock_guard.lock();
+}
+
+} // namespace database_adapter
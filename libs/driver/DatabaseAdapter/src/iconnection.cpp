@@ -2,6 +2,11 @@
 
 #include "DatabaseAdapter/exception/sqlexception.h"
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+
 namespace database_adapter {
 
 IConnection::IConnection(const database_connection_settings& /*settings*/)
@@ -18,6 +23,167 @@ bool IConnection::is_valid()
     }
 }
 
+bool IConnection::is_alive() const
+{
+    return true;
+}
+
+void IConnection::exec_stream(const std::string& query, const row_callback& callback)
+{
+    exec_stream(query, {}, callback);
+}
+
+void IConnection::exec_stream(const std::string& query, const std::vector<std::string>& params, const row_callback& callback)
+{
+    const auto result = params.empty() ? exec(query) : exec_prepared(query, params);
+    for(const auto& row : result) {
+        callback(row);
+    }
+}
+
+void IConnection::export_stream(const std::string& query, const row_callback& callback)
+{
+    exec_stream(query, {}, callback);
+}
+
+query_result IConnection::exec_prepared(const std::string& query, const std::vector<std::string>& params)
+{
+    flush_deferred();
+
+    const auto name = "query_" + std::to_string(std::hash<std::string>()(query));
+
+    prepare(query, name);
+    return exec_prepared(params, name);
+}
+
+query_result IConnection::exec_typed(const std::string& query, const bind_parameters& params)
+{
+    std::vector<std::string> string_params;
+    string_params.reserve(params.size());
+
+    for(const auto& param : params) {
+        string_params.emplace_back(param.to_string());
+    }
+
+    return exec_prepared(query, string_params);
+}
+
+std::vector<query_result> IConnection::exec_batch(const std::vector<batch_statement>& statements)
+{
+    std::vector<query_result> results;
+    results.reserve(statements.size());
+
+    for(const auto& statement : statements) {
+        results.emplace_back(exec_prepared(statement.query, statement.params));
+    }
+
+    return results;
+}
+
+void IConnection::exec_deferred(std::string query, std::vector<std::string> params)
+{
+    _deferred.push_back({ std::move(query), std::move(params) });
+}
+
+void IConnection::flush_deferred()
+{
+    if(_deferred.empty()) {
+        return;
+    }
+
+    // Очередь освобождается до выполнения, так как exec_batch сам вызывает flush_deferred через exec_prepared
+    std::vector<batch_statement> statements;
+    statements.swap(_deferred);
+
+    exec_batch(statements);
+}
+
+query_result IConnection::bulk_insert(const std::string& table, const std::vector<std::string>& columns, const row_source& next_row, const std::vector<std::string>& returning)
+{
+    if(columns.empty()) {
+        throw std::invalid_argument("bulk insert without columns");
+    }
+
+    const auto rows_per_statement = std::max<size_t>(1, max_bind_parameters() / columns.size());
+    const bool numbered = numbered_placeholders();
+
+    std::string header = "INSERT INTO " + table + " (";
+    for(size_t i = 0; i < columns.size(); i++) {
+        header.append(i == 0 ? "\"" : ", \"").append(columns[i]).append("\"");
+    }
+    header.append(") VALUES ");
+
+    std::string footer;
+    for(size_t i = 0; i < returning.size(); i++) {
+        footer.append(i == 0 ? " RETURNING \"" : ", \"").append(returning[i]).append("\"");
+    }
+
+    query_result result;
+    std::vector<std::string> row;
+    std::vector<std::string> params;
+    params.reserve(rows_per_statement * columns.size());
+
+    bool has_rows = true;
+    while(has_rows) {
+        params.clear();
+
+        std::string sql = header;
+        size_t rows = 0;
+        while(rows < rows_per_statement) {
+            row.clear();
+            if(!next_row(row)) {
+                has_rows = false;
+                break;
+            }
+
+            if(row.size() != columns.size()) {
+                throw std::invalid_argument("bulk insert row size doesn't match columns");
+            }
+
+            sql.append(rows == 0 ? "(" : ", (");
+            for(size_t i = 0; i < row.size(); i++) {
+                if(i != 0) {
+                    sql.append(", ");
+                }
+                sql.append(numbered ? "$" + std::to_string(params.size() + i + 1) : "?");
+            }
+            sql.append(")");
+
+            std::move(row.begin(), row.end(), std::back_inserter(params));
+            rows++;
+        }
+
+        if(rows == 0) {
+            break;
+        }
+
+        sql.append(footer);
+
+        auto rows_result = exec_prepared(sql, params);
+        if(!returning.empty()) {
+            result.append(rows_result);
+        }
+    }
+
+    return result;
+}
+
+bool IConnection::numbered_placeholders() const
+{
+    return false;
+}
+
+size_t IConnection::max_bind_parameters() const
+{
+    // Минимальное ограничение среди поддерживаемых баз данных (SQLITE_MAX_VARIABLE_NUMBER до версии 3.32)
+    return 999;
+}
+
+statement_cache_stats IConnection::cache_stats() const
+{
+    return {};
+}
+
 bool IConnection::is_transaction() const
 {
     return _has_transaction;
@@ -44,6 +210,9 @@ void IConnection::add_save_point(const std::string& save_point)
 
 void IConnection::rollback_to_save_point(const std::string& save_point)
 {
+    // Запросы из очереди поставлены после последней точки сохранения, поэтому откатываются без выполнения
+    clear_deferred();
+
     exec(save_point.empty() ? "ROLLBACK;" : "ROLLBACK TO " + save_point);
 
     if(save_point.empty()) {
@@ -56,4 +225,9 @@ void IConnection::rollback()
     rollback_to_save_point("");
 }
 
+void IConnection::clear_deferred()
+{
+    _deferred.clear();
+}
+
 } // namespace database_adapter
\ No newline at end of file
@@ -0,0 +1,355 @@
+#include "DatabaseAdapter/instrumentedconnection.h"
+
+#include "DatabaseAdapter/model/databasesettings.h"
+#include "DatabaseAdapter/querysource.h"
+#include "DatabaseAdapter/statementcache.h"
+
+#include <stdexcept>
+
+namespace database_adapter {
+
+namespace {
+
+using metrics_clock = std::chrono::steady_clock;
+
+/// Размер значений параметров в байтах
+size_t params_size(const std::vector<std::string>& params)
+{
+    size_t size = 0;
+    for(const auto& param : params) {
+        size += param.size();
+    }
+
+    return size;
+}
+
+/// Размер типизированных значений параметров в байтах, числа учитываются по размеру их представления
+size_t params_size(const bind_parameters& params)
+{
+    size_t size = 0;
+    for(const auto& param : params) {
+        switch(param.type()) {
+            case bind_parameter::value_type::integer:
+                size += sizeof(int64_t);
+                break;
+            case bind_parameter::value_type::real:
+                size += sizeof(double);
+                break;
+            default:
+                size += param.size();
+                break;
+        }
+    }
+
+    return size;
+}
+
+/// Размер значений строки в байтах
+size_t row_size(const query_result::row_view& row)
+{
+    size_t size = 0;
+    for(size_t i = 0; i < row.size(); i++) {
+        size += row.at(i).size();
+    }
+
+    return size;
+}
+
+} // namespace
+
+instrumented_connection::instrumented_connection(std::shared_ptr<IConnection> connection, std::shared_ptr<IMetricsSink> sink, fingerprint_function fingerprint)
+    : IConnection(database_connection_settings {})
+    , _connection(std::move(connection))
+    , _sink(std::move(sink))
+    , _fingerprint(fingerprint != nullptr ? std::move(fingerprint) : &instrumented_connection::default_fingerprint)
+{
+    if(_connection == nullptr || _sink == nullptr) {
+        throw std::invalid_argument("Connection and metrics sink must not be null");
+    }
+
+    _has_transaction = _connection->is_transaction();
+}
+
+std::shared_ptr<IConnection> instrumented_connection::connection() const
+{
+    return _connection;
+}
+
+bool instrumented_connection::is_valid()
+{
+    return _connection->is_valid();
+}
+
+bool instrumented_connection::is_alive() const
+{
+    return _connection->is_alive();
+}
+
+query_result instrumented_connection::exec(const std::string& query)
+{
+    flush_deferred();
+    return measure(make_metrics("exec", query, query.size()), [&]() { return _connection->exec(query); });
+}
+
+void instrumented_connection::exec_stream(const std::string& query, const std::vector<std::string>& params, const row_callback& callback)
+{
+    flush_deferred();
+    measure_stream(make_metrics("exec_stream", query, query.size() + params_size(params)), callback, [&](const row_callback& measured) {
+        _connection->exec_stream(query, params, measured);
+    });
+}
+
+void instrumented_connection::export_stream(const std::string& query, const row_callback& callback)
+{
+    flush_deferred();
+    measure_stream(make_metrics("export_stream", query, query.size()), callback, [&](const row_callback& measured) {
+        _connection->export_stream(query, measured);
+    });
+}
+
+void instrumented_connection::prepare(const std::string& query, const std::string& name)
+{
+    flush_deferred();
+
+    auto metrics = make_metrics("prepare", query, query.size());
+    const auto start = metrics_clock::now();
+
+    try {
+        _connection->prepare(query, name);
+    } catch(...) {
+        metrics.prepare_time = metrics_clock::now() - start;
+        metrics.failed = true;
+        publish(metrics);
+        throw;
+    }
+
+    metrics.prepare_time = metrics_clock::now() - start;
+    publish(metrics);
+
+    _prepared[name] = query;
+}
+
+query_result instrumented_connection::exec_prepared(const std::vector<std::string>& params, const std::string& name)
+{
+    flush_deferred();
+
+    const auto prepared_it = _prepared.find(name);
+    const auto& query = prepared_it != _prepared.end() ? prepared_it->second : name;
+
+    return measure(make_metrics("exec_prepared", query, params_size(params)), [&]() { return _connection->exec_prepared(params, name); });
+}
+
+query_result instrumented_connection::exec_prepared(const std::string& query, const std::vector<std::string>& params)
+{
+    flush_deferred();
+    return measure(make_metrics("exec_prepared", query, query.size() + params_size(params)), [&]() { return _connection->exec_prepared(query, params); });
+}
+
+query_result instrumented_connection::exec_typed(const std::string& query, const bind_parameters& params)
+{
+    flush_deferred();
+    return measure(make_metrics("exec_typed", query, query.size() + params_size(params)), [&]() { return _connection->exec_typed(query, params); });
+}
+
+std::vector<query_result> instrumented_connection::exec_batch(const std::vector<batch_statement>& statements)
+{
+    flush_deferred();
+
+    if(statements.empty()) {
+        return {};
+    }
+
+    size_t bytes_sent = 0;
+    for(const auto& statement : statements) {
+        bytes_sent += statement.query.size() + params_size(statement.params);
+    }
+
+    auto metrics = make_metrics("exec_batch", statements.front().query, bytes_sent);
+    metrics.statements = statements.size();
+
+    std::vector<query_result> results;
+    const auto start = metrics_clock::now();
+
+    try {
+        results = _connection->exec_batch(statements);
+    } catch(...) {
+        metrics.execute_time = metrics_clock::now() - start;
+        metrics.failed = true;
+        publish(metrics);
+        throw;
+    }
+
+    metrics.execute_time = metrics_clock::now() - start;
+    for(const auto& result : results) {
+        metrics.rows += result.size();
+        metrics.bytes_received += result.data_size();
+    }
+    publish(metrics);
+
+    return results;
+}
+
+query_result instrumented_connection::bulk_insert(const std::string& table, const std::vector<std::string>& columns, const row_source& next_row, const std::vector<std::string>& returning)
+{
+    flush_deferred();
+
+    // Строки считаются по мере их передачи драйверу, так как заранее их количество неизвестно
+    auto metrics = make_metrics("bulk_insert", "INSERT INTO " + table, 0);
+    metrics.statements = 0;
+
+    const row_source counted_row = [&metrics, &next_row](std::vector<std::string>& row) {
+        if(!next_row(row)) {
+            return false;
+        }
+
+        metrics.statements++;
+        metrics.bytes_sent += params_size(row);
+        return true;
+    };
+
+    return measure(std::move(metrics), [&]() { return _connection->bulk_insert(table, columns, counted_row, returning); });
+}
+
+bool instrumented_connection::numbered_placeholders() const
+{
+    return _connection->numbered_placeholders();
+}
+
+size_t instrumented_connection::max_bind_parameters() const
+{
+    return _connection->max_bind_parameters();
+}
+
+statement_cache_stats instrumented_connection::cache_stats() const
+{
+    return _connection->cache_stats();
+}
+
+bool instrumented_connection::open_transaction(const int type)
+{
+    flush_deferred();
+
+    _has_transaction = _connection->open_transaction(type) && _connection->is_transaction();
+    return _has_transaction;
+}
+
+void instrumented_connection::commit()
+{
+    flush_deferred();
+
+    measure(make_metrics("commit", "COMMIT", 0), [this]() {
+        _connection->commit();
+        return query_result();
+    });
+
+    _has_transaction = _connection->is_transaction();
+}
+
+void instrumented_connection::rollback_to_save_point(const std::string& save_point)
+{
+    // Запросы из очереди поставлены после последней точки сохранения, поэтому откатываются без выполнения
+    clear_deferred();
+
+    measure(make_metrics("rollback", save_point.empty() ? "ROLLBACK" : "ROLLBACK TO " + save_point, 0), [this, &save_point]() {
+        _connection->rollback_to_save_point(save_point);
+        return query_result();
+    });
+
+    _has_transaction = _connection->is_transaction();
+}
+
+uint64_t instrumented_connection::default_fingerprint(const std::string& query)
+{
+    return static_cast<uint64_t>(std::hash<std::string>()(normalize_sql(query)));
+}
+
+query_result instrumented_connection::measure(query_metrics metrics, const std::function<query_result()>& action)
+{
+    query_result result;
+    const auto start = metrics_clock::now();
+
+    try {
+        result = action();
+    } catch(...) {
+        metrics.execute_time = metrics_clock::now() - start;
+        metrics.failed = true;
+        publish(metrics);
+        throw;
+    }
+
+    metrics.execute_time = metrics_clock::now() - start;
+    metrics.rows = result.size();
+    metrics.bytes_received = result.data_size();
+    publish(metrics);
+
+    return result;
+}
+
+void instrumented_connection::measure_stream(query_metrics metrics, const row_callback& callback, const std::function<void(const row_callback&)>& action)
+{
+    const auto start = metrics_clock::now();
+    auto first_row = start;
+    metrics_clock::duration in_callback { 0 };
+
+    const row_callback measured = [&](const query_result::row_view& row) {
+        const auto received = metrics_clock::now();
+        if(metrics.rows == 0) {
+            first_row = received;
+        }
+
+        metrics.rows++;
+        metrics.bytes_received += row_size(row);
+
+        // Время обработки строки пользователем не относится к получению строк
+        callback(row);
+        in_callback += metrics_clock::now() - received;
+    };
+
+    const auto finish = [&]() {
+        const auto end = metrics_clock::now();
+        if(metrics.rows == 0) {
+            metrics.execute_time = end - start;
+        } else {
+            metrics.execute_time = first_row - start;
+            metrics.fetch_time = end - first_row - in_callback;
+        }
+    };
+
+    try {
+        action(measured);
+    } catch(...) {
+        finish();
+        metrics.failed = true;
+        publish(metrics);
+        throw;
+    }
+
+    finish();
+    publish(metrics);
+}
+
+query_metrics instrumented_connection::make_metrics(const char* call, const std::string& query, const size_t bytes_sent) const
+{
+    query_metrics metrics;
+    metrics.call = call;
+
+    const auto* source = query_source::current();
+    metrics.source = source != nullptr ? source : "";
+
+    metrics.query = query;
+    metrics.fingerprint = _fingerprint(query);
+    metrics.bytes_sent = bytes_sent;
+
+    return metrics;
+}
+
+void instrumented_connection::publish(const query_metrics& metrics)
+{
+    try {
+        _sink->record(metrics);
+    } catch(...) {
+        // Ошибка получателя измерений не должна влиять на выполнение запроса
+    }
+}
+
+} // namespace database_adapter
@@ -0,0 +1,165 @@
+#include "DatabaseAdapter/model/bindparameter.h"
+
+#include "DatabaseAdapter/model/queryresult.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace database_adapter {
+
+constexpr size_t bind_parameter::max_number_length;
+
+bind_parameter::bind_parameter(std::nullptr_t)
+{
+}
+
+bind_parameter::bind_parameter(const std::string& value)
+{
+    if(value == NULL_VALUE) {
+        return;
+    }
+
+    _type = value_type::text;
+    _data = value.c_str();
+    _size = value.size();
+    _null_terminated = true;
+}
+
+bind_parameter::bind_parameter(const char* value)
+{
+    if(value == nullptr) {
+        return;
+    }
+
+    _type = value_type::text;
+    _data = value;
+    _size = std::strlen(value);
+    _null_terminated = true;
+}
+
+bind_parameter::bind_parameter(const text_view value)
+    : _type(value_type::text)
+    // Пустое представление может не указывать на данные, но это пустая строка, а не NULL
+    , _data(value.data() != nullptr ? value.data() : "")
+    , _size(value.size())
+{
+}
+
+bind_parameter bind_parameter::blob(const void* data, const size_t size)
+{
+    bind_parameter parameter;
+    if(data == nullptr) {
+        return parameter;
+    }
+
+    parameter._type = value_type::blob;
+    parameter._data = static_cast<const char*>(data);
+    parameter._size = size;
+
+    return parameter;
+}
+
+bind_parameter::value_type bind_parameter::type() const
+{
+    return _type;
+}
+
+bool bind_parameter::is_null() const
+{
+    return _type == value_type::null;
+}
+
+int64_t bind_parameter::as_int64() const
+{
+    return _type == value_type::integer ? _integer : 0;
+}
+
+double bind_parameter::as_double() const
+{
+    return _type == value_type::real ? _real : 0;
+}
+
+const char* bind_parameter::data() const
+{
+    return _data;
+}
+
+size_t bind_parameter::size() const
+{
+    return _size;
+}
+
+bool bind_parameter::is_null_terminated() const
+{
+    return _null_terminated;
+}
+
+size_t bind_parameter::format_number(char* buffer) const
+{
+    int size = 0;
+    switch(_type) {
+        case value_type::integer:
+            size = std::snprintf(buffer, max_number_length, "%lld", static_cast<long long>(_integer));
+            break;
+        case value_type::real:
+            // Особые значения записываются так, как их понимают базы данных, а не как их выводит printf
+            if(std::isnan(_real)) {
+                size = std::snprintf(buffer, max_number_length, "NaN");
+            } else if(std::isinf(_real)) {
+                size = std::snprintf(buffer, max_number_length, _real < 0 ? "-Infinity" : "Infinity");
+            } else {
+                // 17 значащих цифр достаточно, чтобы число читалось обратно без потерь
+                size = std::snprintf(buffer, max_number_length, "%.17g", _real);
+            }
+            break;
+        default:
+            buffer[0] = '\0';
+            break;
+    }
+
+    return static_cast<size_t>(size);
+}
+
+std::string bind_parameter::to_string() const
+{
+    switch(_type) {
+        case value_type::null:
+            return NULL_VALUE;
+        case value_type::integer:
+        case value_type::real: {
+            char buffer[max_number_length];
+            return std::string(buffer, format_number(buffer));
+        }
+        default:
+            return std::string(_data, _size);
+    }
+}
+
+std::string params_to_string(const std::vector<std::string>& params)
+{
+    std::string result = "[ ";
+    for(const auto& param : params) {
+        result.append(param).append(" ");
+    }
+    result.append("]");
+
+    return result;
+}
+
+std::string params_to_string(const bind_parameters& params)
+{
+    std::string result = "[ ";
+    for(const auto& param : params) {
+        if(param.type() == bind_parameter::value_type::blob) {
+            result.append("<blob ").append(std::to_string(param.size())).append(" bytes> ");
+            continue;
+        }
+        result.append(param.to_string()).append(" ");
+    }
+    result.append("]");
+
+    return result;
+}
+
+} // namespace database_adapter
@@ -0,0 +1,42 @@
+#include "DatabaseAdapter/model/poolmetrics.h"
+
+#include <numeric>
+
+namespace database_adapter {
+
+constexpr size_t pool_wait_histogram::bucket_count;
+
+std::chrono::microseconds pool_wait_histogram::upper_bound(const size_t bucket)
+{
+    static const std::array<std::chrono::microseconds, bucket_count> bounds {
+        std::chrono::microseconds(100),
+        std::chrono::milliseconds(1),
+        std::chrono::milliseconds(5),
+        std::chrono::milliseconds(10),
+        std::chrono::milliseconds(50),
+        std::chrono::milliseconds(100),
+        std::chrono::milliseconds(500),
+        std::chrono::seconds(1),
+        std::chrono::seconds(5),
+        std::chrono::microseconds::max()
+    };
+
+    return bounds.at(bucket);
+}
+
+void pool_wait_histogram::add(const std::chrono::microseconds wait_time)
+{
+    size_t bucket = 0;
+    while(bucket + 1 < bucket_count && wait_time > upper_bound(bucket)) {
+        bucket++;
+    }
+
+    buckets[bucket]++;
+}
+
+size_t pool_wait_histogram::count() const
+{
+    return std::accumulate(buckets.begin(), buckets.end(), size_t(0));
+}
+
+} // namespace database_adapter
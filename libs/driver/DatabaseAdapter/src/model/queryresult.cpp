@@ -1,30 +1,471 @@
 #include "DatabaseAdapter/model/queryresult.h"
 
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
 namespace database_adapter {
 
-query_result::query_result(const std::list<row>& result)
+constexpr size_t query_result::npos;
+
+query_result::row_view::row_view(const query_result* result, const size_t row_index)
+    : _result(result)
+    , _row_index(row_index)
+{
+}
+
+size_t query_result::row_view::size() const
+{
+    return _result->column_info().names.size();
+}
+
+size_t query_result::row_view::index() const
+{
+    return _row_index;
+}
+
+bool query_result::row_view::contains(const column_name& column) const
+{
+    return _result->column_index(column) != npos;
+}
+
+size_t query_result::row_view::column_index(const column_name& column) const
+{
+    return _result->column_index(column);
+}
+
+text_view query_result::row_view::at(const size_t column_index) const
+{
+    const auto& cell = _result->cell_at(_row_index, column_index);
+    return { _result->_buffer.data() + cell.offset, cell.size };
+}
+
+text_view query_result::row_view::at(const column_name& column) const
+{
+    const auto column_index = _result->column_index(column);
+    if(column_index == npos) {
+        throw std::out_of_range("Column " + column + " doesn't exist in query result");
+    }
+
+    return at(column_index);
+}
+
+bool query_result::row_view::is_null(const size_t column_index) const
+{
+    return _result->cell_at(_row_index, column_index).type == cell_type::null;
+}
+
+bool query_result::row_view::is_null(const column_name& column) const
+{
+    const auto column_index = _result->column_index(column);
+    if(column_index == npos) {
+        throw std::out_of_range("Column " + column + " doesn't exist in query result");
+    }
+
+    return is_null(column_index);
+}
+
+query_result::cell_type query_result::row_view::type(const size_t column_index) const
+{
+    return _result->cell_at(_row_index, column_index).type;
+}
+
+int64_t query_result::row_view::as_int64(const size_t column_index) const
+{
+    const auto& cell = _result->cell_at(_row_index, column_index);
+    switch(cell.type) {
+        case cell_type::null:
+            return 0;
+        case cell_type::integer:
+            return cell.integer;
+        case cell_type::real:
+            return static_cast<int64_t>(cell.real);
+        default:
+            break;
+    }
+
+    // Значение в буфере всегда завершается нулевым символом, поэтому его можно разбирать напрямую
+    const char* begin = _result->_buffer.data() + cell.offset;
+    char* end = nullptr;
+    errno = 0;
+    const auto value = std::strtoll(begin, &end, 10);
+    if(end == begin || end != begin + cell.size || errno == ERANGE) {
+        throw std::invalid_argument("Value '" + std::string(begin, cell.size) + "' is not an integer");
+    }
+
+    return value;
+}
+
+double query_result::row_view::as_double(const size_t column_index) const
+{
+    const auto& cell = _result->cell_at(_row_index, column_index);
+    switch(cell.type) {
+        case cell_type::null:
+            return 0;
+        case cell_type::integer:
+            return static_cast<double>(cell.integer);
+        case cell_type::real:
+            return cell.real;
+        default:
+            break;
+    }
+
+    const char* begin = _result->_buffer.data() + cell.offset;
+    char* end = nullptr;
+    const auto value = std::strtod(begin, &end);
+    if(end == begin || end != begin + cell.size) {
+        throw std::invalid_argument("Value '" + std::string(begin, cell.size) + "' is not a number");
+    }
+
+    return value;
+}
+
+text_view query_result::row_view::as_text(const size_t column_index) const
+{
+    return at(column_index);
+}
+
+query_result::blob_view query_result::row_view::as_blob(const size_t column_index) const
+{
+    return at(column_index);
+}
+
+query_result::row query_result::row_view::to_row() const
+{
+    row result;
+    for(size_t i = 0; i < size(); i++) {
+        result.emplace(_result->column_info().names[i], at(i).str());
+    }
+
+    return result;
+}
+
+query_result::const_iterator::const_iterator(const query_result* result, const size_t row_index)
     : _result(result)
+    , _row_index(row_index)
+{
+}
+
+query_result::row_view query_result::const_iterator::operator*() const
+{
+    return { _result, _row_index };
+}
+
+query_result::const_iterator& query_result::const_iterator::operator++()
+{
+    ++_row_index;
+    return *this;
+}
+
+query_result::const_iterator query_result::const_iterator::operator++(int)
+{
+    auto temp = *this;
+    ++_row_index;
+    return temp;
+}
+
+bool query_result::const_iterator::operator==(const const_iterator& rhs) const
+{
+    return _result == rhs._result && _row_index == rhs._row_index;
+}
+
+bool query_result::const_iterator::operator!=(const const_iterator& rhs) const
+{
+    return !(*this == rhs);
+}
+
+query_result::query_result(std::vector<column_name> columns)
+{
+    set_columns(std::move(columns));
+}
+
+query_result::query_result(const std::initializer_list<column_name> columns)
+    : query_result(std::vector<column_name>(columns))
+{
+}
+
+query_result::query_result(const std::list<row>& result)
+{
+    for(const auto& value : result) {
+        add(value);
+    }
+}
+
+void query_result::set_columns(std::vector<column_name> columns)
+{
+    set_columns(make_columns(std::move(columns)));
+}
+
+void query_result::set_columns(shared_columns columns)
+{
+    _columns = columns != nullptr ? std::move(columns) : empty_columns();
+    _cells.clear();
+    _buffer.clear();
+}
+
+query_result::shared_columns query_result::make_columns(std::vector<column_name> columns)
+{
+    auto column_set = std::make_shared<query_result::column_set>();
+    column_set->names = std::move(columns);
+
+    column_set->indexes.reserve(column_set->names.size());
+    for(size_t i = 0; i < column_set->names.size(); i++) {
+        // При дублировании имён колонок используется первая из них
+        column_set->indexes.emplace(column_set->names[i], i);
+    }
+
+    return column_set;
+}
+
+const query_result::shared_columns& query_result::empty_columns()
+{
+    static const shared_columns columns = std::make_shared<const column_set>();
+    return columns;
+}
+
+const query_result::column_set& query_result::column_info() const
+{
+    // После перемещения результата указатель пуст, но объект должен оставаться пригодным для использования
+    return _columns != nullptr ? *_columns : *empty_columns();
+}
+
+void query_result::reserve(const size_t rows, const size_t bytes)
+{
+    _cells.reserve(rows * column_info().names.size());
+    // Дополнительно резервируется место под нулевой символ после каждого значения
+    _buffer.reserve(bytes + rows * column_info().names.size());
+}
+
+void query_result::clear()
+{
+    _cells.clear();
+    _buffer.clear();
+}
+
+void query_result::add_value(const char* data, const size_t size)
+{
+    if(data == nullptr) {
+        add_null();
+        return;
+    }
+
+    append_cell(data, size, cell_type::text);
+}
+
+void query_result::add_null()
 {
+    append_cell(nullptr, 0, cell_type::null);
 }
 
 void query_result::add(const row& value)
 {
-    _result.emplace_back(value);
+    if(column_info().names.empty()) {
+        std::vector<column_name> columns;
+        columns.reserve(value.size());
+        for(const auto& item : value) {
+            columns.emplace_back(item.first);
+        }
+        set_columns(std::move(columns));
+    }
+
+    const auto& names = column_info().names;
+    if(value.size() != names.size()) {
+        throw std::invalid_argument("Row has different columns");
+    }
+
+    // Ячейки добавляются только после проверки всех колонок, чтобы не оставить в результате неполную строку
+    std::vector<const std::string*> values;
+    values.reserve(names.size());
+    for(const auto& name : names) {
+        const auto it = value.find(name);
+        if(it == value.end()) {
+            throw std::invalid_argument("Row has no column " + name);
+        }
+        values.emplace_back(&it->second);
+    }
+
+    for(const auto* cell_value : values) {
+        add_value(cell_value->data(), cell_value->size());
+    }
 }
 
-std::list<query_result::row> query_result::data() const
+void query_result::append(const query_result& other)
+{
+    if(column_info().names.empty()) {
+        set_columns(other._columns);
+    }
+
+    if(column_info().names.size() != other.column_info().names.size()) {
+        throw std::invalid_argument("Results have different columns");
+    }
+
+    // Ячейки ссылаются на значения по смещению, поэтому буфер копируется целиком со сдвигом смещений
+    const auto offset = _buffer.size();
+    _buffer.append(other._buffer);
+
+    _cells.reserve(_cells.size() + other._cells.size());
+    for(auto value : other._cells) {
+        value.offset += offset;
+        _cells.push_back(value);
+    }
+}
+
+void query_result::add_int64(const int64_t value)
+{
+    // Формирование числа с конца буфера, без обращения к локали и выделения памяти
+    char text[24];
+    char* end = text + sizeof(text);
+    char* begin = end;
+
+    uint64_t absolute = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    do {
+        *--begin = static_cast<char>('0' + absolute % 10);
+        absolute /= 10;
+    } while(absolute != 0);
+
+    if(value < 0) {
+        *--begin = '-';
+    }
+
+    append_cell(begin, end - begin, cell_type::integer).integer = value;
+}
+
+void query_result::add_double(const double value)
+{
+    char text[32];
+    auto size = static_cast<size_t>(std::snprintf(text, sizeof(text), "%.15g", value));
+
+    // Как и sqlite, явно указываем дробную часть, чтобы значение не выглядело целым: 1.0, 1.0e+20
+    if(std::strpbrk(text, ".ein") == nullptr) {
+        std::memcpy(text + size, ".0", 3);
+        size += 2;
+    } else if(std::strchr(text, '.') == nullptr) {
+        auto* exponent = std::strchr(text, 'e');
+        if(exponent != nullptr) {
+            std::memmove(exponent + 2, exponent, text + size + 1 - exponent);
+            std::memcpy(exponent, ".0", 2);
+            size += 2;
+        }
+    }
+
+    append_cell(text, size, cell_type::real).real = value;
+}
+
+void query_result::add_double(const double value, const char* text, const size_t size)
 {
-    return _result;
+    append_cell(text, size, cell_type::real).real = value;
 }
 
-std::list<query_result::row>& query_result::mutable_data()
+void query_result::add_blob(const void* data, const size_t size)
 {
-    return _result;
+    if(data == nullptr) {
+        add_null();
+        return;
+    }
+
+    append_cell(static_cast<const char*>(data), size, cell_type::blob);
+}
+
+const std::vector<query_result::column_name>& query_result::columns() const
+{
+    return column_info().names;
+}
+
+size_t query_result::column_index(const column_name& column) const
+{
+    const auto& indexes = column_info().indexes;
+    const auto it = indexes.find(column);
+    return it == indexes.end() ? npos : it->second;
+}
+
+size_t query_result::size() const
+{
+    const auto column_count = column_info().names.size();
+    return column_count == 0 ? 0 : _cells.size() / column_count;
+}
+
+size_t query_result::data_size() const
+{
+    // После каждого значения в буфере хранится завершающий нулевой символ
+    return _buffer.size() - _cells.size();
 }
 
 bool query_result::empty() const
 {
-    return _result.empty();
+    return size() == 0;
+}
+
+query_result::row_view query_result::at(const size_t row_index) const
+{
+    if(row_index >= size()) {
+        throw std::out_of_range("Row index is out of range");
+    }
+
+    return { this, row_index };
+}
+
+query_result::row_view query_result::operator[](const size_t row_index) const
+{
+    return { this, row_index };
+}
+
+query_result::const_iterator query_result::begin() const
+{
+    return { this, 0 };
+}
+
+query_result::const_iterator query_result::end() const
+{
+    return { this, size() };
+}
+
+std::list<query_result::row> query_result::mutable_data() const
+{
+    return data();
+}
+
+std::list<query_result::row> query_result::data() const
+{
+    std::list<row> result;
+    for(const auto& row : *this) {
+        result.emplace_back(row.to_row());
+    }
+
+    return result;
+}
+
+const query_result::cell& query_result::cell_at(const size_t row_index, const size_t column_index) const
+{
+    const auto column_count = column_info().names.size();
+    if(column_index >= column_count) {
+        throw std::out_of_range("Column index is out of range");
+    }
+
+    return _cells[row_index * column_count + column_index];
+}
+
+query_result::cell& query_result::append_cell(const char* data, const size_t size, const cell_type type)
+{
+    if(size > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Cell value is larger than 4 GiB");
+    }
+
+    cell value;
+    value.offset = _buffer.size();
+    value.size = static_cast<uint32_t>(size);
+    value.type = type;
+    value.integer = 0;
+
+    if(size != 0) {
+        _buffer.append(data, size);
+    }
+    _buffer.push_back('\0');
+
+    _cells.push_back(value);
+    return _cells.back();
 }
 
 } // namespace database_adapter
@@ -0,0 +1,76 @@
+#include "DatabaseAdapter/model/statementsummary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace database_adapter {
+
+namespace {
+
+/// Количество бит номера корзины внутри степени двойки
+constexpr unsigned sub_bucket_bits = 4;
+
+} // namespace
+
+constexpr size_t latency_histogram::sub_bucket_count;
+constexpr size_t latency_histogram::bucket_count;
+
+uint64_t latency_histogram::lower_bound(const size_t bucket)
+{
+    if(bucket < sub_bucket_count) {
+        return bucket;
+    }
+
+    const auto shift = bucket / sub_bucket_count - 1;
+    return static_cast<uint64_t>(sub_bucket_count + bucket % sub_bucket_count) << shift;
+}
+
+void latency_histogram::add(const std::chrono::nanoseconds time)
+{
+    const auto value = static_cast<uint64_t>(std::max<std::chrono::nanoseconds::rep>(time.count(), 0));
+
+    size_t bucket = value;
+    if(value >= sub_bucket_count) {
+        unsigned exponent = sub_bucket_bits;
+        while(exponent < 63 && (value >> (exponent + 1)) != 0) {
+            exponent++;
+        }
+
+        const auto shift = exponent - sub_bucket_bits;
+        bucket = (shift + 1) * sub_bucket_count + ((value >> shift) & (sub_bucket_count - 1));
+    }
+
+    bucket = std::min(bucket, bucket_count - 1);
+    if(buckets[bucket] != UINT32_MAX) {
+        buckets[bucket]++;
+    }
+}
+
+std::chrono::nanoseconds latency_histogram::percentile(const double percent) const
+{
+    const auto total = count();
+    if(total == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    const auto rank = std::max<size_t>(1, static_cast<size_t>(std::ceil(total * std::min(std::max(percent, 0.0), 100.0) / 100.0)));
+
+    size_t seen = 0;
+    for(size_t bucket = 0; bucket < bucket_count; bucket++) {
+        seen += buckets[bucket];
+        if(seen >= rank) {
+            const auto upper = bucket + 1 < bucket_count ? lower_bound(bucket + 1) - 1 : lower_bound(bucket);
+            return std::chrono::nanoseconds(upper);
+        }
+    }
+
+    return std::chrono::nanoseconds(lower_bound(bucket_count - 1));
+}
+
+size_t latency_histogram::count() const
+{
+    return std::accumulate(buckets.begin(), buckets.end(), size_t(0));
+}
+
+} // namespace database_adapter
@@ -0,0 +1,63 @@
+#include "DatabaseAdapter/model/textview.h"
+
+#include <cstring>
+
+namespace database_adapter {
+
+text_view::text_view(const char* data, const size_t size)
+    : _data(data == nullptr ? "" : data)
+    , _size(data == nullptr ? 0 : size)
+{
+}
+
+const char* text_view::data() const
+{
+    return _data;
+}
+
+size_t text_view::size() const
+{
+    return _size;
+}
+
+bool text_view::empty() const
+{
+    return _size == 0;
+}
+
+std::string text_view::str() const
+{
+    return std::string(_data, _size);
+}
+
+bool text_view::operator==(const text_view& rhs) const
+{
+    return _size == rhs._size && std::memcmp(_data, rhs._data, _size) == 0;
+}
+
+bool text_view::operator!=(const text_view& rhs) const
+{
+    return !(*this == rhs);
+}
+
+bool text_view::operator==(const std::string& rhs) const
+{
+    return *this == text_view(rhs.data(), rhs.size());
+}
+
+bool text_view::operator!=(const std::string& rhs) const
+{
+    return !(*this == rhs);
+}
+
+bool text_view::operator==(const char* rhs) const
+{
+    return rhs != nullptr && *this == text_view(rhs, std::strlen(rhs));
+}
+
+bool text_view::operator!=(const char* rhs) const
+{
+    return !(*this == rhs);
+}
+
+} // namespace database_adapter
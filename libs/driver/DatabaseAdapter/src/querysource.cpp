@@ -0,0 +1,31 @@
+#include "DatabaseAdapter/querysource.h"
+
+namespace database_adapter {
+
+namespace {
+
+thread_local const char* current_source = nullptr;
+
+} // namespace
+
+query_source::query_source(const char* name)
+{
+    if(current_source == nullptr) {
+        current_source = name;
+        _owner = true;
+    }
+}
+
+query_source::~query_source()
+{
+    if(_owner) {
+        current_source = nullptr;
+    }
+}
+
+const char* query_source::current()
+{
+    return current_source;
+}
+
+} // namespace database_adapter
@@ -0,0 +1,175 @@
+#include "DatabaseAdapter/statementcache.h"
+
+#include <cctype>
+
+namespace database_adapter {
+
+namespace {
+
+/// @brief Может ли символ быть частью идентификатора
+bool is_identifier_symbol(const char symbol)
+{
+    const auto value = static_cast<unsigned char>(symbol);
+    return std::isalnum(value) || symbol == '_' || symbol == '$' || value >= 0x80;
+}
+
+/**
+ * @brief Найти конец строки в кавычках
+ * @param query SQL-запрос
+ * @param position Позиция открывающей кавычки
+ * @param backslash_escapes Экранирует ли '\' следующий символ (строки E'...')
+ * @return Позиция после закрывающей кавычки или конец запроса для незакрытой строки
+ */
+size_t quoted_end(const std::string& query, const size_t position, const bool backslash_escapes)
+{
+    const char quote = query[position];
+    for(size_t i = position + 1; i < query.size(); ++i) {
+        if(backslash_escapes && query[i] == '\\') {
+            ++i;
+            continue;
+        }
+
+        if(query[i] == quote) {
+            // Удвоенная кавычка внутри строки
+            if(i + 1 < query.size() && query[i + 1] == quote) {
+                ++i;
+                continue;
+            }
+
+            return i + 1;
+        }
+    }
+
+    return query.size();
+}
+
+/**
+ * @brief Найти конец блочного комментария с учётом вложенных комментариев
+ * @param query SQL-запрос
+ * @param position Позиция начала комментария
+ */
+size_t block_comment_end(const std::string& query, const size_t position)
+{
+    size_t depth = 0;
+    for(size_t i = position; i + 1 < query.size(); ++i) {
+        if(query[i] == '/' && query[i + 1] == '*') {
+            ++depth;
+            ++i;
+        } else if(query[i] == '*' && query[i + 1] == '/') {
+            ++i;
+            if(--depth == 0) {
+                return i + 1;
+            }
+        }
+    }
+
+    return query.size();
+}
+
+/**
+ * @brief Найти конец строки в долларовых кавычках $tag$...$tag$
+ * @param query SQL-запрос
+ * @param position Позиция символа '$'
+ * @return Позиция после закрывающего тега или position, если в позиции не начинается строка (например, параметр $1)
+ */
+size_t dollar_quoted_end(const std::string& query, const size_t position)
+{
+    size_t tag_end = position + 1;
+    if(tag_end < query.size() && std::isdigit(static_cast<unsigned char>(query[tag_end]))) {
+        return position;
+    }
+
+    while(tag_end < query.size() && query[tag_end] != '$' && is_identifier_symbol(query[tag_end])) {
+        ++tag_end;
+    }
+
+    if(tag_end >= query.size() || query[tag_end] != '$') {
+        return position;
+    }
+
+    const auto tag = query.substr(position, tag_end - position + 1);
+    const auto close = query.find(tag, tag_end + 1);
+
+    return close == std::string::npos ? query.size() : close + tag.size();
+}
+
+} // namespace
+
+size_t verbatim_span_end(const std::string& query, const size_t position)
+{
+    if(position >= query.size()) {
+        return position;
+    }
+
+    const char symbol = query[position];
+    const char next = position + 1 < query.size() ? query[position + 1] : '\0';
+    const bool after_identifier = position > 0 && is_identifier_symbol(query[position - 1]);
+
+    if(symbol == '\'' || symbol == '"') {
+        return quoted_end(query, position, false);
+    }
+
+    if((symbol == 'E' || symbol == 'e') && next == '\'' && !after_identifier) {
+        return quoted_end(query, position + 1, true);
+    }
+
+    if(symbol == '-' && next == '-') {
+        // Строчный комментарий переносится вместе с завершающим переводом строки
+        const auto end = query.find('\n', position);
+        return end == std::string::npos ? query.size() : end + 1;
+    }
+
+    if(symbol == '/' && next == '*') {
+        return block_comment_end(query, position);
+    }
+
+    if(symbol == '$' && !after_identifier) {
+        return dollar_quoted_end(query, position);
+    }
+
+    return position;
+}
+
+std::string normalize_sql(const std::string& query)
+{
+    std::string result;
+    result.reserve(query.size());
+
+    bool pending_space = false;
+    // Размер результата после последнего фрагмента, перенесённого без изменений. Его нельзя обрезать
+    size_t verbatim_size = 0;
+
+    for(size_t position = 0; position < query.size();) {
+        const char symbol = query[position];
+        if(std::isspace(static_cast<unsigned char>(symbol))) {
+            pending_space = !result.empty();
+            ++position;
+            continue;
+        }
+
+        if(pending_space) {
+            result.push_back(' ');
+            pending_space = false;
+        }
+
+        const auto span_end = verbatim_span_end(query, position);
+        if(span_end != position) {
+            result.append(query, position, span_end - position);
+            verbatim_size = result.size();
+            position = span_end;
+            continue;
+        }
+
+        result.push_back(symbol);
+        ++position;
+    }
+
+    // Завершающие ';' не влияют на запрос, поэтому "BEGIN;" и "BEGIN" считаются одним запросом
+    while(result.size() > verbatim_size && (result.back() == ';' || result.back() == ' ')) {
+        result.pop_back();
+    }
+
+    return result;
+}
+
+} // namespace database_adapter
@@ -0,0 +1,151 @@
+#include "DatabaseAdapter/statementstatistics.h"
+
+#include "DatabaseAdapter/statementcache.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace database_adapter {
+
+namespace {
+
+/// Время в миллисекундах для вывода таблицы
+double to_milliseconds(const std::chrono::nanoseconds time)
+{
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+} // namespace
+
+statement_statistics::statement_statistics(const size_t max_statements)
+    : _max_statements(max_statements)
+{
+}
+
+void statement_statistics::record(const query_metrics& metrics)
+{
+    const auto time = metrics.prepare_time + metrics.execute_time + metrics.fetch_time;
+
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+
+    auto it = _entries.find(metrics.fingerprint);
+    if(it == _entries.end()) {
+        if(_entries.size() >= _max_statements) {
+            _untracked++;
+            return;
+        }
+
+        it = _entries.emplace(metrics.fingerprint, entry {}).first;
+
+        auto& summary = it->second.summary;
+        summary.fingerprint = metrics.fingerprint;
+        summary.query = metrics.query;
+        summary.source = metrics.source;
+        summary.min_time = time;
+    }
+
+    auto& summary = it->second.summary;
+    summary.calls++;
+    summary.failures += metrics.failed ? 1 : 0;
+    summary.rows += metrics.rows;
+    summary.bytes_sent += metrics.bytes_sent;
+    summary.bytes_received += metrics.bytes_received;
+    summary.total_time += time;
+    summary.min_time = std::min(summary.min_time, time);
+    summary.max_time = std::max(summary.max_time, time);
+
+    it->second.histogram.add(time);
+}
+
+std::vector<statement_summary> statement_statistics::snapshot() const
+{
+    std::vector<statement_summary> result;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(_mutex);
+
+        result.reserve(_entries.size());
+        for(const auto& value : _entries) {
+            result.push_back(make_summary(value.second));
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const statement_summary& left, const statement_summary& right) {
+        return left.total_time > right.total_time;
+    });
+
+    return result;
+}
+
+statement_summary statement_statistics::get(const uint64_t fingerprint) const
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+
+    const auto it = _entries.find(fingerprint);
+    if(it == _entries.end()) {
+        statement_summary summary;
+        summary.fingerprint = fingerprint;
+        return summary;
+    }
+
+    return make_summary(it->second);
+}
+
+void statement_statistics::dump(std::ostream& stream, const size_t limit) const
+{
+    const auto summaries = snapshot();
+    const auto count = limit == 0 ? summaries.size() : std::min(limit, summaries.size());
+
+    const auto flags = stream.flags();
+    const auto precision = stream.precision();
+
+    stream << std::setw(10) << "calls" << std::setw(12) << "total ms" << std::setw(10) << "mean ms" << std::setw(10) << "min ms"
+           << std::setw(10) << "max ms" << std::setw(10) << "p99 ms" << std::setw(10) << "rows" << std::setw(8) << "errors"
+           << "  source / query\n";
+
+    stream << std::fixed << std::setprecision(3);
+    for(size_t i = 0; i < count; i++) {
+        const auto& summary = summaries[i];
+
+        stream << std::setw(10) << summary.calls
+               << std::setw(12) << to_milliseconds(summary.total_time)
+               << std::setw(10) << to_milliseconds(summary.total_time) / summary.calls
+               << std::setw(10) << to_milliseconds(summary.min_time)
+               << std::setw(10) << to_milliseconds(summary.max_time)
+               << std::setw(10) << to_milliseconds(summary.p99_time)
+               << std::setw(10) << summary.rows
+               << std::setw(8) << summary.failures
+               << "  " << (summary.source[0] != '\0' ? summary.source : "-") << " / " << normalize_sql(summary.query) << "\n";
+    }
+
+    if(untracked() != 0) {
+        stream << "untracked calls: " << untracked() << "\n";
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void statement_statistics::reset()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+
+    _entries.clear();
+    _untracked = 0;
+}
+
+size_t statement_statistics::untracked() const
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    return _untracked;
+}
+
+statement_summary statement_statistics::make_summary(const entry& value)
+{
+    auto summary = value.summary;
+    // Перцентиль не превышает максимум, так как граница корзины может быть больше измеренного времени
+    summary.p99_time = std::min(value.histogram.percentile(99.0), summary.max_time);
+    return summary;
+}
+
+} // namespace database_adapter
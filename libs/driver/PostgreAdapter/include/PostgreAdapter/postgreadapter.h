@@ -1,6 +1,8 @@
 #pragma once
 
+#include "postgrebulkinsert.h"
 #include "postgreconnection.h"
 #include "postgreconnectionpool.h"
+#include "postgrerowstream.h"
 #include "postgretransactiontype.h"
 #include <DatabaseAdapter/databaseadapter.h>
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "postgreadapter_global.h"
+
+#include <DatabaseAdapter/model/queryresult.h>
+#include <libpq-fe.h>
+
+#include <cstddef>
+
+namespace database_adapter {
+namespace postgre {
+
+/// @brief Параметры сеанса, от которых зависит текстовое представление значений на сервере
+struct binary_format_settings
+{
+    /// @brief DateStyle = ISO и время хранится целыми числами (integer_datetimes)
+    bool iso_timestamps = false;
+    /// @brief Часовой пояс сеанса UTC, timestamptz выводится со смещением +00
+    bool utc_time_zone = false;
+    /// @brief Сервер PostgreSQL 12 и новее выводит кратчайшее точное представление чисел с плавающей точкой
+    /// @note Предполагается значение extra_float_digits по умолчанию (больше 0), сервер не сообщает о его изменении
+    bool shortest_floats = false;
+};
+
+/**
+ * @brief Получить параметры сеанса по значениям, которые сообщает сервер (PQparameterStatus, PQserverVersion)
+ * @param date_style Значение DateStyle, может быть nullptr
+ * @param time_zone Значение TimeZone, может быть nullptr
+ * @param integer_datetimes Значение integer_datetimes, может быть nullptr
+ * @param server_version Версия сервера в формате PQserverVersion
+ */
+POSTGRE_EXPORT binary_format_settings make_binary_format_settings(const char* date_style, const char* time_zone, const char* integer_datetimes, int server_version);
+
+/**
+ * @brief Проверка может ли значение типа быть получено от сервера в бинарном формате
+ * @param type OID типа колонки результата
+ * @param settings Параметры сеанса
+ * @return true, если декодированное значение совпадает с текстовым представлением сервера при этих параметрах
+ */
+POSTGRE_EXPORT bool has_binary_decoder(Oid type, const binary_format_settings& settings);
+
+/**
+ * @brief Добавляет в результат значение, полученное от сервера в бинарном формате
+ * @param type OID типа колонки результата
+ * @param data Значение в бинарном формате
+ * @param size Размер значения в байтах
+ * @param result Результат, в который добавляется ячейка
+ * @note Целые числа и числа с плавающей точкой добавляются типизированными ячейками.
+ * Текст всех значений совпадает с текстовым представлением сервера при параметрах, для которых has_binary_decoder вернул true
+ * @throws std::invalid_argument Если тип не поддерживается или значение повреждено
+ */
+POSTGRE_EXPORT void append_binary_value(Oid type, const char* data, size_t size, query_result& result);
+
+} // namespace postgre
+} // namespace database_adapter
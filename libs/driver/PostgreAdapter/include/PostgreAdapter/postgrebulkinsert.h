@@ -0,0 +1,37 @@
+#pragma once
+
+#include "postgreadapter_global.h"
+
+#include <DatabaseAdapter/model/queryresult.h>
+
+#include <string>
+#include <vector>
+
+namespace database_adapter {
+namespace postgre {
+
+/**
+ * @brief Формирует запрос переноса строк из временной таблицы массовой вставки в целевую таблицу
+ * @param table Целевая таблица в виде, пригодном для подстановки в запрос
+ * @param temp_table Временная таблица с колонками columns и порядковым номером строки order_column
+ * @param columns Имена вставляемых колонок
+ * @param order_column Имя колонки порядкового номера строки во временной таблице
+ * @param returning Имена колонок целевой таблицы, значения которых возвращаются после вставки
+ * @return Запрос MERGE (PostgreSQL 17 и новее), первой колонкой результата которого идёт порядковый номер строки, а за ней колонки returning
+ */
+POSTGRE_EXPORT std::string bulk_insert_merge_sql(const std::string& table,
+    const std::string& temp_table,
+    const std::vector<std::string>& columns,
+    const std::string& order_column,
+    const std::vector<std::string>& returning);
+
+/**
+ * @brief Расставляет строки результата массовой вставки по их порядковым номерам
+ * @param result Результат bulk_insert_merge_sql, первая колонка - порядковый номер строки начиная с 1
+ * @return Результат без колонки порядкового номера, строки которого идут в порядке номеров
+ * @throws std::invalid_argument Если номера строк не образуют последовательность от 1 до количества строк
+ */
+POSTGRE_EXPORT query_result order_by_ordinal(const query_result& result);
+
+} // namespace postgre
+} // namespace database_adapter
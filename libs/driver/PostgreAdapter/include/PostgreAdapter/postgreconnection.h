@@ -7,6 +7,7 @@
 #include <libpq-fe.h>
 
 #include <memory>
+#include <vector>
 
 namespace database_adapter {
 class POSTGRE_EXPORT IConnection;
@@ -30,22 +31,178 @@ public:
     ~connection() override;
 
     bool is_valid() override;
+    bool is_alive() const override;
     query_result exec(const std::string& query) override;
+    using IConnection::exec_stream;
+    void exec_stream(const std::string& query, const std::vector<std::string>& params, const row_callback& callback) override;
+
+    /**
+     * @brief Выгружает результат запроса через COPY (...) TO STDOUT в текстовом формате
+     * @note Имена колонок получаются описанием неименованного подготовленного запроса, так как COPY их не передаёт
+     */
+    void export_stream(const std::string& query, const row_callback& callback) override;
 
     void prepare(const std::string& query, const std::string& name) override;
     query_result exec_prepared(const std::vector<std::string>& params, const std::string& name) override;
+    query_result exec_prepared(const std::string& query, const std::vector<std::string>& params) override;
+
+    /**
+     * @brief Выполнить параметризованный запрос с типизированными значениями параметров
+     * @note Текст и бинарные данные передаются в libpq без копирования, бинарные данные в бинарном формате.
+     * Числа передаются в текстовом формате, чтобы сервер сам определил тип параметра по запросу.
+     * Буферы параметров переиспользуются между вызовами
+     */
+    query_result exec_typed(const std::string& query, const bind_parameters& params) override;
+
+    /**
+     * @brief Выполнить несколько параметризованных запросов в режиме конвейера libpq
+     * @note Запросы отправляются на сервер без ожидания ответов, результаты вычитываются после отправки.
+     * Вне транзакции запросы одного конвейера выполняются в неявной транзакции, и ошибка отменяет их все.
+     * Запрос не может содержать несколько команд
+     */
+    std::vector<query_result> exec_batch(const std::vector<batch_statement>& statements) override;
+
+    /**
+     * @brief Массовая вставка строк через COPY FROM STDIN в текстовом формате
+     * @note Для получения значений returning строки сначала загружаются во временную таблицу с порядковым номером строки,
+     * а затем переносятся одним запросом MERGE ... RETURNING, который возвращает номер вместе со значениями.
+     * На серверах до PostgreSQL 17 значения returning получаются базовой реализацией
+     */
+    query_result bulk_insert(const std::string& table, const std::vector<std::string>& columns, const row_source& next_row, const std::vector<std::string>& returning) override;
+
+    bool numbered_placeholders() const override;
+    size_t max_bind_parameters() const override;
 
     bool open_transaction(int type) override;
 
+    statement_cache_stats cache_stats() const override;
+
+private:
+    /// @brief Запрос подготовленный на сервере
+    struct prepared_statement
+    {
+        /// @brief Имя подготовленного запроса
+        std::string name {};
+        /// @brief Описание результата получено от сервера
+        bool described = false;
+        /// @brief Типы колонок результата
+        std::vector<Oid> column_types {};
+    };
+
 private:
     void connect(const settings& settings);
     void disconnect();
 
+    /**
+     * @brief Выполняет запрос через кэш подготовленных запросов
+     * @param query SQL-запрос
+     * @param count Количество параметров
+     * @param values Значения параметров, nullptr - NULL
+     * @param lengths Размеры значений параметров в бинарном формате, может быть nullptr
+     * @param formats Форматы параметров (0 - текстовый, 1 - бинарный), nullptr - все текстовые
+     * @return Результат выполнения SQL-запроса.
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    query_result exec_params(const std::string& query, int count, const char* const* values, const int* lengths, const int* formats);
+
+    /**
+     * @brief Переносит строки полученные от сервера в результат запроса
+     * @param pg_result Результат выполнения запроса libpq
+     * @return Результат запроса
+     */
+    static query_result read_rows(PGresult* pg_result);
+
+    /**
+     * @brief Задаёт результату имена колонок полученных от сервера
+     * @param pg_result Результат выполнения запроса libpq
+     * @param result Результат, которому будут заданы колонки
+     */
+    static void read_columns(PGresult* pg_result, query_result& result);
+
+    /**
+     * @brief Добавляет в результат строки полученные от сервера
+     * @param pg_result Результат выполнения запроса libpq
+     * @param result Результат с заданными колонками, в который будут добавлены строки
+     */
+    static void append_rows(PGresult* pg_result, query_result& result);
+
+    /**
+     * @brief Получить типы колонок результата
+     * @param description Описание подготовленного запроса
+     */
+    static std::vector<Oid> result_types(PGresult* description);
+
+    /**
+     * @brief Проверка можно ли получить все колонки результата в бинарном формате
+     * @param statement Подготовленный запрос
+     * @note Проверяется при каждом выполнении, так как текстовое представление зависит от текущих параметров сеанса
+     */
+    bool has_binary_result(const prepared_statement& statement) const;
+
+    /**
+     * @brief Выполняет часть пакета запросов одним конвейером
+     * @param statements Пакет запросов
+     * @param begin Индекс первого запроса
+     * @param end Индекс после последнего запроса
+     * @param results Результаты пакета, заполняются результаты выполненных запросов
+     * @throws sql_exception Выбрасывает исключение с первой ошибкой конвейера
+     */
+    void exec_pipeline(const std::vector<batch_statement>& statements, size_t begin, size_t end, std::vector<query_result>& results);
+
+    /**
+     * @brief Выполняет COPY FROM STDIN и передаёт серверу строки в текстовом формате COPY
+     * @param query Запрос COPY ... FROM STDIN
+     * @param column_count Количество колонок в каждой строке
+     * @param next_row Функция получения следующей строки
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    void copy_from_stdin(const std::string& query, size_t column_count, const row_source& next_row);
+
+    /**
+     * @brief Получить имена колонок результата запроса без его выполнения
+     * @param query SQL-запрос
+     * @throws sql_exception Выбрасывает исключение в случае ошибки подготовки запроса
+     */
+    std::vector<query_result::column_name> describe_columns(const std::string& query);
+
+    /// @brief Отменяет выполнение текущего запроса на сервере
+    void cancel();
+
+    /**
+     * @brief Получить подготовленный на сервере запрос, при отсутствии в кэше запрос подготавливается и описывается
+     * @param key Нормализованный SQL-запрос
+     * @param query SQL-запрос
+     * @return Подготовленный запрос
+     * @throws sql_exception Выбрасывает исключение в случае ошибки подготовки запроса
+     */
+    const prepared_statement& cached_statement(const std::string& key, const std::string& query);
+
+    /// @brief Освобождает подготовленный запрос на сервере
+    void deallocate(const std::string& name);
+
 private:
     static std::shared_ptr<ILogger> _logger;
 
 private:
     PGconn* _connection = nullptr;
+
+    /// @brief Кэш запросов выполняемых через exec, которые подготовлены на сервере
+    statement_cache<prepared_statement> _statement_cache;
+    /// @brief Счётчик для формирования уникальных имён подготовленных запросов
+    size_t _statement_counter = 0;
+    /// @brief Счётчик для формирования уникальных имён временных таблиц массовой вставки
+    size_t _bulk_insert_counter = 0;
+
+    /// @brief Указатели на значения параметров exec_typed
+    std::vector<const char*> _param_values {};
+    /// @brief Размеры значений параметров exec_typed
+    std::vector<int> _param_lengths {};
+    /// @brief Форматы параметров exec_typed
+    std::vector<int> _param_formats {};
+    /// @brief Смещения значений параметров exec_typed в _param_buffer, npos - значение не копировалось
+    std::vector<size_t> _param_offsets {};
+    /// @brief Буфер для текстового представления чисел и текста без завершающего нуля
+    std::string _param_buffer {};
 };
 
 } // namespace postgre
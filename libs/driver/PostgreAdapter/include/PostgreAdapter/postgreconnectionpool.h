@@ -15,15 +15,15 @@ public:
 
     static size_t start_pool_size;
     static size_t max_pool_size;
-    static std::chrono::seconds wait_time;
+    static std::chrono::milliseconds wait_time;
+    static pool_health_settings health_settings;
+    static metrics_callback metrics_reporter;
+    static std::chrono::milliseconds metrics_interval;
 
     static std::shared_ptr<connection_pool> instance();
 
 public:
-    explicit connection_pool(database_connection_settings settings, size_t start_pool_size = 2, size_t max_pool_size = 10, std::chrono::seconds wait_time = std::chrono::seconds(2));
-
-protected:
-    std::shared_ptr<IConnection> create_connection(const database_connection_settings& settings) override;
+    explicit connection_pool(database_connection_settings settings, size_t start_pool_size = 2, size_t max_pool_size = 10, std::chrono::milliseconds wait_time = std::chrono::seconds(2));
 };
 
 } // namespace postgre
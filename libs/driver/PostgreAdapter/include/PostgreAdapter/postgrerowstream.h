@@ -0,0 +1,20 @@
+#pragma once
+
+#include "postgreadapter_global.h"
+
+#include <DatabaseAdapter/iconnection.h>
+#include <libpq-fe.h>
+
+namespace database_adapter {
+namespace postgre {
+
+/**
+ * @brief Передаёт строки результата libpq в callback по одной
+ * @param pg_result Результат в текстовом формате: одна строка в режиме одной строки или весь результат, если режим включить не удалось
+ * @param row Буфер строки, колонки задаются при первом вызове и переиспользуются для следующих результатов того же запроса
+ * @param callback Функция, которая вызывается для каждой строки результата
+ */
+POSTGRE_EXPORT void stream_rows(const PGresult* pg_result, query_result& row, const IConnection::row_callback& callback);
+
+} // namespace postgre
+} // namespace database_adapter
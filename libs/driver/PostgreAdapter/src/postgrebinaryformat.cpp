@@ -0,0 +1,424 @@
+#include "PostgreAdapter/postgrebinaryformat.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace database_adapter {
+namespace postgre {
+
+namespace {
+
+// OID встроенных типов из pg_type.h, который не входит в состав заголовков libpq
+constexpr Oid bool_oid = 16;
+constexpr Oid name_oid = 19;
+constexpr Oid int8_oid = 20;
+constexpr Oid int2_oid = 21;
+constexpr Oid int4_oid = 23;
+constexpr Oid text_oid = 25;
+constexpr Oid oid_oid = 26;
+constexpr Oid float4_oid = 700;
+constexpr Oid float8_oid = 701;
+constexpr Oid bpchar_oid = 1042;
+constexpr Oid varchar_oid = 1043;
+constexpr Oid timestamp_oid = 1114;
+constexpr Oid timestamptz_oid = 1184;
+constexpr Oid numeric_oid = 1700;
+constexpr Oid uuid_oid = 2950;
+
+/// Количество дней между 1970-01-01 и 2000-01-01, от которой сервер отсчитывает время
+constexpr int64_t postgres_epoch_days = 10957;
+
+constexpr int64_t microseconds_per_day = 86400000000LL;
+
+/// Значения числа numeric в поле знака
+constexpr uint16_t numeric_negative = 0x4000;
+constexpr uint16_t numeric_nan = 0xC000;
+constexpr uint16_t numeric_positive_infinity = 0xD000;
+constexpr uint16_t numeric_negative_infinity = 0xF000;
+
+/// Чтение целого числа в сетевом порядке байт
+template<typename Integer>
+Integer read_integer(const char* data)
+{
+    uint64_t value = 0;
+    for(size_t i = 0; i < sizeof(Integer); i++) {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+
+    return static_cast<Integer>(value);
+}
+
+void check_size(const size_t size, const size_t expected)
+{
+    if(size != expected) {
+        throw std::invalid_argument("Unexpected size of binary value");
+    }
+}
+
+/// Разбор текстового представления числа без потери точности типа
+inline double parse_real(const char* text, double /*tag*/)
+{
+    return std::strtod(text, nullptr);
+}
+
+inline float parse_real(const char* text, float /*tag*/)
+{
+    return std::strtof(text, nullptr);
+}
+
+/**
+ * Добавляет число с плавающей точкой в том же виде, что и сервер начиная с PostgreSQL 12 (функции float4out/float8out):
+ * кратчайшее количество значащих цифр, которое читается обратно без потерь. Число выводится без экспоненты,
+ * если десятичный порядок первой цифры лежит в [-4, fixed_exponent_limit), иначе в виде d.ddde+XX
+ */
+template<typename Real>
+void append_real(const Real value, const int max_precision, const int fixed_exponent_limit, query_result& result)
+{
+    char text[64];
+    int size = 0;
+
+    if(value != value) {
+        size = std::snprintf(text, sizeof(text), "NaN");
+    } else if(value == std::numeric_limits<Real>::infinity()) {
+        size = std::snprintf(text, sizeof(text), "Infinity");
+    } else if(value == -std::numeric_limits<Real>::infinity()) {
+        size = std::snprintf(text, sizeof(text), "-Infinity");
+    } else if(value == 0) {
+        size = std::snprintf(text, sizeof(text), "%s", std::signbit(value) ? "-0" : "0");
+    } else {
+        char scientific[64];
+        for(int precision = 1; precision <= max_precision; precision++) {
+            std::snprintf(scientific, sizeof(scientific), "%.*e", precision - 1, static_cast<double>(value));
+            if(parse_real(scientific, value) == value) {
+                break;
+            }
+        }
+
+        // Значащие цифры и порядок из представления [-]d.ddde[+-]XX
+        const char* mantissa = scientific;
+        if(*mantissa == '-') {
+            text[size++] = '-';
+            mantissa++;
+        }
+
+        char digits[32];
+        int digit_count = 0;
+        const char* symbol = mantissa;
+        for(; *symbol != 'e'; symbol++) {
+            if(*symbol != '.') {
+                digits[digit_count++] = *symbol;
+            }
+        }
+        const int exponent = std::atoi(symbol + 1);
+
+        if(exponent >= -4 && exponent < fixed_exponent_limit) {
+            if(exponent < 0) {
+                text[size++] = '0';
+                text[size++] = '.';
+                for(int i = -1; i > exponent; i--) {
+                    text[size++] = '0';
+                }
+                std::memcpy(text + size, digits, digit_count);
+                size += digit_count;
+            } else {
+                for(int i = 0; i <= exponent; i++) {
+                    text[size++] = i < digit_count ? digits[i] : '0';
+                }
+                if(digit_count > exponent + 1) {
+                    text[size++] = '.';
+                    std::memcpy(text + size, digits + exponent + 1, digit_count - exponent - 1);
+                    size += digit_count - exponent - 1;
+                }
+            }
+        } else {
+            text[size++] = digits[0];
+            if(digit_count > 1) {
+                text[size++] = '.';
+                std::memcpy(text + size, digits + 1, digit_count - 1);
+                size += digit_count - 1;
+            }
+            size += std::snprintf(text + size, sizeof(text) - size, "e%c%02d", exponent < 0 ? '-' : '+', exponent < 0 ? -exponent : exponent);
+        }
+    }
+
+    result.add_double(static_cast<double>(value), text, static_cast<size_t>(size));
+}
+
+/// Дата по количеству дней от 1970-01-01 (алгоритм days_from_civil в обратную сторону)
+void civil_from_days(int64_t days, int64_t& year, unsigned& month, unsigned& day)
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto day_of_era = static_cast<unsigned>(days - era * 146097);
+    const unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const unsigned month_index = (5 * day_of_year + 2) / 153;
+
+    day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    month = month_index < 10 ? month_index + 3 : month_index - 9;
+    year = static_cast<int64_t>(year_of_era) + era * 400 + (month <= 2 ? 1 : 0);
+}
+
+void append_timestamp(const int64_t value, const bool with_time_zone, query_result& result)
+{
+    if(value == std::numeric_limits<int64_t>::max()) {
+        result.add_value("infinity", 8);
+        return;
+    }
+    if(value == std::numeric_limits<int64_t>::min()) {
+        result.add_value("-infinity", 9);
+        return;
+    }
+
+    // Деление с округлением вниз, чтобы время до 2000 года не получалось отрицательным
+    int64_t days = value / microseconds_per_day;
+    int64_t time = value % microseconds_per_day;
+    if(time < 0) {
+        time += microseconds_per_day;
+        days--;
+    }
+
+    int64_t year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+    civil_from_days(days + postgres_epoch_days, year, month, day);
+
+    const auto seconds = time / 1000000;
+    const auto fraction = time % 1000000;
+
+    // Для дат до нашей эры сервер выводит номер года без нулевого года и суффикс BC
+    const bool before_christ = year <= 0;
+
+    char text[64];
+    auto size = std::snprintf(text, sizeof(text), "%04lld-%02u-%02u %02lld:%02lld:%02lld",
+        static_cast<long long>(before_christ ? 1 - year : year), month, day,
+        static_cast<long long>(seconds / 3600), static_cast<long long>(seconds / 60 % 60), static_cast<long long>(seconds % 60));
+
+    if(fraction != 0) {
+        size += std::snprintf(text + size, sizeof(text) - size, ".%06lld", static_cast<long long>(fraction));
+        // Сервер не выводит завершающие нули дробной части
+        while(text[size - 1] == '0') {
+            size--;
+        }
+    }
+
+    // Бинарный формат timestamptz используется только при часовом поясе сеанса UTC
+    if(with_time_zone) {
+        size += std::snprintf(text + size, sizeof(text) - size, "+00");
+    }
+
+    if(before_christ) {
+        size += std::snprintf(text + size, sizeof(text) - size, " BC");
+    }
+
+    result.add_value(text, static_cast<size_t>(size));
+}
+
+void append_uuid(const char* data, query_result& result)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    char text[36];
+    size_t size = 0;
+    for(size_t i = 0; i < 16; i++) {
+        if(i == 4 || i == 6 || i == 8 || i == 10) {
+            text[size++] = '-';
+        }
+
+        const auto byte = static_cast<unsigned char>(data[i]);
+        text[size++] = hex[byte >> 4];
+        text[size++] = hex[byte & 0x0F];
+    }
+
+    result.add_value(text, size);
+}
+
+/// Формирует текст числа numeric так же, как функция get_str_from_var сервера
+void append_numeric(const char* data, const size_t size, query_result& result)
+{
+    if(size < 8) {
+        throw std::invalid_argument("Unexpected size of binary value");
+    }
+
+    const auto digit_count = read_integer<int16_t>(data);
+    const auto weight = read_integer<int16_t>(data + 2);
+    const auto sign = read_integer<uint16_t>(data + 4);
+    const auto scale = read_integer<int16_t>(data + 6);
+
+    check_size(size, 8 + 2 * static_cast<size_t>(digit_count < 0 ? 0 : digit_count));
+
+    switch(sign) {
+        case numeric_nan:
+            result.add_value("NaN", 3);
+            return;
+        case numeric_positive_infinity:
+            result.add_value("Infinity", 8);
+            return;
+        case numeric_negative_infinity:
+            result.add_value("-Infinity", 9);
+            return;
+        default:
+            break;
+    }
+
+    // Цифры хранятся по основанию 10000, weight - степень первой цифры
+    const auto digit = [data, digit_count](const int index) {
+        return index >= 0 && index < digit_count ? read_integer<int16_t>(data + 8 + 2 * index) : 0;
+    };
+
+    std::string text;
+    if(sign == numeric_negative) {
+        text.push_back('-');
+    }
+
+    char group[8];
+    if(weight < 0) {
+        text.push_back('0');
+    } else {
+        for(int i = 0; i <= weight; i++) {
+            const auto group_size = std::snprintf(group, sizeof(group), i == 0 ? "%d" : "%04d", digit(i));
+            text.append(group, group_size);
+        }
+    }
+
+    if(scale > 0) {
+        text.push_back('.');
+
+        const auto fraction_begin = text.size();
+        for(int i = weight + 1; text.size() - fraction_begin < static_cast<size_t>(scale); i++) {
+            const auto group_size = std::snprintf(group, sizeof(group), "%04d", digit(i));
+            text.append(group, group_size);
+        }
+        text.resize(fraction_begin + scale);
+    }
+
+    result.add_value(text.data(), text.size());
+}
+
+/// Часовые пояса, в которых сервер выводит смещение +00
+bool is_utc_time_zone(const char* time_zone)
+{
+    static const char* const names[] = { "UTC", "Etc/UTC", "UCT", "Etc/UCT", "GMT", "Etc/GMT", "GMT0", "Etc/GMT0",
+        "GMT+0", "Etc/GMT+0", "GMT-0", "Etc/GMT-0", "Greenwich", "Etc/Greenwich", "Universal", "Etc/Universal", "Zulu", "Etc/Zulu" };
+
+    for(const auto* name : names) {
+        if(std::strcmp(time_zone, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace
+
+binary_format_settings make_binary_format_settings(const char* date_style, const char* time_zone, const char* integer_datetimes, const int server_version)
+{
+    binary_format_settings settings;
+    settings.iso_timestamps = date_style != nullptr && std::strncmp(date_style, "ISO", 3) == 0
+        && integer_datetimes != nullptr && std::strcmp(integer_datetimes, "on") == 0;
+    settings.utc_time_zone = time_zone != nullptr && is_utc_time_zone(time_zone);
+    settings.shortest_floats = server_version >= 120000;
+
+    return settings;
+}
+
+bool has_binary_decoder(const Oid type, const binary_format_settings& settings)
+{
+    switch(type) {
+        case bool_oid:
+        case name_oid:
+        case int8_oid:
+        case int2_oid:
+        case int4_oid:
+        case text_oid:
+        case oid_oid:
+        case bpchar_oid:
+        case varchar_oid:
+        case numeric_oid:
+        case uuid_oid:
+            return true;
+        case float4_oid:
+        case float8_oid:
+            return settings.shortest_floats;
+        case timestamp_oid:
+            return settings.iso_timestamps;
+        case timestamptz_oid:
+            return settings.iso_timestamps && settings.utc_time_zone;
+        default:
+            // bytea не входит в список: текстовый вид зависит от bytea_output, о котором сервер не сообщает
+            return false;
+    }
+}
+
+void append_binary_value(const Oid type, const char* data, const size_t size, query_result& result)
+{
+    switch(type) {
+        case bool_oid:
+            check_size(size, 1);
+            result.add_value(data[0] != 0 ? "t" : "f", 1);
+            break;
+        case int2_oid:
+            check_size(size, 2);
+            result.add_int64(read_integer<int16_t>(data));
+            break;
+        case int4_oid:
+            check_size(size, 4);
+            result.add_int64(read_integer<int32_t>(data));
+            break;
+        case int8_oid:
+            check_size(size, 8);
+            result.add_int64(read_integer<int64_t>(data));
+            break;
+        case oid_oid:
+            check_size(size, 4);
+            result.add_int64(read_integer<uint32_t>(data));
+            break;
+        case float4_oid: {
+            check_size(size, 4);
+            const auto bits = read_integer<uint32_t>(data);
+            float value = 0;
+            std::memcpy(&value, &bits, sizeof(value));
+            append_real(value, 9, 6, result);
+            break;
+        }
+        case float8_oid: {
+            check_size(size, 8);
+            const auto bits = read_integer<uint64_t>(data);
+            double value = 0;
+            std::memcpy(&value, &bits, sizeof(value));
+            append_real(value, 17, 15, result);
+            break;
+        }
+        case timestamp_oid:
+        case timestamptz_oid:
+            check_size(size, 8);
+            append_timestamp(read_integer<int64_t>(data), type == timestamptz_oid, result);
+            break;
+        case uuid_oid:
+            check_size(size, 16);
+            append_uuid(data, result);
+            break;
+        case numeric_oid:
+            append_numeric(data, size, result);
+            break;
+        case name_oid:
+        case text_oid:
+        case bpchar_oid:
+        case varchar_oid:
+            // Бинарное представление текстовых типов совпадает с текстовым
+            result.add_value(data, size);
+            break;
+        default:
+            throw std::invalid_argument("Binary format of type " + std::to_string(type) + " is not supported");
+    }
+}
+
+} // namespace postgre
+} // namespace database_adapter
@@ -0,0 +1,81 @@
+#include "PostgreAdapter/postgrebulkinsert.h"
+
+#include <stdexcept>
+
+namespace database_adapter {
+namespace postgre {
+
+namespace {
+
+/// Формирует список колонок с псевдонимом таблицы через запятую
+std::string qualified_columns(const std::string& alias, const std::vector<std::string>& columns)
+{
+    std::string result;
+    for(const auto& column : columns) {
+        result.append(result.empty() ? "" : ", ").append(alias).append(".\"").append(column).append("\"");
+    }
+
+    return result;
+}
+
+} // namespace
+
+std::string bulk_insert_merge_sql(const std::string& table,
+    const std::string& temp_table,
+    const std::vector<std::string>& columns,
+    const std::string& order_column,
+    const std::vector<std::string>& returning)
+{
+    std::string column_list;
+    for(const auto& column : columns) {
+        column_list.append(column_list.empty() ? "\"" : ", \"").append(column).append("\"");
+    }
+
+    // Условие ON false вставляет каждую строку источника, а RETURNING в MERGE может вернуть колонку источника
+    std::string sql = "MERGE INTO " + table + " AS target USING " + temp_table + " AS source ON false WHEN NOT MATCHED THEN INSERT (" + column_list
+        + ") VALUES (" + qualified_columns("source", columns) + ") RETURNING source.\"" + order_column + "\"";
+
+    if(!returning.empty()) {
+        sql.append(", ").append(qualified_columns("target", returning));
+    }
+
+    return sql;
+}
+
+query_result order_by_ordinal(const query_result& result)
+{
+    const auto& columns = result.columns();
+    if(columns.empty()) {
+        throw std::invalid_argument("bulk insert result without order column");
+    }
+
+    std::vector<size_t> rows(result.size(), query_result::npos);
+    for(size_t i = 0; i < result.size(); i++) {
+        const auto ordinal = result[i].as_int64(0);
+        if(ordinal < 1 || static_cast<size_t>(ordinal) > rows.size() || rows[ordinal - 1] != query_result::npos) {
+            throw std::invalid_argument("bulk insert result has unexpected row order " + std::to_string(ordinal));
+        }
+
+        rows[ordinal - 1] = i;
+    }
+
+    query_result ordered(std::vector<query_result::column_name>(columns.begin() + 1, columns.end()));
+    ordered.reserve(rows.size(), result.data_size());
+
+    for(const auto row_index : rows) {
+        const auto row = result[row_index];
+        for(size_t column = 1; column < columns.size(); column++) {
+            if(row.is_null(column)) {
+                ordered.add_null();
+            } else {
+                const auto value = row.as_text(column);
+                ordered.add_value(value.data(), value.size());
+            }
+        }
+    }
+
+    return ordered;
+}
+
+} // namespace postgre
+} // namespace database_adapter
@@ -1,15 +1,289 @@
 #include "PostgreAdapter/postgreconnection.h"
 
 #include "DatabaseAdapter/databaseadapter.h"
+#include "PostgreAdapter/postgrebinaryformat.h"
+#include "PostgreAdapter/postgrebulkinsert.h"
+#include "PostgreAdapter/postgrerowstream.h"
 #include "PostgreAdapter/postgretransactiontype.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <exception>
 #include <iostream>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _WIN32
+#    include <winsock2.h>
+#else
+#    include <poll.h>
+#endif
 
 namespace database_adapter {
 namespace postgre {
 
+namespace {
+
+/**
+ * Проверка можно ли выполнять запрос через кэш подготовленных запросов
+ * @param query Нормализованный SQL-запрос
+ * @note Кэшируются только одиночные DML запросы, так как именно они выигрывают от повторного использования плана.
+ * Подготовка нескольких запросов сразу невозможна, а служебные команды и DDL выполняются редко
+ */
+bool is_cacheable_statement(const std::string& query)
+{
+    const auto keyword_end = query.find_first_of(" (");
+    auto keyword = query.substr(0, keyword_end);
+    std::transform(keyword.begin(), keyword.end(), keyword.begin(), [](const unsigned char symbol) { return static_cast<char>(std::toupper(symbol)); });
+
+    if(keyword != "SELECT" && keyword != "INSERT" && keyword != "UPDATE" && keyword != "DELETE" && keyword != "WITH") {
+        return false;
+    }
+
+    for(size_t position = 0; position < query.size();) {
+        const auto span_end = verbatim_span_end(query, position);
+        if(span_end != position) {
+            position = span_end;
+            continue;
+        }
+
+        if(query[position] == ';') {
+            return false;
+        }
+
+        ++position;
+    }
+
+    return true;
+}
+
+/**
+ * Проверка означает ли ошибка, что подготовленный запрос больше нельзя использовать
+ * @param pg_result Результат выполнения запроса
+ */
+bool is_stale_statement_error(const PGresult* pg_result)
+{
+    const auto* sql_state = PQresultErrorField(pg_result, PG_DIAG_SQLSTATE);
+    if(sql_state == nullptr) {
+        return false;
+    }
+
+    // 26000 - запрос не найден на сервере, 0A000 - изменилась структура результата (cached plan must not change result type)
+    return std::strcmp(sql_state, "26000") == 0 || std::strcmp(sql_state, "0A000") == 0;
+}
+
+/**
+ * Ожидание готовности сокета подключения
+ * @param socket Сокет подключения
+ * @param for_read true - ожидать возможности чтения, false - записи
+ * @param deadline Момент, до которого выполняется ожидание
+ * @return false, если время ожидания истекло или произошла ошибка
+ */
+bool wait_socket(const int socket, const bool for_read, const std::chrono::steady_clock::time_point deadline)
+{
+    while(true) {
+        const auto left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+        if(left.count() <= 0) {
+            return false;
+        }
+
+        // poll, в отличие от select, не ограничен номером сокета FD_SETSIZE
+        const auto timeout = static_cast<int>(std::min<long long>((left.count() + 999) / 1000, std::numeric_limits<int>::max()));
+
+#ifdef _WIN32
+        WSAPOLLFD poll_socket {};
+        poll_socket.fd = static_cast<SOCKET>(socket);
+        poll_socket.events = for_read ? POLLRDNORM : POLLWRNORM;
+
+        const auto rc = WSAPoll(&poll_socket, 1, timeout);
+        if(rc > 0) {
+            return true;
+        }
+
+        if(rc < 0) {
+            return false;
+        }
+#else
+        pollfd poll_socket {};
+        poll_socket.fd = socket;
+        poll_socket.events = for_read ? POLLIN : POLLOUT;
+
+        const auto rc = poll(&poll_socket, 1, timeout);
+        if(rc > 0) {
+            return true;
+        }
+#endif
+
+        // Прерывание сигналом не является ошибкой, ожидание продолжается до истечения времени
+        if(rc < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+/**
+ * Количество запросов, отправляемых в одном конвейере.
+ * Пока клиент отправляет запросы, он не читает ответы, поэтому слишком длинный конвейер может заполнить буферы сокета в обе стороны
+ */
+constexpr size_t pipeline_size = 256;
+
+/// Размер буфера, после заполнения которого данные COPY передаются в libpq
+constexpr size_t copy_buffer_size = 64 * 1024;
+
+/// Префикс имени временной таблицы для массовой вставки с возвратом значений
+constexpr const char* bulk_insert_table = "entity_craft_bulk_insert_";
+
+/// Колонка временной таблицы, сохраняющая порядок строк массовой вставки
+constexpr const char* bulk_insert_order_column = "entity_craft_order";
+
+/**
+ * Добавляет значение в буфер в текстовом формате COPY
+ * @param buffer Буфер данных COPY
+ * @param value Значение, NULL_VALUE записывается как \N
+ */
+void append_copy_value(std::string& buffer, const std::string& value)
+{
+    if(value == NULL_VALUE) {
+        buffer.append("\\N");
+        return;
+    }
+
+    // Разделители строк и колонок, а также сам символ экранирования должны быть экранированы
+    size_t begin = 0;
+    for(size_t i = 0; i < value.size(); i++) {
+        const char* escaped = nullptr;
+        switch(value[i]) {
+            case '\\':
+                escaped = "\\\\";
+                break;
+            case '\t':
+                escaped = "\\t";
+                break;
+            case '\n':
+                escaped = "\\n";
+                break;
+            case '\r':
+                escaped = "\\r";
+                break;
+            default:
+                continue;
+        }
+
+        buffer.append(value, begin, i - begin).append(escaped);
+        begin = i + 1;
+    }
+    buffer.append(value, begin, std::string::npos);
+}
+
+/**
+ * Добавляет в результат строку, полученную в текстовом формате COPY
+ * @param data Данные строки, завершающиеся символом перевода строки
+ * @param size Размер данных
+ * @param value Буфер для значения ячейки, переиспользуется между вызовами
+ * @param result Результат, в который добавляются ячейки
+ */
+void append_copy_row(const char* data, const size_t size, std::string& value, query_result& result)
+{
+    const char* end = data + size;
+    if(end != data && *(end - 1) == '\n') {
+        --end;
+    }
+
+    const char* position = data;
+    while(true) {
+        const char* field_end = position;
+        while(field_end != end && *field_end != '\t') {
+            ++field_end;
+        }
+
+        if(field_end - position == 2 && position[0] == '\\' && position[1] == 'N') {
+            result.add_null();
+        } else {
+            value.clear();
+            for(const char* symbol = position; symbol != field_end; ++symbol) {
+                if(*symbol != '\\' || symbol + 1 == field_end) {
+                    value.push_back(*symbol);
+                    continue;
+                }
+
+                ++symbol;
+                switch(*symbol) {
+                    case 'b':
+                        value.push_back('\b');
+                        break;
+                    case 'f':
+                        value.push_back('\f');
+                        break;
+                    case 'n':
+                        value.push_back('\n');
+                        break;
+                    case 'r':
+                        value.push_back('\r');
+                        break;
+                    case 't':
+                        value.push_back('\t');
+                        break;
+                    case 'v':
+                        value.push_back('\v');
+                        break;
+                    case 'x': {
+                        // \xh или \xhh - байт в шестнадцатеричном виде
+                        int byte = 0;
+                        int digits = 0;
+                        while(digits < 2 && symbol + 1 != field_end && std::isxdigit(static_cast<unsigned char>(symbol[1]))) {
+                            ++symbol;
+                            byte = byte * 16 + (std::isdigit(static_cast<unsigned char>(*symbol)) ? *symbol - '0' : std::tolower(static_cast<unsigned char>(*symbol)) - 'a' + 10);
+                            digits++;
+                        }
+                        value.push_back(digits == 0 ? 'x' : static_cast<char>(byte));
+                        break;
+                    }
+                    default:
+                        if(*symbol >= '0' && *symbol <= '7') {
+                            // \d, \dd или \ddd - байт в восьмеричном виде
+                            int byte = *symbol - '0';
+                            for(int digits = 1; digits < 3 && symbol + 1 != field_end && symbol[1] >= '0' && symbol[1] <= '7'; digits++) {
+                                ++symbol;
+                                byte = byte * 8 + (*symbol - '0');
+                            }
+                            value.push_back(static_cast<char>(byte));
+                        } else {
+                            // Остальные экранированные символы, в том числе обратная косая черта, передаются как есть
+                            value.push_back(*symbol);
+                        }
+                        break;
+                }
+            }
+
+            result.add_value(value.data(), value.size());
+        }
+
+        if(field_end == end) {
+            break;
+        }
+        position = field_end + 1;
+    }
+}
+
+/// Формирует список колонок в кавычках через запятую
+std::string columns_to_string(const std::vector<std::string>& columns)
+{
+    std::string result;
+    for(const auto& column : columns) {
+        result.append(result.empty() ? "\"" : ", \"").append(column).append("\"");
+    }
+
+    return result;
+}
+
+} // namespace
+
 std::shared_ptr<ILogger> connection::_logger = nullptr;
 
 void connection::set_logger(std::shared_ptr<ILogger>&& logger)
@@ -19,17 +293,23 @@ void connection::set_logger(std::shared_ptr<ILogger>&& logger)
 
 connection::connection(const settings& settings, const bool needCreateDatabaseIfNotExist, const int retryCount, const int retryDeltaSeconds)
     : IConnection(settings)
+    , _statement_cache(settings.statement_cache_size, [this](prepared_statement& statement) { deallocate(statement.name); })
 {
+    // Задержка между попытками растёт от 100 мс до retryDeltaSeconds
+    exponential_backoff backoff(std::chrono::milliseconds(100), std::chrono::seconds(retryDeltaSeconds));
+
     for(int i = 0; i < retryCount; i++) {
         try {
             connect(settings);
         } catch(...){}
 
-        if(is_valid()) {
+        if(is_alive()) {
             return;
         }
 
-        std::this_thread::sleep_for(std::chrono::seconds(retryDeltaSeconds));
+        if(i + 1 < retryCount) {
+            std::this_thread::sleep_for(backoff.next_delay());
+        }
     }
 
     if(!needCreateDatabaseIfNotExist) {
@@ -59,47 +339,332 @@ bool connection::is_valid()
     return IConnection::is_valid();
 }
 
+bool connection::is_alive() const
+{
+    // PQstatus возвращает состояние, которое libpq запомнила после последней операции, без обращения к серверу
+    return _connection != nullptr && PQstatus(_connection) == CONNECTION_OK;
+}
+
 query_result connection::exec(const std::string& query)
 {
-    if(_logger != nullptr) {
-        _logger->log_sql(query);
+    return exec_prepared(query, {});
+}
+
+query_result connection::exec_prepared(const std::string& query, const std::vector<std::string>& params)
+{
+    flush_deferred();
+
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql(params.empty() ? query : query + " with params: " + params_to_string(params));
+    }
+
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for(const auto& param : params) {
+        values.emplace_back(param == NULL_VALUE ? nullptr : param.c_str());
+    }
+
+    return exec_params(query, static_cast<int>(values.size()), values.data(), nullptr, nullptr);
+}
+
+query_result connection::exec_typed(const std::string& query, const bind_parameters& params)
+{
+    flush_deferred();
+
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql(params.empty() ? query : query + " with params: " + params_to_string(params));
+    }
+
+    _param_values.clear();
+    _param_lengths.clear();
+    _param_formats.clear();
+    _param_offsets.clear();
+    _param_buffer.clear();
+
+    for(const auto& param : params) {
+        const char* value = nullptr;
+        int length = 0;
+        int format = 0;
+        size_t offset = std::string::npos;
+
+        switch(param.type()) {
+            case bind_parameter::value_type::null:
+                break;
+            case bind_parameter::value_type::integer:
+            case bind_parameter::value_type::real: {
+                char number[bind_parameter::max_number_length];
+                offset = _param_buffer.size();
+                _param_buffer.append(number, param.format_number(number)).push_back('\0');
+                break;
+            }
+            case bind_parameter::value_type::text:
+                // Размер текстовых параметров libpq не учитывает, поэтому текст без завершающего нуля копируется
+                if(param.is_null_terminated()) {
+                    value = param.data();
+                } else {
+                    offset = _param_buffer.size();
+                    _param_buffer.append(param.data(), param.size()).push_back('\0');
+                }
+                break;
+            case bind_parameter::value_type::blob:
+                value = param.data();
+                length = static_cast<int>(param.size());
+                format = 1;
+                break;
+        }
+
+        _param_values.push_back(value);
+        _param_lengths.push_back(length);
+        _param_formats.push_back(format);
+        _param_offsets.push_back(offset);
+    }
+
+    // Указатели на буфер вычисляются после его заполнения, так как при росте буфер перемещается
+    for(size_t i = 0; i < _param_offsets.size(); i++) {
+        if(_param_offsets[i] != std::string::npos) {
+            _param_values[i] = _param_buffer.data() + _param_offsets[i];
+        }
+    }
+
+    return exec_params(query, static_cast<int>(_param_values.size()), _param_values.data(), _param_lengths.data(), _param_formats.data());
+}
+
+query_result connection::exec_params(const std::string& query, const int count, const char* const* values, const int* lengths, const int* formats)
+{
+    const auto key = _statement_cache.enabled() ? normalize_sql(query) : std::string();
+    const bool use_cache = _statement_cache.enabled() && is_cacheable_statement(key);
+
+    PGresult* query_result = nullptr;
+    if(use_cache) {
+        const auto& statement = cached_statement(key, query);
+        query_result = PQexecPrepared(_connection, statement.name.c_str(), count, values, lengths, formats, has_binary_result(statement) ? 1 : 0);
+    } else if(count == 0) {
+        // PQexec позволяет выполнить несколько запросов за раз, что недоступно для запросов с параметрами
+        query_result = PQexec(_connection, query.c_str());
+    } else {
+        query_result = PQexecParams(_connection, query.c_str(), count, nullptr, values, lengths, formats, 0);
     }
 
-    auto* query_result = PQexec(_connection, query.c_str());
     if(PQresultStatus(query_result) != PGRES_TUPLES_OK && PQresultStatus(query_result) != PGRES_COMMAND_OK) {
+        if(use_cache && is_stale_statement_error(query_result)) {
+            _statement_cache.erase(key);
+        }
+
         PQclear(query_result);
 
         std::string last_error = "Failed to execute statement: ";
         last_error.append(PQerrorMessage(_connection));
 
-        if(_logger != nullptr) {
+        if(is_log_enabled(_logger, log_level::error)) {
             _logger->log_error(last_error);
         }
 
         throw sql_exception(std::move(last_error), query);
     }
 
-    const auto rows = PQntuples(query_result);
-    const auto cols = PQnfields(query_result);
+    auto result = read_rows(query_result);
 
-    database_adapter::query_result result;
-    for(int i = 0; i < rows; i++) {
-        query_result::row row;
-        for(int j = 0; j < cols; j++) {
-            auto* column_value = PQgetvalue(query_result, i, j);
-            row.emplace(PQfname(query_result, j), column_value == nullptr ? "" : column_value);
+    PQclear(query_result);
+
+    return result;
+}
+
+void connection::exec_stream(const std::string& query, const std::vector<std::string>& params, const row_callback& callback)
+{
+    flush_deferred();
+
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql(params.empty() ? query : query + " with params: " + params_to_string(params));
+    }
+
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for(const auto& param : params) {
+        values.emplace_back(param == NULL_VALUE ? nullptr : param.c_str());
+    }
+
+    const auto is_sent = params.empty()
+        ? PQsendQuery(_connection, query.c_str())
+        : PQsendQueryParams(_connection, query.c_str(), static_cast<int>(values.size()), nullptr, values.data(), nullptr, nullptr, 0);
+
+    if(is_sent == 0) {
+        std::string last_error = "Failed to send statement: ";
+        last_error.append(PQerrorMessage(_connection));
+
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
         }
-        result.add(row);
+
+        throw sql_exception(std::move(last_error), query);
     }
 
-    PQclear(query_result);
+    // В режиме одной строки сервер отдаёт каждую строку отдельным PGresult, что позволяет не держать весь результат в памяти.
+    // Если режим включить не удалось, строки придут одним итоговым результатом и будут переданы в callback из него
+    if(PQsetSingleRowMode(_connection) == 0 && is_log_enabled(_logger, log_level::error)) {
+        _logger->log_error("Failed to enable single row mode, the result will be read at once");
+    }
 
-    return result;
+    query_result row;
+    std::string last_error;
+    std::exception_ptr callback_exception;
+
+    // Результаты нужно вычитать до конца, иначе соединение останется занятым текущим запросом
+    while(auto* pg_result = PQgetResult(_connection)) {
+        const auto status = PQresultStatus(pg_result);
+
+        if(status == PGRES_SINGLE_TUPLE || status == PGRES_TUPLES_OK) {
+            if(last_error.empty() && callback_exception == nullptr) {
+                try {
+                    stream_rows(pg_result, row, callback);
+                } catch(...) {
+                    callback_exception = std::current_exception();
+                    cancel();
+                }
+            }
+        } else if(status != PGRES_COMMAND_OK && last_error.empty() && callback_exception == nullptr) {
+            last_error = "Failed to execute statement: ";
+            last_error.append(PQresultErrorMessage(pg_result));
+        }
+
+        PQclear(pg_result);
+    }
+
+    if(callback_exception != nullptr) {
+        std::rethrow_exception(callback_exception);
+    }
+
+    if(!last_error.empty()) {
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error), query);
+    }
+}
+
+void connection::export_stream(const std::string& query, const row_callback& callback)
+{
+    flush_deferred();
+
+    query_result result(describe_columns(query));
+
+    // Завершающая точка с запятой недопустима внутри COPY (...)
+    auto select_end = query.find_last_not_of("; \t\r\n");
+    select_end = select_end == std::string::npos ? 0 : select_end + 1;
+
+    const auto copy_query = "COPY (" + query.substr(0, select_end) + ") TO STDOUT";
+
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql(copy_query);
+    }
+
+    auto* copy_result = PQexec(_connection, copy_query.c_str());
+    if(PQresultStatus(copy_result) != PGRES_COPY_OUT) {
+        PQclear(copy_result);
+
+        std::string last_error = "Failed to start copy: ";
+        last_error.append(PQerrorMessage(_connection));
+
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error), query);
+    }
+    PQclear(copy_result);
+
+    std::string value;
+    std::string last_error;
+    std::exception_ptr callback_exception;
+
+    // В текстовом формате libpq возвращает ровно одну строку таблицы за вызов
+    char* buffer = nullptr;
+    int size = 0;
+    while((size = PQgetCopyData(_connection, &buffer, 0)) > 0) {
+        if(callback_exception == nullptr) {
+            try {
+                result.clear();
+                append_copy_row(buffer, static_cast<size_t>(size), value, result);
+
+                if(result.size() != 1) {
+                    throw sql_exception("Copy row doesn't match result columns", query);
+                }
+
+                callback(result[0]);
+            } catch(...) {
+                callback_exception = std::current_exception();
+                cancel();
+            }
+        }
+
+        PQfreemem(buffer);
+    }
+
+    if(size == -2) {
+        last_error = "Failed to copy data: ";
+        last_error.append(PQerrorMessage(_connection));
+    }
+
+    // Завершение COPY сопровождается итоговым результатом, который нужно вычитать
+    while(auto* pg_result = PQgetResult(_connection)) {
+        if(PQresultStatus(pg_result) != PGRES_COMMAND_OK && last_error.empty()) {
+            last_error = "Failed to execute statement: ";
+            last_error.append(PQresultErrorMessage(pg_result));
+        }
+
+        PQclear(pg_result);
+    }
+
+    if(callback_exception != nullptr) {
+        std::rethrow_exception(callback_exception);
+    }
+
+    if(!last_error.empty()) {
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error), query);
+    }
+}
+
+std::vector<query_result::column_name> connection::describe_columns(const std::string& query)
+{
+    // Неименованный подготовленный запрос заменяется следующим, поэтому его не нужно освобождать
+    auto* prepare_result = PQprepare(_connection, "", query.c_str(), 0, nullptr);
+    const auto is_prepared = PQresultStatus(prepare_result) == PGRES_COMMAND_OK;
+    PQclear(prepare_result);
+
+    auto* describe_result = is_prepared ? PQdescribePrepared(_connection, "") : nullptr;
+    if(!is_prepared || PQresultStatus(describe_result) != PGRES_COMMAND_OK) {
+        PQclear(describe_result);
+
+        std::string last_error = "Failed to describe statement: ";
+        last_error.append(PQerrorMessage(_connection));
+
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error), query);
+    }
+
+    std::vector<query_result::column_name> columns;
+    columns.reserve(PQnfields(describe_result));
+    for(int i = 0; i < PQnfields(describe_result); i++) {
+        columns.emplace_back(PQfname(describe_result, i));
+    }
+
+    PQclear(describe_result);
+
+    return columns;
 }
 
 void connection::prepare(const std::string& query, const std::string& name)
 {
-    if(_logger != nullptr) {
+    flush_deferred();
+
+    if(is_log_enabled(_logger, log_level::sql)) {
         _logger->log_sql("Prepare query " + name + " sql: " + query);
     }
     auto* query_result = PQprepare(_connection, name.c_str(), query.c_str(), 0, nullptr);
@@ -110,7 +675,7 @@ void connection::prepare(const std::string& query, const std::string& name)
         std::string last_error = "Failed to prepare statement: ";
         last_error.append(PQerrorMessage(_connection));
 
-        if(_logger != nullptr) {
+        if(is_log_enabled(_logger, log_level::error)) {
             _logger->log_error(last_error);
         }
 
@@ -120,70 +685,574 @@ void connection::prepare(const std::string& query, const std::string& name)
 
 query_result connection::exec_prepared(const std::vector<std::string>& params, const std::string& name)
 {
-    auto transform = [](const std::vector<std::string>& params) {
-        auto** transform_params = new char*[params.size()];
+    flush_deferred();
+
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql("Execute prepare query " + name + " with params: " + params_to_string(params));
+    }
+
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for(const auto& param : params) {
+        values.emplace_back(param == NULL_VALUE ? nullptr : param.c_str());
+    }
+
+    auto* query_result = PQexecPrepared(_connection, name.c_str(), static_cast<int>(values.size()), values.data(), nullptr, nullptr, 0);
+    if(PQresultStatus(query_result) != PGRES_TUPLES_OK && PQresultStatus(query_result) != PGRES_COMMAND_OK) {
+        PQclear(query_result);
+
+        std::string last_error = "Failed to execute prepared statement: ";
+        last_error.append(PQerrorMessage(_connection));
+
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error));
+    }
+
+    auto result = read_rows(query_result);
+
+    PQclear(query_result);
+
+    return result;
+}
+
+std::vector<query_result> connection::exec_batch(const std::vector<batch_statement>& statements)
+{
+    flush_deferred();
+
+    // Для одного запроса конвейер не сокращает количество обменов с сервером
+    if(statements.size() < 2) {
+        return IConnection::exec_batch(statements);
+    }
+
+    std::vector<query_result> results(statements.size());
+    for(size_t begin = 0; begin < statements.size(); begin += pipeline_size) {
+        exec_pipeline(statements, begin, std::min(begin + pipeline_size, statements.size()), results);
+    }
+
+    return results;
+}
+
+void connection::exec_pipeline(const std::vector<batch_statement>& statements, const size_t begin, const size_t end, std::vector<query_result>& results)
+{
+    /// Вид команды конвейера
+    enum class command_type
+    {
+        prepare,
+        describe,
+        execute
+    };
+
+    /// Команда отправленная в конвейер, результаты приходят в порядке отправки
+    struct pipeline_command
+    {
+        size_t statement = 0;
+        command_type type = command_type::execute;
+        /// Ключ кэша подготовленных запросов, пустой если кэш не используется
+        std::string key {};
+    };
+
+    if(PQenterPipelineMode(_connection) == 0) {
+        std::string last_error = "Failed to enter pipeline mode: ";
+        last_error.append(PQerrorMessage(_connection));
+
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error));
+    }
+
+    std::vector<pipeline_command> commands;
+    commands.reserve((end - begin) * 3);
+
+    // Запросы подготовленные в этом конвейере добавляются в кэш только после выхода из него,
+    // так как вытеснение из кэша освобождает запрос на сервере через PQexec, недоступный в режиме конвейера
+    std::unordered_map<std::string, prepared_statement> prepared_names;
+    // Ключи запросов, подготовку которых подтвердил сервер. Только они попадают в кэш
+    std::unordered_set<std::string> created_names;
+
+    std::string last_error;
+    std::string error_query;
+
+    for(size_t i = begin; i < end && last_error.empty(); i++) {
+        const auto& statement = statements[i];
 
-        for(int i = 0; i < params.size(); i++) {
-            if(params[i] == NULL_VALUE) {
-                transform_params[i] = nullptr;
-            } else {
-                auto* target_param = new char[params[i].size()];
-                for(int j = 0; j < params[i].size(); j++) {
-                    target_param[j] = params[i].at(j);
+        if(is_log_enabled(_logger, log_level::sql)) {
+            _logger->log_sql(statement.params.empty() ? statement.query : statement.query + " with params: " + params_to_string(statement.params));
+        }
+
+        std::vector<const char*> values;
+        values.reserve(statement.params.size());
+        for(const auto& param : statement.params) {
+            values.emplace_back(param == NULL_VALUE ? nullptr : param.c_str());
+        }
+
+        auto key = _statement_cache.enabled() ? normalize_sql(statement.query) : std::string();
+        if(!key.empty() && !is_cacheable_statement(key)) {
+            key.clear();
+        }
+
+        // Команда учитывается только после успешной отправки, иначе ответы сервера сопоставятся не тем командам.
+        // После первой неудачной отправки следующие команды не отправляются
+        const auto send = [&commands, i](const int is_sent, const command_type type, const std::string& command_key) {
+            if(is_sent != 0) {
+                commands.push_back({ i, type, command_key });
+            }
+
+            return is_sent != 0;
+        };
+
+        bool is_sent = true;
+        if(!key.empty()) {
+            const prepared_statement* prepared = _statement_cache.find(key);
+            // Формат результата запроса, подготовленного в этом конвейере, станет известен только из его описания
+            const int result_format = prepared != nullptr && has_binary_result(*prepared) ? 1 : 0;
+
+            if(prepared == nullptr) {
+                auto prepared_it = prepared_names.find(key);
+                if(prepared_it == prepared_names.end()) {
+                    const auto name = "entity_craft_" + std::to_string(++_statement_counter);
+
+                    is_sent = send(PQsendPrepare(_connection, name.c_str(), statement.query.c_str(), 0, nullptr), command_type::prepare, key);
+                    if(is_sent) {
+                        prepared_it = prepared_names.emplace(key, prepared_statement { name }).first;
+                        is_sent = send(PQsendDescribePrepared(_connection, name.c_str()), command_type::describe, key);
+                    }
                 }
-                transform_params[i] = target_param;
+                prepared = is_sent ? &prepared_it->second : nullptr;
             }
+
+            if(is_sent) {
+                is_sent = send(PQsendQueryPrepared(_connection, prepared->name.c_str(), static_cast<int>(values.size()), values.data(), nullptr, nullptr, result_format),
+                    command_type::execute,
+                    key);
+            }
+        } else {
+            // Простой протокол PQsendQuery в режиме конвейера недоступен
+            is_sent = send(PQsendQueryParams(_connection, statement.query.c_str(), static_cast<int>(values.size()), nullptr, values.data(), nullptr, nullptr, 0),
+                command_type::execute,
+                key);
         }
 
-        return transform_params;
-    };
+        if(!is_sent) {
+            last_error = "Failed to send statement: ";
+            last_error.append(PQerrorMessage(_connection));
+            error_query = statement.query;
+        }
+    }
+
+    bool is_synced = false;
+    if(PQpipelineSync(_connection) != 0) {
+        size_t position = 0;
+        int empty_results = 0;
+
+        // Результат каждой команды завершается nullptr, два nullptr подряд означают, что ответов больше не будет
+        while(empty_results < 2) {
+            auto* pg_result = PQgetResult(_connection);
+            if(pg_result == nullptr) {
+                empty_results++;
+                position++;
+                continue;
+            }
+            empty_results = 0;
+
+            const auto status = PQresultStatus(pg_result);
+            if(status == PGRES_PIPELINE_SYNC) {
+                PQclear(pg_result);
+                is_synced = true;
+                break;
+            }
 
-    if(_logger != nullptr) {
-        _logger->log_sql([&name, &params]() {
-            std::stringstream stream;
+            if(position < commands.size()) {
+                const auto& command = commands[position];
 
-            stream << "Execute prepare query " << name << " with params: [ ";
-            for(const auto& param : params) {
-                stream << param << " ";
+                // После ошибки сервер пропускает команды до конца конвейера, для них приходит PGRES_PIPELINE_ABORTED.
+                // Пропущенная подготовка не создала запрос на сервере, поэтому он не должен попасть в кэш
+                if(status == PGRES_PIPELINE_ABORTED) {
+                    if(command.type != command_type::execute) {
+                        prepared_names.erase(command.key);
+                    }
+                } else if(status != PGRES_TUPLES_OK && status != PGRES_COMMAND_OK) {
+                    if(last_error.empty()) {
+                        last_error = command.type == command_type::execute ? "Failed to execute statement: " : "Failed to prepare statement: ";
+                        last_error.append(PQresultErrorMessage(pg_result));
+                        error_query = statements[command.statement].query;
+                    }
+
+                    if(command.type != command_type::execute) {
+                        prepared_names.erase(command.key);
+                    } else if(!command.key.empty() && prepared_names.count(command.key) == 0 && is_stale_statement_error(pg_result)) {
+                        _statement_cache.erase(command.key);
+                    }
+                } else if(command.type == command_type::prepare) {
+                    created_names.insert(command.key);
+                } else if(command.type == command_type::describe) {
+                    const auto prepared_it = prepared_names.find(command.key);
+                    if(prepared_it != prepared_names.end()) {
+                        prepared_it->second.described = true;
+                        prepared_it->second.column_types = result_types(pg_result);
+                    }
+                } else if(command.type == command_type::execute) {
+                    results[command.statement] = read_rows(pg_result);
+                }
             }
-            stream << "]";
 
-            return stream.str();
-        }());
+            PQclear(pg_result);
+        }
     }
 
-    auto* query_result = PQexecPrepared(_connection, name.c_str(), params.size(), transform(params), nullptr, nullptr, 0);
-    if(PQresultStatus(query_result) != PGRES_TUPLES_OK && PQresultStatus(query_result) != PGRES_COMMAND_OK) {
-        PQclear(query_result);
+    if(!is_synced && last_error.empty()) {
+        last_error = "Failed to execute pipeline: ";
+        last_error.append(PQerrorMessage(_connection));
+    }
 
-        std::string last_error = "Failed to execute prepared statement: ";
+    if(PQexitPipelineMode(_connection) == 0 && last_error.empty()) {
+        last_error = "Failed to exit pipeline mode: ";
         last_error.append(PQerrorMessage(_connection));
+    }
 
-        if(_logger != nullptr) {
+    // Без синхронизации неизвестно, какие запросы успели подготовиться на сервере
+    if(is_synced) {
+        for(auto& prepared_pair : prepared_names) {
+            if(created_names.count(prepared_pair.first) != 0) {
+                _statement_cache.insert(prepared_pair.first, std::move(prepared_pair.second));
+            }
+        }
+    }
+
+    if(!last_error.empty()) {
+        if(is_log_enabled(_logger, log_level::error)) {
             _logger->log_error(last_error);
         }
 
-        throw sql_exception(std::move(last_error));
+        throw sql_exception(std::move(last_error), error_query);
+    }
+}
+
+query_result connection::bulk_insert(const std::string& table, const std::vector<std::string>& columns, const row_source& next_row, const std::vector<std::string>& returning)
+{
+    flush_deferred();
+
+    if(columns.empty()) {
+        throw std::invalid_argument("bulk insert without columns");
+    }
+
+    const auto column_list = columns_to_string(columns);
+
+    if(returning.empty()) {
+        copy_from_stdin("COPY " + table + " (" + column_list + ") FROM STDIN", columns.size(), next_row);
+        return {};
+    }
+
+    // До PostgreSQL 17 запрос вставки не может вернуть колонку исходной таблицы, поэтому сопоставить вставленные строки
+    // с исходными по порядковому номеру нельзя и строки вставляются пачками INSERT ... VALUES
+    if(PQserverVersion(_connection) < 170000) {
+        return IConnection::bulk_insert(table, columns, next_row, returning);
+    }
+
+    // COPY не возвращает значений, поэтому строки проходят через временную таблицу с порядковым номером строки.
+    // Имя таблицы уникально для соединения, поэтому вложенная вставка и таблица неудачной вставки не мешают друг другу
+    const std::string temp_table = std::string("pg_temp.\"") + bulk_insert_table + std::to_string(++_bulk_insert_counter) + "\"";
+    exec("CREATE TEMP TABLE " + temp_table + " AS SELECT " + column_list + " FROM " + table + " WITH NO DATA");
+
+    query_result result;
+
+    try {
+        exec("ALTER TABLE " + temp_table + " ADD COLUMN \"" + bulk_insert_order_column + "\" bigserial");
+        copy_from_stdin("COPY " + temp_table + " (" + column_list + ") FROM STDIN", columns.size(), next_row);
+
+        result = order_by_ordinal(exec(bulk_insert_merge_sql(table, temp_table, columns, bulk_insert_order_column, returning)));
+    } catch(...) {
+        // В прерванной транзакции удалить таблицу нельзя, она будет удалена откатом транзакции
+        try {
+            exec("DROP TABLE IF EXISTS " + temp_table);
+        } catch(...) {
+        }
+
+        throw;
+    }
+
+    exec("DROP TABLE " + temp_table);
+
+    return result;
+}
+
+void connection::copy_from_stdin(const std::string& query, const size_t column_count, const row_source& next_row)
+{
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql(query);
+    }
+
+    auto* copy_result = PQexec(_connection, query.c_str());
+    if(PQresultStatus(copy_result) != PGRES_COPY_IN) {
+        PQclear(copy_result);
+
+        std::string last_error = "Failed to start copy: ";
+        last_error.append(PQerrorMessage(_connection));
+
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error), query);
+    }
+    PQclear(copy_result);
+
+    std::string buffer;
+    buffer.reserve(copy_buffer_size * 2);
+
+    std::string last_error;
+    std::exception_ptr row_exception;
+    size_t rows = 0;
+
+    try {
+        std::vector<std::string> row;
+        row.reserve(column_count);
+
+        while(true) {
+            row.clear();
+            if(!next_row(row)) {
+                break;
+            }
+
+            if(row.size() != column_count) {
+                throw std::invalid_argument("bulk insert row size doesn't match columns");
+            }
+
+            for(size_t i = 0; i < row.size(); i++) {
+                if(i != 0) {
+                    buffer.push_back('\t');
+                }
+                append_copy_value(buffer, row[i]);
+            }
+            buffer.push_back('\n');
+            rows++;
+
+            if(buffer.size() >= copy_buffer_size) {
+                if(PQputCopyData(_connection, buffer.data(), static_cast<int>(buffer.size())) != 1) {
+                    break;
+                }
+                buffer.clear();
+            }
+        }
+    } catch(...) {
+        row_exception = std::current_exception();
+    }
+
+    // Ошибка передачи данных сохраняется в соединении и будет получена из результата COPY
+    if(row_exception == nullptr && !buffer.empty()) {
+        PQputCopyData(_connection, buffer.data(), static_cast<int>(buffer.size()));
+    }
+
+    // Сообщение об ошибке отменяет COPY на сервере, уже переданные строки не вставляются
+    PQputCopyEnd(_connection, row_exception == nullptr ? nullptr : "bulk insert is aborted by client");
+
+    while(auto* pg_result = PQgetResult(_connection)) {
+        if(PQresultStatus(pg_result) != PGRES_COMMAND_OK && last_error.empty()) {
+            last_error = "Failed to copy data: ";
+            last_error.append(PQresultErrorMessage(pg_result));
+        }
+
+        PQclear(pg_result);
+    }
+
+    if(row_exception != nullptr) {
+        std::rethrow_exception(row_exception);
+    }
+
+    if(!last_error.empty()) {
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error), query);
     }
 
-    const auto rows = PQntuples(query_result);
-    const auto cols = PQnfields(query_result);
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql("Copied rows: " + std::to_string(rows));
+    }
+}
+
+query_result connection::read_rows(PGresult* pg_result)
+{
+    const auto rows = PQntuples(pg_result);
+    const auto cols = PQnfields(pg_result);
 
-    database_adapter::query_result result;
+    size_t bytes = 0;
     for(int i = 0; i < rows; i++) {
-        query_result::row row;
         for(int j = 0; j < cols; j++) {
-            auto* column_value = PQgetvalue(query_result, i, j);
-            row.emplace(PQfname(query_result, j), column_value == nullptr ? "" : column_value);
+            bytes += PQgetlength(pg_result, i, j);
         }
-        result.add(row);
     }
 
-    PQclear(query_result);
+    query_result result;
+    read_columns(pg_result, result);
+    result.reserve(rows, bytes);
+
+    append_rows(pg_result, result);
 
     return result;
 }
 
+void connection::read_columns(PGresult* pg_result, query_result& result)
+{
+    const auto cols = PQnfields(pg_result);
+
+    // Имена колонок одинаковы для всех строк, поэтому получаем их один раз на запрос
+    std::vector<query_result::column_name> columns;
+    columns.reserve(cols);
+    for(int j = 0; j < cols; j++) {
+        columns.emplace_back(PQfname(pg_result, j));
+    }
+    result.set_columns(std::move(columns));
+}
+
+void connection::append_rows(PGresult* pg_result, query_result& result)
+{
+    const auto rows = PQntuples(pg_result);
+    const auto cols = PQnfields(pg_result);
+
+    // Формат и тип колонок одинаковы для всех строк, поэтому получаем их один раз
+    std::vector<Oid> binary_types(cols, InvalidOid);
+    for(int j = 0; j < cols; j++) {
+        if(PQfformat(pg_result, j) == 1) {
+            binary_types[j] = PQftype(pg_result, j);
+        }
+    }
+
+    for(int i = 0; i < rows; i++) {
+        for(int j = 0; j < cols; j++) {
+            if(PQgetisnull(pg_result, i, j)) {
+                result.add_null();
+                continue;
+            }
+
+            if(binary_types[j] != InvalidOid) {
+                append_binary_value(binary_types[j], PQgetvalue(pg_result, i, j), PQgetlength(pg_result, i, j), result);
+                continue;
+            }
+
+            result.add_value(PQgetvalue(pg_result, i, j), PQgetlength(pg_result, i, j));
+        }
+    }
+}
+
+std::vector<Oid> connection::result_types(PGresult* description)
+{
+    const auto cols = PQnfields(description);
+
+    std::vector<Oid> types;
+    types.reserve(cols);
+    for(int j = 0; j < cols; j++) {
+        types.emplace_back(PQftype(description, j));
+    }
+
+    return types;
+}
+
+bool connection::has_binary_result(const prepared_statement& statement) const
+{
+    if(!statement.described) {
+        return false;
+    }
+
+    const auto settings = make_binary_format_settings(PQparameterStatus(_connection, "DateStyle"),
+        PQparameterStatus(_connection, "TimeZone"),
+        PQparameterStatus(_connection, "integer_datetimes"),
+        PQserverVersion(_connection));
+
+    for(const auto type : statement.column_types) {
+        if(!has_binary_decoder(type, settings)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void connection::cancel()
+{
+    auto* cancel = PQgetCancel(_connection);
+    if(cancel == nullptr) {
+        return;
+    }
+
+    char error[256];
+    if(PQcancel(cancel, error, sizeof(error)) == 0 && is_log_enabled(_logger, log_level::error)) {
+        _logger->log_error(std::string("Failed to cancel query: ") + error);
+    }
+
+    PQfreeCancel(cancel);
+}
+
+statement_cache_stats connection::cache_stats() const
+{
+    return _statement_cache.stats();
+}
+
+const connection::prepared_statement& connection::cached_statement(const std::string& key, const std::string& query)
+{
+    auto* cached_statement = _statement_cache.find(key);
+    if(cached_statement != nullptr) {
+        return *cached_statement;
+    }
+
+    prepared_statement statement { "entity_craft_" + std::to_string(++_statement_counter) };
+
+    auto* prepare_result = PQprepare(_connection, statement.name.c_str(), query.c_str(), 0, nullptr);
+    if(PQresultStatus(prepare_result) != PGRES_COMMAND_OK) {
+        PQclear(prepare_result);
+
+        std::string last_error = "Failed to prepare statement: ";
+        last_error.append(PQerrorMessage(_connection));
+
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error), query);
+    }
+
+    PQclear(prepare_result);
+
+    // Бинарный формат запрашивается для всего результата, поэтому он используется, только если все колонки можно декодировать.
+    // При ошибке описания запрос выполняется с текстовым результатом
+    auto* describe_result = PQdescribePrepared(_connection, statement.name.c_str());
+    if(PQresultStatus(describe_result) == PGRES_COMMAND_OK) {
+        statement.described = true;
+        statement.column_types = result_types(describe_result);
+    }
+    PQclear(describe_result);
+
+    return _statement_cache.insert(key, std::move(statement));
+}
+
+void connection::deallocate(const std::string& name)
+{
+    // После отключения запросы на сервере уже освобождены
+    if(_connection == nullptr || PQstatus(_connection) != CONNECTION_OK) {
+        return;
+    }
+
+    // Ошибка освобождения не критична: имена запросов не переиспользуются
+    auto* deallocate_result = PQexec(_connection, ("DEALLOCATE \"" + name + "\"").c_str());
+    PQclear(deallocate_result);
+}
+
+bool connection::numbered_placeholders() const
+{
+    return true;
+}
+
+size_t connection::max_bind_parameters() const
+{
+    // Количество параметров в протоколе передаётся 16-битным числом
+    return 65535;
+}
+
 bool connection::open_transaction(int type)
 {
     const auto sql = [&type]() -> std::string {
@@ -222,20 +1291,39 @@ void connection::connect(const settings& settings)
         return connection_info.str();
     }();
 
-    _connection = PQconnectdb(connection_info.c_str());
+    // Запросы подготовленные в предыдущем подключении не существуют в новом
+    _statement_cache.clear();
 
-    if(_logger != nullptr) {
+    if(is_log_enabled(_logger, log_level::sql)) {
         _logger->log_sql("Connect to database with param: " + connection_info);
     }
 
-    if(PQstatus(_connection) != CONNECTION_OK) {
+    // Неблокирующее подключение позволяет ограничить время ожидания connect_timeout, а не таймаутами TCP
+    _connection = PQconnectStart(connection_info.c_str());
+
+    std::string poll_error = _connection == nullptr ? "can't allocate connection" : "";
+    if(_connection != nullptr && PQstatus(_connection) != CONNECTION_BAD) {
+        const auto deadline = std::chrono::steady_clock::now() + settings.connect_timeout;
+
+        auto status = PGRES_POLLING_WRITING;
+        while(status != PGRES_POLLING_OK && status != PGRES_POLLING_FAILED) {
+            if(!wait_socket(PQsocket(_connection), status == PGRES_POLLING_READING, deadline)) {
+                poll_error = "connection timeout expired";
+                break;
+            }
+
+            status = PQconnectPoll(_connection);
+        }
+    }
+
+    if(_connection == nullptr || !poll_error.empty() || PQstatus(_connection) != CONNECTION_OK) {
         std::string last_error = "Can't open database. settings: " + connection_info + "; error: ";
-        last_error.append(PQerrorMessage(_connection));
+        last_error.append(poll_error.empty() ? PQerrorMessage(_connection) : poll_error);
 
         PQfinish(_connection);
         _connection = nullptr;
 
-        if(_logger != nullptr) {
+        if(is_log_enabled(_logger, log_level::error)) {
             _logger->log_error(last_error);
         }
 
@@ -245,15 +1333,18 @@ void connection::connect(const settings& settings)
 
 void connection::disconnect()
 {
-    if(!is_valid())
+    // Разорванное соединение тоже должно быть закрыто, иначе PGconn не будет освобождён
+    if(_connection == nullptr)
         return;
 
-    if(_logger != nullptr) {
+    if(is_log_enabled(_logger, log_level::sql)) {
         _logger->log_sql("Disconnect from database");
     }
 
     PQfinish(_connection);
     _connection = nullptr;
+
+    _statement_cache.clear();
 }
 
 } // namespace postgre
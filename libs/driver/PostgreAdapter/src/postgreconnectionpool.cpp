@@ -7,22 +7,30 @@ database_connection_settings connection_pool::connection_settings {};
 
 size_t connection_pool::start_pool_size = 2;
 size_t connection_pool::max_pool_size = 10;
-std::chrono::seconds connection_pool::wait_time = std::chrono::seconds(2);
+std::chrono::milliseconds connection_pool::wait_time = std::chrono::seconds(2);
+pool_health_settings connection_pool::health_settings {};
+connection_pool::metrics_callback connection_pool::metrics_reporter = nullptr;
+std::chrono::milliseconds connection_pool::metrics_interval = std::chrono::seconds(60);
 
 std::shared_ptr<connection_pool> connection_pool::instance()
 {
-    static auto pool = std::make_shared<connection_pool>(connection_settings, start_pool_size, max_pool_size, wait_time);
-    return pool;
-}
+    static auto pool = []() {
+        auto pool = std::make_shared<connection_pool>(connection_settings, start_pool_size, max_pool_size, wait_time);
+        pool->set_health_settings(health_settings);
+        pool->set_metrics_callback(metrics_reporter, metrics_interval);
+        return pool;
+    }();
 
-connection_pool::connection_pool(database_connection_settings settings, const size_t start_pool_size, const size_t max_pool_size, std::chrono::seconds wait_time)
-    : IConnectionPool(std::move(settings), start_pool_size, max_pool_size, wait_time)
-{
+    return pool;
 }
 
-std::shared_ptr<IConnection> connection_pool::create_connection(const database_connection_settings& settings)
+connection_pool::connection_pool(database_connection_settings settings, const size_t start_pool_size, const size_t max_pool_size, const std::chrono::milliseconds wait_time)
+    : IConnectionPool([](const database_connection_settings& settings) { return std::make_shared<connection>(settings); },
+          std::move(settings),
+          start_pool_size,
+          max_pool_size,
+          wait_time)
 {
-    return std::make_shared<connection>(settings);
 }
 
 } // namespace postgre
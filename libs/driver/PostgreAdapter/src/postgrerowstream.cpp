@@ -0,0 +1,35 @@
+#include "PostgreAdapter/postgrerowstream.h"
+
+namespace database_adapter {
+namespace postgre {
+
+void stream_rows(const PGresult* pg_result, query_result& row, const IConnection::row_callback& callback)
+{
+    const auto rows = PQntuples(pg_result);
+    const auto cols = PQnfields(pg_result);
+
+    if(row.columns().empty()) {
+        std::vector<query_result::column_name> columns;
+        columns.reserve(cols);
+        for(int j = 0; j < cols; j++) {
+            columns.emplace_back(PQfname(pg_result, j));
+        }
+        row.set_columns(std::move(columns));
+    }
+
+    for(int i = 0; i < rows; i++) {
+        row.clear();
+        for(int j = 0; j < cols; j++) {
+            if(PQgetisnull(pg_result, i, j)) {
+                row.add_null();
+            } else {
+                row.add_value(PQgetvalue(pg_result, i, j), PQgetlength(pg_result, i, j));
+            }
+        }
+
+        callback(row[0]);
+    }
+}
+
+} // namespace postgre
+} // namespace database_adapter
@@ -2,6 +2,8 @@
 
 #include "sqliteconnection.h"
 #include "sqliteconnectionpool.h"
+#include "sqlitereadwritepool.h"
 #include "sqlitetransactiontype.h"
+#include "sqlitetuning.h"
 
 #include <DatabaseAdapter/databaseadapter.h>
\ No newline at end of file
@@ -2,11 +2,13 @@
 #define SQLITE_API // Гарантирует статическую линковку для sqlite3
 
 #include "sqliteadapter_global.h"
+#include "sqlitetuning.h"
 
 #include <DatabaseAdapter/iconnection.h>
 #include <DatabaseAdapter/ilogger.h>
 #include <sqlite3.h>
 
+#include <functional>
 #include <memory>
 
 namespace database_adapter {
@@ -28,28 +30,125 @@ public:
     static void set_logger(std::shared_ptr<ILogger>&& logger);
 
 public:
-    explicit connection(const settings& settings);
+    /**
+     * @brief Открывает соединение и применяет к нему профиль настройки
+     * @param settings Настройки подключения
+     * @param tuning Профиль настройки соединения
+     * @throws open_database_exception Выбрасывает исключение в случае ошибки открытия базы или применения профиля
+     */
+    explicit connection(const settings& settings, const tuning& tuning = {});
     ~connection() override;
 
     bool is_valid() override;
+    bool is_alive() const override;
     query_result exec(const std::string& query) override;
+    using IConnection::exec_stream;
+    void exec_stream(const std::string& query, const std::vector<std::string>& params, const row_callback& callback) override;
 
     void prepare(const std::string& query, const std::string& name) override;
     query_result exec_prepared(const std::vector<std::string>& params, const std::string& name) override;
+    query_result exec_prepared(const std::string& query, const std::vector<std::string>& params) override;
+    query_result exec_typed(const std::string& query, const bind_parameters& params) override;
+
+    bool numbered_placeholders() const override;
+    size_t max_bind_parameters() const override;
 
     bool open_transaction(int type) override;
 
+    /**
+     * @brief Открыта ли транзакция на соединении
+     * @note В отличие от is_transaction учитывает транзакции, открытые запросами BEGIN или SAVEPOINT напрямую
+     */
+    bool in_transaction() const;
+
+    statement_cache_stats cache_stats() const override;
+
 private:
-    void connect(const settings& settings);
+    /// @brief Подготовленный запрос вместе с именами колонок его результата
+    struct prepared_statement
+    {
+        sqlite3_stmt* stmt = nullptr;
+        /// @brief Имена колонок, общие для результатов всех выполнений запроса
+        query_result::shared_columns columns {};
+    };
+
+private:
+    void connect(const settings& settings, const tuning& tuning);
     void disconnect();
 
+    /**
+     * @brief Применяет профиль настройки к открытому соединению
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения PRAGMA
+     */
+    void apply_tuning(const tuning& tuning);
+
+    /**
+     * @brief Подготавливает запрос к выполнению
+     * @param query SQL-запрос
+     * @param persistent Флаг означающий, что запрос будет переиспользоваться
+     * @return Подготовленный запрос, который должен быть освобождён через sqlite3_finalize
+     * @throws sql_exception Выбрасывает исключение в случае ошибки подготовки запроса
+     */
+    sqlite3_stmt* prepare_statement(const std::string& query, bool persistent);
+
+    /**
+     * @brief Привязывает значения параметров к подготовленному запросу
+     * @param stmt Подготовленный запрос
+     * @param params Значения параметров, значение NULL_VALUE привязывается как NULL
+     * @throws std::invalid_argument Если значений больше чем параметров в запросе
+     */
+    static void bind_params(sqlite3_stmt* stmt, const std::vector<std::string>& params);
+
+    /**
+     * @brief Привязывает типизированные значения параметров к подготовленному запросу без преобразования в текст
+     * @param stmt Подготовленный запрос
+     * @param params Значения параметров. Текст и бинарные данные привязываются без копирования
+     * @throws std::invalid_argument Если значений больше чем параметров в запросе
+     */
+    static void bind_params(sqlite3_stmt* stmt, const bind_parameters& params);
+
+    /**
+     * @brief Выполняет запрос через кэш подготовленных запросов
+     * @param query SQL-запрос
+     * @param bind Функция привязки значений параметров к подготовленному запросу
+     * @return Результат выполнения SQL-запроса.
+     * @throws sql_exception Выбрасывает исключение в случае ошибки выполнения запроса
+     */
+    query_result exec_cached(const std::string& query, const std::function<void(sqlite3_stmt*)>& bind);
+
+    /**
+     * @brief Пошагово выполняет подготовленный запрос и складывает полученные строки в результат
+     * @param statement Подготовленный запрос, имена колонок которого сохраняются для следующих выполнений
+     * @param result Результат, в который будут добавлены строки
+     * @return Код возврата последнего вызова sqlite3_step
+     */
+    static int read_rows(prepared_statement& statement, query_result& result);
+
+    /**
+     * @brief Задаёт результату имена колонок подготовленного запроса
+     * @param stmt Подготовленный запрос
+     * @param columns Ранее полученные имена колонок запроса, обновляются если не совпадают с текущими
+     * @param result Результат, которому будут заданы колонки
+     */
+    static void read_columns(sqlite3_stmt* stmt, query_result::shared_columns& columns, query_result& result);
+
+    /**
+     * @brief Добавляет в результат значения текущей строки подготовленного запроса
+     * @param stmt Подготовленный запрос, для которого sqlite3_step вернул SQLITE_ROW
+     * @param result Результат, в который будет добавлена строка
+     */
+    static void read_row(sqlite3_stmt* stmt, query_result& result);
+
 private:
     static std::shared_ptr<ILogger> _logger;
 
 private:
     sqlite3* _connection = nullptr;
 
-    std::unordered_map<std::string, sqlite3_stmt*> _prepared;
+    std::unordered_map<std::string, prepared_statement> _prepared;
+
+    /// @brief Кэш запросов выполняемых через exec
+    statement_cache<prepared_statement> _statement_cache;
 };
 } // namespace sqlite
 } // namespace database_adapter
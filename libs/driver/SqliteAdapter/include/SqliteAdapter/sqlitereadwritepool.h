@@ -0,0 +1,53 @@
+#pragma once
+
+#include "sqliteadapter_global.h"
+#include "sqliteconnectionpool.h"
+#include "sqlitetuning.h"
+
+#include <chrono>
+#include <memory>
+
+namespace database_adapter {
+namespace sqlite {
+
+/**
+ * @brief Пул с одним соединением на запись и несколькими соединениями только для чтения
+ * @note Соединения пула работают в режиме WAL, поэтому чтение не блокируется записью.
+ * Соединение на запись выдаётся потокам по очереди, что исключает SQLITE_BUSY между пишущими соединениями.
+ * База данных в памяти не поддерживается, так как у каждого соединения она своя
+ */
+class SQLITE_EXPORT read_write_pool
+{
+public:
+    /**
+     * @brief Конструктор, который открывает соединение на запись и переводит базу в режим WAL
+     * @param settings Настройки подключения
+     * @param reader_count Количество соединений только для чтения
+     * @param wait_time Максимальное время ожидания свободного соединения
+     * @param tuning Профиль настройки соединений, режим журнала всегда WAL
+     * @throws open_database_exception Выбрасывает исключение в случае ошибки открытия базы
+     */
+    explicit read_write_pool(database_connection_settings settings, size_t reader_count = 4, std::chrono::milliseconds wait_time = std::chrono::seconds(2), tuning tuning = tuning::throughput());
+
+    /**
+     * @brief Получить соединение, которое само выбирает соединение пула для каждого запроса
+     * @note Запросы SELECT выполняются на соединениях для чтения, остальные запросы - на соединении для записи.
+     * Соединение пула берётся только на время выполнения запроса, а при открытии транзакции - до её завершения.
+     * Все запросы внутри транзакции, включая чтение, выполняются на соединении для записи
+     */
+    std::shared_ptr<IConnection> open_connection();
+
+    /// @brief Пул из одного соединения для записи
+    std::shared_ptr<connection_pool> writer_pool() const;
+
+    /// @brief Пул соединений только для чтения
+    std::shared_ptr<connection_pool> reader_pool() const;
+
+private:
+    database_connection_settings _settings;
+    std::shared_ptr<connection_pool> _writer;
+    std::shared_ptr<connection_pool> _readers;
+};
+
+} // namespace sqlite
+} // namespace database_adapter
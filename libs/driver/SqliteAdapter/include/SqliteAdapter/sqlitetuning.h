@@ -0,0 +1,87 @@
+#pragma once
+
+#include "sqliteadapter_global.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace database_adapter {
+namespace sqlite {
+
+/// Режим журнала транзакций (PRAGMA journal_mode)
+enum class journal_mode : uint8_t
+{
+    UNCHANGED = 0, ///< Режим базы данных не изменяется
+    DELETE_ON_COMMIT, ///< DELETE, режим sqlite по умолчанию
+    TRUNCATE,
+    PERSIST,
+    MEMORY,
+    WAL,
+    OFF
+};
+
+/// Уровень синхронизации с диском (PRAGMA synchronous)
+enum class synchronous_mode : uint8_t
+{
+    UNCHANGED = 0, ///< Уровень по умолчанию
+    OFF,
+    NORMAL,
+    FULL,
+    EXTRA
+};
+
+/// Место хранения временных таблиц и индексов (PRAGMA temp_store)
+enum class temp_store_mode : uint8_t
+{
+    UNCHANGED = 0, ///< Определяется параметрами сборки sqlite
+    DISK,
+    MEMORY
+};
+
+/// Режим многопоточности соединения (флаги открытия базы данных)
+enum class threading_mode : uint8_t
+{
+    UNCHANGED = 0, ///< Определяется параметрами сборки sqlite
+    MULTI_THREAD, ///< SQLITE_OPEN_NOMUTEX: соединение используется одним потоком за раз
+    SERIALIZED ///< SQLITE_OPEN_FULLMUTEX: соединение защищено мьютексом sqlite
+};
+
+/**
+ * @brief Профиль настройки соединения sqlite, применяется при открытии каждого соединения
+ * @note Значения по умолчанию ничего не изменяют
+ */
+struct SQLITE_EXPORT tuning
+{
+    /// @brief Режим журнала транзакций
+    journal_mode journal = journal_mode::UNCHANGED;
+    /// @brief Уровень синхронизации с диском
+    synchronous_mode synchronous = synchronous_mode::UNCHANGED;
+    /// @brief Максимальный размер файла базы данных в байтах, отображаемый в память. 0 - отключено, -1 - не изменять
+    int64_t mmap_size = -1;
+    /// @brief Размер кэша страниц: положительное значение в страницах, отрицательное в КиБ. 0 - не изменять
+    int64_t cache_size = 0;
+    /// @brief Место хранения временных таблиц и индексов
+    temp_store_mode temp_store = temp_store_mode::UNCHANGED;
+    /// @brief Время ожидания снятия блокировки другим соединением. 0 - не ожидать
+    std::chrono::milliseconds busy_timeout = std::chrono::milliseconds(0);
+    /// @brief Режим многопоточности соединения
+    threading_mode threading = threading_mode::UNCHANGED;
+    /// @brief Открыть существующую базу только для чтения (SQLITE_OPEN_READONLY)
+    /// @note Режим журнала и размер страницы такому соединению не задаются
+    bool read_only = false;
+    /// @brief Размер страницы новой базы данных в байтах. 0 - не изменять
+    /// @note Для существующей базы размер страницы не меняется
+    int page_size = 0;
+
+    /**
+     * @brief Профиль для максимальной производительности записи
+     * @note WAL и synchronous NORMAL: при сбое питания могут потеряться последние транзакции, но база остаётся целостной
+     */
+    static tuning throughput();
+
+    /// @brief Профиль, при котором подтверждённая транзакция не теряется даже при сбое питания
+    static tuning durable();
+};
+
+} // namespace sqlite
+} // namespace database_adapter
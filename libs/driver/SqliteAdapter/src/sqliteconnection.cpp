@@ -4,12 +4,37 @@
 
 #include <DatabaseAdapter/databaseadapter.h>
 
-#include <sstream>
 #include <stdexcept>
 
 namespace database_adapter {
 namespace sqlite {
 
+namespace {
+
+/// Проверка совпадают ли имена колонок подготовленного запроса с ранее полученными, без выделения памяти
+bool has_same_columns(sqlite3_stmt* stmt, const query_result::shared_columns& columns)
+{
+    if(columns == nullptr) {
+        return false;
+    }
+
+    const auto column_count = sqlite3_column_count(stmt);
+    if(columns->names.size() != static_cast<size_t>(column_count)) {
+        return false;
+    }
+
+    for(int i = 0; i < column_count; i++) {
+        const auto* name = sqlite3_column_name(stmt, i);
+        if(name == nullptr || columns->names[i] != name) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
 std::shared_ptr<ILogger> connection::_logger = nullptr;
 
 void connection::set_logger(std::shared_ptr<ILogger>&& logger)
@@ -17,16 +42,20 @@ void connection::set_logger(std::shared_ptr<ILogger>&& logger)
     _logger = std::move(logger);
 }
 
-connection::connection(const settings& settings)
+connection::connection(const settings& settings, const tuning& tuning)
     : IConnection(settings)
+    , _statement_cache(settings.statement_cache_size, [](prepared_statement& statement) { sqlite3_finalize(statement.stmt); })
 {
-    connect(settings);
+    connect(settings, tuning);
 }
 
 connection::~connection()
 {
+    // Все запросы должны быть освобождены до закрытия базы, иначе sqlite3_close вернёт SQLITE_BUSY
+    _statement_cache.clear();
+
     for(const auto& prepared_pair : _prepared) {
-        sqlite3_finalize(prepared_pair.second);
+        sqlite3_finalize(prepared_pair.second.stmt);
     }
     _prepared.clear();
 
@@ -41,159 +70,358 @@ bool connection::is_valid()
     return IConnection::is_valid();
 }
 
+bool connection::is_alive() const
+{
+    return _connection != nullptr;
+}
+
+bool connection::in_transaction() const
+{
+    return _connection != nullptr && sqlite3_get_autocommit(_connection) == 0;
+}
+
 query_result connection::exec(const std::string& query)
 {
-    using namespace database_adapter;
-    sqlite3_stmt* stmt;
+    return exec_prepared(query, {});
+}
+
+query_result connection::exec_prepared(const std::string& query, const std::vector<std::string>& params)
+{
+    flush_deferred();
 
-    if(_logger != nullptr) {
-        _logger->log_sql(query);
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql(params.empty() ? query : query + " with params: " + params_to_string(params));
     }
 
-    if(sqlite3_prepare_v2(_connection, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        std::string last_error = "Failed to prepare statement: ";
-        last_error.append(sqlite3_errmsg(_connection));
+    return exec_cached(query, [&params](sqlite3_stmt* stmt) { bind_params(stmt, params); });
+}
 
-        sqlite3_finalize(stmt);
+query_result connection::exec_typed(const std::string& query, const bind_parameters& params)
+{
+    flush_deferred();
 
-        if(_logger != nullptr) {
-            _logger->log_error(last_error);
-        }
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql(params.empty() ? query : query + " with params: " + params_to_string(params));
+    }
 
-        throw sql_exception(std::move(last_error), query);
+    return exec_cached(query, [&params](sqlite3_stmt* stmt) { bind_params(stmt, params); });
+}
+
+query_result connection::exec_cached(const std::string& query, const std::function<void(sqlite3_stmt*)>& bind)
+{
+    const bool use_cache = _statement_cache.enabled();
+
+    prepared_statement uncached;
+    prepared_statement* statement = nullptr;
+
+    const auto key = use_cache ? normalize_sql(query) : std::string();
+    if(use_cache) {
+        statement = _statement_cache.find(key);
     }
 
-    int rc = sqlite3_step(stmt);
+    if(statement == nullptr) {
+        uncached.stmt = prepare_statement(query, use_cache);
+        statement = use_cache && uncached.stmt != nullptr ? &_statement_cache.insert(key, uncached) : &uncached;
+    }
 
-    query_result result;
-    while(rc == SQLITE_ROW) {
-        query_result::row row;
-        for(int i = 0; i < sqlite3_column_count(stmt); i++) {
-            auto* column_name = sqlite3_column_name(stmt, i);
-            auto* column_value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+    const bool cached = statement != &uncached;
+    auto* stmt = statement->stmt;
 
-            row.emplace(column_name, column_value == nullptr ? "" : column_value);
+    try {
+        bind(stmt);
+    } catch(...) {
+        if(!cached) {
+            sqlite3_finalize(stmt);
         }
-        result.add(row);
-
-        rc = sqlite3_step(stmt);
+        throw;
     }
 
+    query_result result;
+    const int rc = read_rows(*statement, result);
+
+    std::string last_error;
     if(rc != SQLITE_DONE) {
-        std::string last_error = "Failed to execute statement: ";
+        last_error = "Failed to execute statement: ";
         last_error.append(sqlite3_errmsg(_connection));
+    }
 
+    // Закэшированный запрос сбрасывается, чтобы освободить блокировки и подготовить его к следующему вызову
+    if(cached) {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    } else {
         sqlite3_finalize(stmt);
+    }
 
-        if(_logger != nullptr) {
+    if(rc != SQLITE_DONE) {
+        if(is_log_enabled(_logger, log_level::error)) {
             _logger->log_error(last_error);
         }
 
         throw sql_exception(std::move(last_error), query);
     }
 
-    sqlite3_finalize(stmt);
-
     return result;
 }
 
-void connection::prepare(const std::string& query, const std::string& name)
+bool connection::numbered_placeholders() const
 {
-    if(_prepared.find(name) == _prepared.end())
-        return;
+    return false;
+}
 
-    sqlite3_stmt* stmt;
+size_t connection::max_bind_parameters() const
+{
+    if(_connection == nullptr) {
+        return IConnection::max_bind_parameters();
+    }
 
-    if(_logger != nullptr) {
-        _logger->log_sql("Prepare query " + name + " sql: " + query);
+    // Отрицательное значение только возвращает текущее ограничение, не изменяя его
+    return static_cast<size_t>(sqlite3_limit(_connection, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+}
+
+void connection::exec_stream(const std::string& query, const std::vector<std::string>& params, const row_callback& callback)
+{
+    flush_deferred();
+
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql(params.empty() ? query : query + " with params: " + params_to_string(params));
     }
 
-    if(sqlite3_prepare_v2(_connection, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        std::string last_error = "Failed to prepare statement: ";
+    // Кэш не используется, так как во время обработки строк этот же запрос может быть выполнен повторно
+    const std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)> stmt(prepare_statement(query, false), &sqlite3_finalize);
+    bind_params(stmt.get(), params);
+
+    int rc = sqlite3_step(stmt.get());
+
+    // В результате всегда хранится только текущая строка, память под неё переиспользуется
+    query_result result;
+    query_result::shared_columns columns;
+    read_columns(stmt.get(), columns, result);
+
+    while(rc == SQLITE_ROW) {
+        result.clear();
+        read_row(stmt.get(), result);
+
+        callback(result[0]);
+
+        rc = sqlite3_step(stmt.get());
+    }
+
+    if(rc != SQLITE_DONE) {
+        std::string last_error = "Failed to execute statement: ";
         last_error.append(sqlite3_errmsg(_connection));
 
-        if(_logger != nullptr) {
+        if(is_log_enabled(_logger, log_level::error)) {
             _logger->log_error(last_error);
         }
 
-        sqlite3_finalize(stmt);
-
         throw sql_exception(std::move(last_error), query);
     }
+}
+
+void connection::prepare(const std::string& query, const std::string& name)
+{
+    flush_deferred();
+
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql("Prepare query " + name + " sql: " + query);
+    }
+
+    auto* stmt = prepare_statement(query, true);
+
+    // Повторная подготовка под тем же именем заменяет ранее подготовленный запрос
+    const auto prepared_it = _prepared.find(name);
+    if(prepared_it != _prepared.end()) {
+        sqlite3_finalize(prepared_it->second.stmt);
+        _prepared.erase(prepared_it);
+    }
 
-    _prepared.insert({ name, stmt });
+    prepared_statement statement;
+    statement.stmt = stmt;
+    _prepared.insert({ name, std::move(statement) });
+}
+
+statement_cache_stats connection::cache_stats() const
+{
+    return _statement_cache.stats();
 }
 
 query_result connection::exec_prepared(const std::vector<std::string>& params, const std::string& name)
 {
+    flush_deferred();
+
     const auto stmt_it = _prepared.find(name);
     if(stmt_it == _prepared.end()) {
         throw sql_exception("Doesn't have prepared statment");
     }
 
-    auto* stmt = stmt_it->second;
+    auto* stmt = stmt_it->second.stmt;
 
     sqlite3_clear_bindings(stmt);
     sqlite3_reset(stmt);
 
-    const auto size = sqlite3_bind_parameter_count(stmt);
+    if(is_log_enabled(_logger, log_level::sql)) {
+        _logger->log_sql("Execute prepare query " + name + " with params: " + params_to_string(params));
+    }
 
-    if(params.size() > size) {
-        throw std::invalid_argument("binding values more that binding parameters");
+    bind_params(stmt, params);
+
+    query_result result;
+    const int rc = read_rows(stmt_it->second, result);
+
+    if(rc != SQLITE_DONE) {
+        std::string last_error = "Failed to execute statement: ";
+        last_error.append(sqlite3_errmsg(_connection));
+
+        if(is_log_enabled(_logger, log_level::error)) {
+            _logger->log_error(last_error);
+        }
+
+        throw sql_exception(std::move(last_error));
     }
 
-    if(_logger != nullptr) {
-        _logger->log_sql([&name, &params]() {
-            std::stringstream stream;
+    return result;
+}
 
-            stream << "Execute prepare query " << name << " with params: [ ";
-            for(const auto& param : params) {
-                stream << param << " ";
-            }
-            stream << "]";
+void connection::bind_params(sqlite3_stmt* stmt, const std::vector<std::string>& params)
+{
+    const auto size = static_cast<size_t>(sqlite3_bind_parameter_count(stmt));
 
-            return stream.str();
-        }());
+    if(params.size() > size) {
+        throw std::invalid_argument("binding values more that binding parameters");
     }
 
-    for(int i = 0; i < size; i++) {
+    for(size_t i = 0; i < params.size(); i++) {
+        // i + 1, так как в sqlite индекс параметров начинается с 1, а не с 0
+        const auto index = static_cast<int>(i + 1);
+
         if(params[i] == NULL_VALUE) {
-            sqlite3_bind_null(stmt, i);
+            sqlite3_bind_null(stmt, index);
             continue;
         }
 
-        // i + 1, так как в sqlite индекс параметров начинается с 1, а не с 0
-        sqlite3_bind_text(stmt, i + 1, params[i].c_str(), params[i].size(), SQLITE_STATIC);
+        sqlite3_bind_text(stmt, index, params[i].c_str(), static_cast<int>(params[i].size()), SQLITE_STATIC);
     }
+}
 
-    int rc = sqlite3_step(stmt);
+void connection::bind_params(sqlite3_stmt* stmt, const bind_parameters& params)
+{
+    const auto size = static_cast<size_t>(sqlite3_bind_parameter_count(stmt));
 
-    query_result result;
-    while(rc == SQLITE_ROW) {
-        query_result::row row;
-        for(int i = 0; i < sqlite3_column_count(stmt); i++) {
-            auto* column_name = sqlite3_column_name(stmt, i);
-            auto* column_value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+    if(params.size() > size) {
+        throw std::invalid_argument("binding values more that binding parameters");
+    }
 
-            row.emplace(column_name, column_value == nullptr ? "" : column_value);
+    for(size_t i = 0; i < params.size(); i++) {
+        // i + 1, так как в sqlite индекс параметров начинается с 1, а не с 0
+        const auto index = static_cast<int>(i + 1);
+        const auto& param = params[i];
+
+        switch(param.type()) {
+            case bind_parameter::value_type::null:
+                sqlite3_bind_null(stmt, index);
+                break;
+            case bind_parameter::value_type::integer:
+                sqlite3_bind_int64(stmt, index, param.as_int64());
+                break;
+            case bind_parameter::value_type::real:
+                sqlite3_bind_double(stmt, index, param.as_double());
+                break;
+            case bind_parameter::value_type::text:
+                sqlite3_bind_text(stmt, index, param.data(), static_cast<int>(param.size()), SQLITE_STATIC);
+                break;
+            case bind_parameter::value_type::blob:
+                sqlite3_bind_blob(stmt, index, param.data(), static_cast<int>(param.size()), SQLITE_STATIC);
+                break;
         }
-        result.add(row);
-
-        rc = sqlite3_step(stmt);
     }
+}
 
-    if(rc != SQLITE_DONE) {
-        std::string last_error = "Failed to execute statement: ";
+sqlite3_stmt* connection::prepare_statement(const std::string& query, const bool persistent)
+{
+    sqlite3_stmt* stmt = nullptr;
+
+    // SQLITE_PREPARE_PERSISTENT подсказывает sqlite, что запрос будет жить долго и его не стоит размещать в lookaside памяти
+    const unsigned int flags = persistent ? SQLITE_PREPARE_PERSISTENT : 0;
+    if(sqlite3_prepare_v3(_connection, query.c_str(), -1, flags, &stmt, nullptr) != SQLITE_OK) {
+        std::string last_error = "Failed to prepare statement: ";
         last_error.append(sqlite3_errmsg(_connection));
 
-        if(_logger != nullptr) {
+        sqlite3_finalize(stmt);
+
+        if(is_log_enabled(_logger, log_level::error)) {
             _logger->log_error(last_error);
         }
 
-        throw sql_exception(std::move(last_error));
+        throw sql_exception(std::move(last_error), query);
     }
 
-    return result;
+    return stmt;
+}
+
+int connection::read_rows(prepared_statement& statement, query_result& result)
+{
+    auto* stmt = statement.stmt;
+
+    // Колонки читаются после первого шага, так как после изменения схемы sqlite переподготавливает запрос именно в нём
+    int rc = sqlite3_step(stmt);
+    read_columns(stmt, statement.columns, result);
+
+    while(rc == SQLITE_ROW) {
+        read_row(stmt, result);
+        rc = sqlite3_step(stmt);
+    }
+
+    return rc;
+}
+
+void connection::read_columns(sqlite3_stmt* stmt, query_result::shared_columns& columns, query_result& result)
+{
+    // Имена колонок одинаковы для всех строк и всех выполнений запроса, поэтому формируются один раз.
+    // Проверка выполняется на каждом выполнении, так как после изменения схемы колонки запроса могут измениться
+    if(!has_same_columns(stmt, columns)) {
+        const auto column_count = sqlite3_column_count(stmt);
+
+        std::vector<query_result::column_name> names;
+        names.reserve(column_count);
+        for(int i = 0; i < column_count; i++) {
+            names.emplace_back(sqlite3_column_name(stmt, i));
+        }
+        columns = query_result::make_columns(std::move(names));
+    }
+
+    result.set_columns(columns);
+}
+
+void connection::read_row(sqlite3_stmt* stmt, query_result& result)
+{
+    const auto column_count = static_cast<int>(result.columns().size());
+    for(int i = 0; i < column_count; i++) {
+        // Числа забираются в исходном виде, чтобы sqlite не преобразовывал их в текст
+        switch(sqlite3_column_type(stmt, i)) {
+            case SQLITE_NULL:
+                result.add_null();
+                break;
+            case SQLITE_INTEGER:
+                result.add_int64(sqlite3_column_int64(stmt, i));
+                break;
+            case SQLITE_FLOAT:
+                result.add_double(sqlite3_column_double(stmt, i));
+                break;
+            case SQLITE_BLOB: {
+                // sqlite3_column_bytes нужно вызывать после получения значения, чтобы размер соответствовал его представлению
+                // Для пустого blob sqlite возвращает nullptr, но это не NULL
+                const auto* column_value = sqlite3_column_blob(stmt, i);
+                result.add_blob(column_value == nullptr ? "" : column_value, sqlite3_column_bytes(stmt, i));
+                break;
+            }
+            default: {
+                const auto* column_value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+                result.add_value(column_value, sqlite3_column_bytes(stmt, i));
+                break;
+            }
+        }
+    }
 }
 
 bool connection::open_transaction(int type)
@@ -220,33 +448,90 @@ bool connection::open_transaction(int type)
     }
 }
 
-void connection::connect(const database_connection_settings& settings)
+void connection::connect(const settings& settings, const tuning& tuning)
 {
-    if(_logger != nullptr) {
+    if(is_log_enabled(_logger, log_level::sql)) {
         _logger->log_sql("Connect to database by path: " + settings.url);
     }
 
-    if(sqlite3_open_v2(settings.url.c_str(), &_connection, SQLITE_OPEN_CREATE | SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK) {
+    int flags = tuning.read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_CREATE | SQLITE_OPEN_READWRITE;
+    switch(tuning.threading) {
+        case threading_mode::MULTI_THREAD:
+            flags |= SQLITE_OPEN_NOMUTEX;
+            break;
+        case threading_mode::SERIALIZED:
+            flags |= SQLITE_OPEN_FULLMUTEX;
+            break;
+        default:
+            break;
+    }
+
+    if(sqlite3_open_v2(settings.url.c_str(), &_connection, flags, nullptr) != SQLITE_OK) {
         std::string last_error = "Can't open database path: " + settings.url + "; ";
         last_error.append(sqlite3_errmsg(_connection));
 
         sqlite3_close(_connection);
         _connection = nullptr;
 
-        if(_logger != nullptr) {
+        if(is_log_enabled(_logger, log_level::error)) {
             _logger->log_error(last_error);
         }
 
         throw open_database_exception(std::move(last_error));
     }
+
+    try {
+        apply_tuning(tuning);
+    } catch(const sql_exception& exception) {
+        _statement_cache.clear();
+        disconnect();
+
+        throw open_database_exception("Can't apply tuning for database path: " + settings.url + "; " + exception.what());
+    }
+}
+
+void connection::apply_tuning(const tuning& tuning)
+{
+    // busy_timeout задаётся первым, так как смена режима журнала требует блокировки базы
+    if(tuning.busy_timeout.count() > 0) {
+        sqlite3_busy_timeout(_connection, static_cast<int>(tuning.busy_timeout.count()));
+    }
+
+    // Размер страницы применяется только к новой базе и только до перехода в WAL
+    if(tuning.page_size > 0 && !tuning.read_only) {
+        exec("PRAGMA page_size = " + std::to_string(tuning.page_size) + ";");
+    }
+
+    static const char* const journal_modes[] = { "", "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF" };
+    if(tuning.journal != journal_mode::UNCHANGED && !tuning.read_only) {
+        exec(std::string("PRAGMA journal_mode = ") + journal_modes[static_cast<size_t>(tuning.journal)] + ";");
+    }
+
+    static const char* const synchronous_modes[] = { "", "OFF", "NORMAL", "FULL", "EXTRA" };
+    if(tuning.synchronous != synchronous_mode::UNCHANGED) {
+        exec(std::string("PRAGMA synchronous = ") + synchronous_modes[static_cast<size_t>(tuning.synchronous)] + ";");
+    }
+
+    if(tuning.mmap_size >= 0) {
+        exec("PRAGMA mmap_size = " + std::to_string(tuning.mmap_size) + ";");
+    }
+
+    if(tuning.cache_size != 0) {
+        exec("PRAGMA cache_size = " + std::to_string(tuning.cache_size) + ";");
+    }
+
+    static const char* const temp_store_modes[] = { "DEFAULT", "FILE", "MEMORY" };
+    if(tuning.temp_store != temp_store_mode::UNCHANGED) {
+        exec(std::string("PRAGMA temp_store = ") + temp_store_modes[static_cast<size_t>(tuning.temp_store)] + ";");
+    }
 }
 
 void connection::disconnect()
 {
-    if(!is_valid())
+    if(_connection == nullptr)
         return;
 
-    if(_logger != nullptr) {
+    if(is_log_enabled(_logger, log_level::sql)) {
         _logger->log_sql("Disconnect from database");
     }
 
@@ -0,0 +1,265 @@
+#include "SqliteAdapter/sqlitereadwritepool.h"
+
+#include <DatabaseAdapter/databaseadapter.h>
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+namespace database_adapter {
+namespace sqlite {
+
+namespace {
+
+/**
+ * Проверка можно ли выполнить запрос на соединении только для чтения
+ * @note Проверяется только первое ключевое слово, поэтому WITH ... SELECT выполняется на соединении для записи
+ */
+bool is_read_statement(const std::string& query)
+{
+    const auto keyword_begin = std::find_if(query.begin(), query.end(), [](const unsigned char symbol) { return !std::isspace(symbol) && symbol != '('; });
+    const auto keyword_end = std::find_if(keyword_begin, query.end(), [](const unsigned char symbol) { return !std::isalpha(symbol); });
+
+    std::string keyword(keyword_begin, keyword_end);
+    std::transform(keyword.begin(), keyword.end(), keyword.begin(), [](const unsigned char symbol) { return static_cast<char>(std::toupper(symbol)); });
+
+    return keyword == "SELECT" || keyword == "VALUES";
+}
+
+/**
+ * Открыта ли транзакция на соединении пула
+ * @note Учитываются и транзакции, открытые запросами BEGIN или SAVEPOINT без open_transaction
+ */
+bool in_transaction(IConnection& connection)
+{
+    const auto* sqlite_connection = dynamic_cast<const sqlite::connection*>(&connection);
+    return sqlite_connection != nullptr ? sqlite_connection->in_transaction() : connection.is_transaction();
+}
+
+/**
+ * Соединение, которое выполняет каждый запрос на соединении из пула для чтения или для записи
+ * Соединение для записи закрепляется, пока на нём открыта транзакция, независимо от того, как она была открыта
+ */
+class routing_connection final : public IConnection
+{
+public:
+    routing_connection(const database_connection_settings& settings, std::shared_ptr<connection_pool> writer, std::shared_ptr<connection_pool> readers)
+        : IConnection(settings)
+        , _writer(std::move(writer))
+        , _readers(std::move(readers))
+    {
+    }
+
+    ~routing_connection() override
+    {
+        // Пул откатывает только транзакции из open_transaction, поэтому открытая запросом транзакция откатывается здесь
+        if(_transaction && in_transaction(*_transaction)) {
+            try {
+                _transaction->rollback();
+            } catch(...) {
+            }
+        }
+    }
+
+    query_result exec(const std::string& query) override
+    {
+        return exec_prepared(query, {});
+    }
+
+    void exec_stream(const std::string& query, const std::vector<std::string>& params, const row_callback& callback) override
+    {
+        flush_deferred();
+        route(is_read_statement(query), [&](IConnection& connection) { connection.exec_stream(query, params, callback); });
+    }
+
+    void export_stream(const std::string& query, const row_callback& callback) override
+    {
+        flush_deferred();
+        route(is_read_statement(query), [&](IConnection& connection) { connection.export_stream(query, callback); });
+    }
+
+    // Именованные запросы хранятся в соединении, поэтому всегда подготавливаются на единственном соединении для записи
+    void prepare(const std::string& query, const std::string& name) override
+    {
+        flush_deferred();
+        route(false, [&](IConnection& connection) { connection.prepare(query, name); });
+    }
+
+    query_result exec_prepared(const std::vector<std::string>& params, const std::string& name) override
+    {
+        flush_deferred();
+        return route(false, [&](IConnection& connection) { return connection.exec_prepared(params, name); });
+    }
+
+    query_result exec_prepared(const std::string& query, const std::vector<std::string>& params) override
+    {
+        flush_deferred();
+        return route(is_read_statement(query), [&](IConnection& connection) { return connection.exec_prepared(query, params); });
+    }
+
+    query_result exec_typed(const std::string& query, const bind_parameters& params) override
+    {
+        flush_deferred();
+        return route(is_read_statement(query), [&](IConnection& connection) { return connection.exec_typed(query, params); });
+    }
+
+    std::vector<query_result> exec_batch(const std::vector<batch_statement>& statements) override
+    {
+        flush_deferred();
+        return route(false, [&](IConnection& connection) { return connection.exec_batch(statements); });
+    }
+
+    query_result bulk_insert(const std::string& table, const std::vector<std::string>& columns, const row_source& next_row, const std::vector<std::string>& returning) override
+    {
+        flush_deferred();
+        return route(false, [&](IConnection& connection) { return connection.bulk_insert(table, columns, next_row, returning); });
+    }
+
+    size_t max_bind_parameters() const override
+    {
+        // Ограничение одинаково для всех соединений, поэтому запрашивается один раз
+        if(_max_bind_parameters == 0) {
+            const auto lease = _transaction ? connection_lease() : acquire(*_readers);
+            _max_bind_parameters = (_transaction ? *_transaction : *lease).max_bind_parameters();
+        }
+
+        return _max_bind_parameters;
+    }
+
+    bool open_transaction(const int type) override
+    {
+        flush_deferred();
+
+        return route(false, [type](IConnection& connection) { return connection.open_transaction(type); });
+    }
+
+    void commit() override
+    {
+        if(!_transaction) {
+            IConnection::commit();
+            return;
+        }
+
+        flush_deferred();
+        route(false, [](IConnection& connection) { connection.commit(); });
+    }
+
+    void rollback_to_save_point(const std::string& save_point) override
+    {
+        if(!_transaction) {
+            IConnection::rollback_to_save_point(save_point);
+            return;
+        }
+
+        clear_deferred();
+        route(false, [&save_point](IConnection& connection) { connection.rollback_to_save_point(save_point); });
+    }
+
+private:
+    /// Снимает закрепление соединения для записи после запроса, если транзакция на нём завершилась
+    class transaction_tracker
+    {
+    public:
+        explicit transaction_tracker(routing_connection& owner)
+            : _owner(owner)
+        {
+        }
+
+        transaction_tracker(const transaction_tracker& other) = delete;
+        transaction_tracker& operator=(const transaction_tracker& other) = delete;
+
+        ~transaction_tracker()
+        {
+            _owner._has_transaction = in_transaction(*_owner._transaction);
+            if(!_owner._has_transaction) {
+                _owner._transaction.release();
+            }
+        }
+
+    private:
+        routing_connection& _owner;
+    };
+
+    /**
+     * Выполняет действие на соединении открытой транзакции или на соединении из пула
+     * Запросы на запись выполняются на закреплённом соединении, которое остаётся закреплённым, если после запроса на нём открыта транзакция
+     * @param read Запрос только читает данные
+     * @param action Действие, которое принимает соединение
+     */
+    template<typename Action>
+    auto route(const bool read, Action&& action) -> decltype(action(std::declval<IConnection&>()))
+    {
+        if(!_transaction && read) {
+            // Соединение возвращается в пул при выходе из функции, в том числе после исключения
+            const auto lease = acquire(*_readers);
+            return action(*lease);
+        }
+
+        if(!_transaction) {
+            _transaction = acquire(*_writer);
+        }
+
+        // Проверка выполняется и после исключения, так как запрос мог открыть или завершить транзакцию до ошибки
+        const transaction_tracker tracker(*this);
+        return action(*_transaction);
+    }
+
+    /// Берёт соединение из пула, выбрасывает исключение если соединение не освободилось за время ожидания
+    static connection_lease acquire(connection_pool& pool)
+    {
+        auto lease = pool.acquire();
+        if(!lease) {
+            throw open_database_exception("Timed out waiting for a free sqlite connection");
+        }
+
+        return lease;
+    }
+
+private:
+    std::shared_ptr<connection_pool> _writer;
+    std::shared_ptr<connection_pool> _readers;
+
+    /// Соединение для записи, удерживаемое до завершения транзакции
+    connection_lease _transaction {};
+
+    mutable size_t _max_bind_parameters = 0;
+};
+
+} // namespace
+
+read_write_pool::read_write_pool(database_connection_settings settings, const size_t reader_count, const std::chrono::milliseconds wait_time, tuning tuning)
+    : _settings(std::move(settings))
+{
+    auto writer_tuning = tuning;
+    writer_tuning.journal = journal_mode::WAL;
+    writer_tuning.read_only = false;
+
+    auto reader_tuning = tuning;
+    reader_tuning.read_only = true;
+
+    _writer = std::make_shared<connection_pool>(_settings, 1, 1, wait_time, writer_tuning);
+    _readers = std::make_shared<connection_pool>(_settings, reader_count, std::max<size_t>(reader_count, 1), wait_time, reader_tuning);
+
+    // Соединения для чтения не могут создать базу и включить WAL, поэтому база подготавливается соединением для записи
+    if(!_writer->acquire()) {
+        throw open_database_exception("Timed out waiting for a sqlite writer connection");
+    }
+}
+
+std::shared_ptr<IConnection> read_write_pool::open_connection()
+{
+    return std::make_shared<routing_connection>(_settings, _writer, _readers);
+}
+
+std::shared_ptr<connection_pool> read_write_pool::writer_pool() const
+{
+    return _writer;
+}
+
+std::shared_ptr<connection_pool> read_write_pool::reader_pool() const
+{
+    return _readers;
+}
+
+} // namespace sqlite
+} // namespace database_adapter
@@ -0,0 +1,32 @@
+#include "SqliteAdapter/sqlitetuning.h"
+
+namespace database_adapter {
+namespace sqlite {
+
+tuning tuning::throughput()
+{
+    tuning profile;
+    profile.journal = journal_mode::WAL;
+    profile.synchronous = synchronous_mode::NORMAL;
+    profile.mmap_size = 256ll * 1024 * 1024;
+    profile.cache_size = -64 * 1024;
+    profile.temp_store = temp_store_mode::MEMORY;
+    profile.busy_timeout = std::chrono::seconds(5);
+    // Соединение из пула используется одним потоком за раз, поэтому мьютекс sqlite не нужен
+    profile.threading = threading_mode::MULTI_THREAD;
+    profile.page_size = 4096;
+    return profile;
+}
+
+tuning tuning::durable()
+{
+    tuning profile;
+    profile.journal = journal_mode::WAL;
+    profile.synchronous = synchronous_mode::FULL;
+    profile.busy_timeout = std::chrono::seconds(5);
+    profile.threading = threading_mode::SERIALIZED;
+    return profile;
+}
+
+} // namespace sqlite
+} // namespace database_adapter
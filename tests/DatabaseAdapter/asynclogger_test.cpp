@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <DatabaseAdapter/asynclogger.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+/// Логгер, запоминающий полученные сообщения
+class recording_logger final : public database_adapter::ILogger
+{
+public:
+    void log_error(const std::string& message) override
+    {
+        messages.push_back("error: " + message);
+    }
+
+    void log_sql(const std::string& message) override
+    {
+        messages.push_back("sql: " + message);
+    }
+
+    std::vector<std::string> messages;
+};
+} // namespace
+
+// Test for delivering messages to the sink in order
+TEST(AsyncLoggerTest, DeliversMessagesInOrder)
+{
+    auto sink = std::make_shared<recording_logger>();
+    database_adapter::async_logger logger(sink, 4);
+
+    for(int i = 0; i < 3; i++) {
+        logger.log_sql(std::to_string(i));
+    }
+    logger.log_error("failed");
+    logger.flush();
+
+    const std::vector<std::string> expected { "sql: 0", "sql: 1", "sql: 2", "error: failed" };
+    EXPECT_EQ(sink->messages, expected);
+}
+
+// Test for skipping messages below the logger level
+TEST(AsyncLoggerTest, SkipsDisabledLevels)
+{
+    auto sink = std::make_shared<recording_logger>();
+    database_adapter::async_logger logger(sink, 4, database_adapter::log_level::error);
+
+    EXPECT_FALSE(logger.is_enabled(database_adapter::log_level::sql));
+    EXPECT_TRUE(logger.is_enabled(database_adapter::log_level::error));
+
+    logger.log_sql("SELECT 1");
+    logger.log_error("failed");
+    logger.flush();
+
+    const std::vector<std::string> expected { "error: failed" };
+    EXPECT_EQ(sink->messages, expected);
+}
+
+// Test for collecting messages from several threads without losing them
+TEST(AsyncLoggerTest, CollectsMessagesFromThreads)
+{
+    auto sink = std::make_shared<recording_logger>();
+
+    {
+        database_adapter::async_logger logger(sink, 1024);
+
+        std::vector<std::thread> threads;
+        for(int i = 0; i < 4; i++) {
+            threads.emplace_back([&logger]() {
+                for(int j = 0; j < 100; j++) {
+                    logger.log_sql("SELECT 1");
+                }
+            });
+        }
+
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(logger.dropped(), 0);
+    }
+
+    EXPECT_EQ(sink->messages.size(), 400);
+}
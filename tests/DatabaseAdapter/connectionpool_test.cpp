@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+#include <DatabaseAdapter/databaseadapter.h>
+
+#include <atomic>
+#include <thread>
+
+namespace {
+class test_connection final : public database_adapter::IConnection
+{
+public:
+    explicit test_connection(const database_adapter::database_connection_settings& settings)
+        : IConnection(settings)
+    {
+    }
+
+    database_adapter::query_result exec(const std::string& /*query*/) override
+    {
+        return {};
+    }
+
+    void prepare(const std::string& /*query*/, const std::string& /*name*/) override
+    {
+    }
+
+    database_adapter::query_result exec_prepared(const std::vector<std::string>& /*params*/, const std::string& /*name*/) override
+    {
+        return {};
+    }
+
+    bool open_transaction(int /*type*/) override
+    {
+        _has_transaction = true;
+        return true;
+    }
+
+    bool is_alive() const override
+    {
+        return alive;
+    }
+
+    bool is_valid() override
+    {
+        std::this_thread::sleep_for(validate_delay);
+        return alive;
+    }
+
+    std::atomic<bool> alive { true };
+    std::chrono::milliseconds validate_delay { 0 };
+};
+
+/// Состояние фабрики соединений тестового пула. Принадлежит фабрике, поэтому переживает остановку потоков пула
+struct test_factory
+{
+    std::atomic<size_t> created { 0 };
+    std::chrono::milliseconds create_delay { 0 };
+};
+
+class test_pool final : public database_adapter::IConnectionPool
+{
+public:
+    test_pool(const size_t start_pool_size, const size_t max_pool_size)
+        : test_pool(std::make_shared<test_factory>(), start_pool_size, max_pool_size)
+    {
+    }
+
+    std::atomic<size_t>& created;
+    std::chrono::milliseconds& create_delay;
+
+private:
+    test_pool(const std::shared_ptr<test_factory>& factory, const size_t start_pool_size, const size_t max_pool_size)
+        : IConnectionPool([factory](const database_adapter::database_connection_settings& settings) -> std::shared_ptr<database_adapter::IConnection> {
+            std::this_thread::sleep_for(factory->create_delay);
+
+            factory->created++;
+            return std::make_shared<test_connection>(settings);
+        },
+              {},
+              start_pool_size,
+              max_pool_size,
+              std::chrono::milliseconds(0))
+        , created(factory->created)
+        , create_delay(factory->create_delay)
+    {
+    }
+};
+} // namespace
+
+// Test for returning a leased connection to the pool on destruction
+TEST(ConnectionPoolTest, LeaseReturnsConnection)
+{
+    test_pool pool(1, 1);
+
+    database_adapter::IConnection* first = nullptr;
+    {
+        const auto lease = pool.acquire();
+        ASSERT_TRUE(lease);
+        first = lease.get();
+
+        EXPECT_FALSE(pool.acquire());
+    }
+
+    const auto lease = pool.acquire();
+    EXPECT_EQ(lease.get(), first);
+    EXPECT_EQ(pool.created, 1);
+}
+
+// Test for growing the pool up to the maximum size and timing out afterwards
+TEST(ConnectionPoolTest, GrowsUpToMaxPoolSize)
+{
+    test_pool pool(1, 2);
+
+    const auto first = pool.open_connection();
+    const auto second = pool.open_connection();
+
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(pool.open_connection(), nullptr);
+    EXPECT_EQ(pool.created, 2);
+}
+
+// Test for handing a released connection to a waiting thread
+TEST(ConnectionPoolTest, WaiterReceivesReleasedConnection)
+{
+    test_pool pool(1, 1);
+
+    auto lease = pool.acquire();
+    ASSERT_TRUE(lease);
+
+    std::atomic<bool> received { false };
+    std::thread waiter([&pool, &received]() {
+        received = static_cast<bool>(pool.acquire(std::chrono::seconds(10)));
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    lease.release();
+    waiter.join();
+
+    EXPECT_TRUE(received);
+    EXPECT_EQ(pool.created, 1);
+}
+
+// Test for replacing a broken idle connection on checkout without a round trip
+TEST(ConnectionPoolTest, BrokenConnectionIsReplaced)
+{
+    test_pool pool(1, 1);
+
+    {
+        const auto lease = pool.acquire();
+        ASSERT_TRUE(lease);
+        static_cast<test_connection*>(lease.get())->alive = false;
+    }
+
+    const auto lease = pool.acquire();
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(lease->is_alive());
+    EXPECT_EQ(pool.created, 2);
+}
+
+// Test for closing idle connections after the idle timeout while keeping min_idle of them
+TEST(ConnectionPoolTest, HealthCheckKeepsMinIdle)
+{
+    test_pool pool(3, 3);
+
+    database_adapter::pool_health_settings settings;
+    settings.validation_interval = std::chrono::milliseconds(10);
+    settings.idle_timeout = std::chrono::milliseconds(1);
+    settings.min_idle = 1;
+    pool.set_health_settings(settings);
+
+    {
+        const auto first = pool.acquire();
+        const auto second = pool.acquire();
+        const auto third = pool.acquire();
+        ASSERT_TRUE(first && second && third);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const auto first = pool.acquire();
+    const auto second = pool.acquire();
+    ASSERT_TRUE(first && second);
+    EXPECT_EQ(pool.created, 4);
+}
+
+// Test for leasing an idle connection while the health check validates another one
+TEST(ConnectionPoolTest, LeaseDuringValidation)
+{
+    test_pool pool(2, 2);
+
+    {
+        const auto first = pool.acquire();
+        const auto second = pool.acquire();
+        ASSERT_TRUE(first && second);
+        static_cast<test_connection*>(first.get())->validate_delay = std::chrono::milliseconds(500);
+        static_cast<test_connection*>(second.get())->validate_delay = std::chrono::milliseconds(500);
+    }
+
+    database_adapter::pool_health_settings settings;
+    settings.validation_interval = std::chrono::milliseconds(20);
+    pool.set_health_settings(settings);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto lease = pool.acquire(std::chrono::seconds(10));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(lease);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(200));
+    EXPECT_EQ(pool.created, 2);
+}
+
+// Test for counting checkouts, timeouts and rollbacks of leaked transactions
+TEST(ConnectionPoolTest, Metrics)
+{
+    test_pool pool(1, 1);
+
+    {
+        const auto lease = pool.acquire();
+        ASSERT_TRUE(lease);
+        lease->open_base_transaction();
+
+        EXPECT_FALSE(pool.acquire());
+
+        const auto metrics = pool.metrics();
+        EXPECT_EQ(metrics.active, 1);
+        EXPECT_EQ(metrics.idle, 0);
+        EXPECT_EQ(metrics.total, 1);
+    }
+
+    const auto metrics = pool.metrics();
+    EXPECT_EQ(metrics.active, 0);
+    EXPECT_EQ(metrics.idle, 1);
+    EXPECT_EQ(metrics.checkouts, 1);
+    EXPECT_EQ(metrics.timeouts, 1);
+    EXPECT_EQ(metrics.creations, 1);
+    EXPECT_EQ(metrics.leaked_transaction_rollbacks, 1);
+    EXPECT_EQ(metrics.wait_histogram.count(), 2);
+}
+
+// Test for creating start connections in parallel and returning once the minimum is ready
+TEST(ConnectionPoolTest, ParallelWarmUp)
+{
+    test_pool pool(4, 4);
+    pool.create_delay = std::chrono::milliseconds(200);
+    pool.set_warm_up_min_ready(1);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto lease = pool.acquire(std::chrono::seconds(10));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(lease);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(600));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(pool.created, 4);
+    EXPECT_EQ(pool.metrics().idle, 3);
+}
+
+// Test for destroying a pool while background threads are still creating connections
+TEST(ConnectionPoolTest, DestroyDuringWarmUp)
+{
+    auto pool = std::make_shared<test_pool>(4, 4);
+    pool->create_delay = std::chrono::milliseconds(100);
+    pool->set_warm_up_min_ready(1);
+
+    auto lease = pool->acquire(std::chrono::seconds(10));
+    ASSERT_TRUE(lease);
+
+    pool.reset();
+
+    // Соединение, выданное до уничтожения пула, остаётся рабочим и закрывается при возврате
+    EXPECT_TRUE(lease->is_alive());
+    lease.release();
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <DatabaseAdapter/databaseadapter.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+/// Соединение, запоминающее выполненные запросы
+class recording_connection final : public database_adapter::IConnection
+{
+public:
+    recording_connection()
+        : IConnection({})
+    {
+    }
+
+    using IConnection::exec_prepared;
+
+    database_adapter::query_result exec(const std::string& query) override
+    {
+        return exec_prepared(query, {});
+    }
+
+    size_t max_bind_parameters() const override
+    {
+        return 4;
+    }
+
+    void prepare(const std::string& query, const std::string& /*name*/) override
+    {
+        _query = query;
+    }
+
+    database_adapter::query_result exec_prepared(const std::vector<std::string>& params, const std::string& /*name*/) override
+    {
+        executed.push_back(_query);
+        last_params = params;
+        return {};
+    }
+
+    bool open_transaction(int /*type*/) override
+    {
+        _has_transaction = true;
+        return true;
+    }
+
+    std::vector<std::string> executed;
+    std::vector<std::string> last_params;
+
+private:
+    std::string _query;
+};
+} // namespace
+
+// Test for executing deferred statements in order before the next statement
+TEST(ConnectionTest, DeferredStatementsRunBeforeNextQuery)
+{
+    recording_connection connection;
+
+    connection.exec_deferred("UPDATE A SET B = ?", { "1" });
+    connection.exec_deferred("UPDATE A SET B = ?", { "2" });
+    EXPECT_TRUE(connection.executed.empty());
+
+    connection.exec("SELECT 1");
+
+    const std::vector<std::string> expected { "UPDATE A SET B = ?", "UPDATE A SET B = ?", "SELECT 1" };
+    EXPECT_EQ(connection.executed, expected);
+
+    connection.flush_deferred();
+    EXPECT_EQ(connection.executed.size(), 3);
+}
+
+// Test for dropping deferred statements on rollback
+TEST(ConnectionTest, RollbackDropsDeferredStatements)
+{
+    recording_connection connection;
+    connection.open_transaction(0);
+
+    connection.exec_deferred("UPDATE A SET B = ?", { "1" });
+    connection.rollback();
+
+    const std::vector<std::string> expected { "ROLLBACK;" };
+    EXPECT_EQ(connection.executed, expected);
+}
+
+// Test for splitting bulk insert into statements within bind parameters limit
+TEST(ConnectionTest, BulkInsertRespectsBindLimit)
+{
+    recording_connection connection;
+
+    size_t rows = 0;
+    connection.bulk_insert("\"A\"", { "B", "C" }, [&rows](std::vector<std::string>& row) {
+        if(rows == 3) {
+            return false;
+        }
+
+        row = { std::to_string(rows), std::to_string(rows) };
+        rows++;
+        return true;
+    }, {});
+
+    const std::vector<std::string> expected {
+        "INSERT INTO \"A\" (\"B\", \"C\") VALUES (?, ?), (?, ?)",
+        "INSERT INTO \"A\" (\"B\", \"C\") VALUES (?, ?)"
+    };
+    EXPECT_EQ(connection.executed, expected);
+}
+
+// Test for passing typed parameters as strings in the base implementation
+TEST(ConnectionTest, TypedParametersFallBackToStrings)
+{
+    recording_connection connection;
+
+    const std::string text = "text";
+    const char blob[] = { 'a', '\0', 'b' };
+    connection.exec_typed("INSERT INTO A VALUES (?, ?, ?, ?, ?, ?)", {
+        42,
+        true,
+        0.5,
+        text,
+        database_adapter::bind_parameter::blob(blob, sizeof(blob)),
+        nullptr
+    });
+
+    const std::vector<std::string> expected { "42", "1", "0.5", "text", std::string(blob, sizeof(blob)), NULL_VALUE };
+    EXPECT_EQ(connection.last_params, expected);
+}
+
+// Test for keeping references to text without copying
+TEST(ConnectionTest, TypedTextParametersAreNotCopied)
+{
+    const std::string text = "text";
+    const database_adapter::bind_parameter from_string(text);
+    EXPECT_EQ(from_string.data(), text.data());
+    EXPECT_TRUE(from_string.is_null_terminated());
+
+    const database_adapter::bind_parameter from_view(database_adapter::text_view(text.data(), 2));
+    EXPECT_EQ(from_view.data(), text.data());
+    EXPECT_EQ(from_view.size(), 2);
+    EXPECT_FALSE(from_view.is_null_terminated());
+
+    EXPECT_TRUE(database_adapter::bind_parameter(std::string(NULL_VALUE)).is_null());
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <DatabaseAdapter/databaseadapter.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+/// Соединение, возвращающее одну строку на каждый запрос
+class fake_connection final : public database_adapter::IConnection
+{
+public:
+    fake_connection()
+        : IConnection({})
+    {
+    }
+
+    using IConnection::exec_prepared;
+
+    database_adapter::query_result exec(const std::string& query) override
+    {
+        return exec_prepared(query, {});
+    }
+
+    void prepare(const std::string& query, const std::string& /*name*/) override
+    {
+        _query = query;
+    }
+
+    database_adapter::query_result exec_prepared(const std::vector<std::string>& /*params*/, const std::string& /*name*/) override
+    {
+        if(_query.find("FAIL") != std::string::npos) {
+            throw database_adapter::sql_exception("Query failed", _query);
+        }
+
+        database_adapter::query_result result({ "value" });
+        result.add_value("abc", 3);
+        return result;
+    }
+
+    bool open_transaction(int /*type*/) override
+    {
+        _has_transaction = true;
+        return true;
+    }
+
+private:
+    std::string _query;
+};
+
+/// Получатель, запоминающий все измерения
+class recording_sink final : public database_adapter::IMetricsSink
+{
+public:
+    void record(const database_adapter::query_metrics& metrics) override
+    {
+        recorded.push_back(metrics);
+    }
+
+    std::vector<database_adapter::query_metrics> recorded;
+};
+} // namespace
+
+// Test for recording call, source, rows and bytes of an executed query
+TEST(InstrumentedConnectionTest, RecordsQueryMetrics)
+{
+    const auto sink = std::make_shared<recording_sink>();
+    database_adapter::instrumented_connection connection(std::make_shared<fake_connection>(), sink);
+
+    {
+        const database_adapter::query_source source("storage::select");
+        const database_adapter::query_source nested("storage::get");
+        connection.exec_prepared("SELECT value FROM A WHERE id = ?", { "1" });
+    }
+    connection.exec("SELECT 1");
+
+    ASSERT_EQ(sink->recorded.size(), 2);
+    const auto& metrics = sink->recorded.front();
+    EXPECT_STREQ(metrics.call, "exec_prepared");
+    EXPECT_STREQ(metrics.source, "storage::select");
+    EXPECT_EQ(metrics.query, "SELECT value FROM A WHERE id = ?");
+    EXPECT_EQ(metrics.rows, 1);
+    EXPECT_EQ(metrics.bytes_sent, metrics.query.size() + 1);
+    EXPECT_EQ(metrics.bytes_received, 3);
+    EXPECT_FALSE(metrics.failed);
+
+    EXPECT_STREQ(sink->recorded.back().source, "");
+}
+
+// Test for equal fingerprints of queries that differ only in whitespace
+TEST(InstrumentedConnectionTest, FingerprintIgnoresWhitespace)
+{
+    const auto sink = std::make_shared<recording_sink>();
+    database_adapter::instrumented_connection connection(std::make_shared<fake_connection>(), sink);
+
+    connection.exec("SELECT value\n  FROM A");
+    connection.exec("SELECT value FROM A");
+    connection.exec("SELECT value FROM B");
+
+    ASSERT_EQ(sink->recorded.size(), 3);
+    EXPECT_EQ(sink->recorded[0].fingerprint, sink->recorded[1].fingerprint);
+    EXPECT_NE(sink->recorded[1].fingerprint, sink->recorded[2].fingerprint);
+}
+
+// Test for publishing metrics of a failed query before rethrowing
+TEST(InstrumentedConnectionTest, RecordsFailedQuery)
+{
+    const auto sink = std::make_shared<recording_sink>();
+    database_adapter::instrumented_connection connection(std::make_shared<fake_connection>(), sink);
+
+    EXPECT_THROW(connection.exec("SELECT FAIL"), database_adapter::sql_exception);
+
+    ASSERT_EQ(sink->recorded.size(), 1);
+    EXPECT_TRUE(sink->recorded.front().failed);
+    EXPECT_EQ(sink->recorded.front().rows, 0);
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <DatabaseAdapter/model/queryresult.h>
+
+// Test for accessing values by column index and by column name
+TEST(QueryResultTest, AccessByIndexAndName)
+{
+    database_adapter::query_result result({ "id", "name" });
+    result.add_value("1", 1);
+    result.add_value("first", 5);
+    result.add_value("2", 1);
+    result.add_value("second", 6);
+
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result.column_index("name"), 1);
+    EXPECT_EQ(result.column_index("unknown"), database_adapter::query_result::npos);
+
+    EXPECT_EQ(result[0].at(0), "1");
+    EXPECT_EQ(result[0].at("name"), "first");
+    EXPECT_EQ(result[1].at("id"), "2");
+    EXPECT_EQ(result[1].at(1).str(), "second");
+}
+
+// Test for storing NULL values
+TEST(QueryResultTest, NullValue)
+{
+    database_adapter::query_result result({ "id", "name" });
+    result.add_value("1", 1);
+    result.add_null();
+
+    EXPECT_FALSE(result[0].is_null("id"));
+    EXPECT_TRUE(result[0].is_null("name"));
+    EXPECT_TRUE(result[0].at("name").empty());
+}
+
+// Test for iterating over rows
+TEST(QueryResultTest, Iteration)
+{
+    database_adapter::query_result result({ "id" });
+    for(int i = 0; i < 100; i++) {
+        const auto value = std::to_string(i);
+        result.add_value(value.data(), value.size());
+    }
+
+    int expected = 0;
+    for(const auto& row : result) {
+        EXPECT_EQ(row.at(0), std::to_string(expected));
+        expected++;
+    }
+
+    EXPECT_EQ(expected, 100);
+}
+
+// Test for empty result and missing column
+TEST(QueryResultTest, EmptyResultAndMissingColumn)
+{
+    database_adapter::query_result result;
+    EXPECT_TRUE(result.empty());
+    EXPECT_THROW(result.at(0), std::out_of_range);
+
+    result.set_columns({ "id" });
+    result.add_value("1", 1);
+
+    EXPECT_FALSE(result.empty());
+    EXPECT_THROW(result[0].at("name"), std::out_of_range);
+}
+
+// Test for converting row to the legacy map representation
+TEST(QueryResultTest, LegacyData)
+{
+    database_adapter::query_result result({ "id", "name" });
+    result.add_value("1", 1);
+    result.add_value("first", 5);
+
+    const auto data = result.data();
+    ASSERT_EQ(data.size(), 1);
+    EXPECT_EQ(data.front().at("id"), "1");
+    EXPECT_EQ(data.front().at("name"), "first");
+}
+
+// Test for filling result with legacy map rows
+TEST(QueryResultTest, LegacyAddRow)
+{
+    const std::list<database_adapter::query_result::row> rows = { { { "id", "1" }, { "name", "first" } }, { { "id", "2" }, { "name", "second" } } };
+    database_adapter::query_result result(rows);
+
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[1].at("id"), "2");
+    EXPECT_EQ(result[1].at("name"), "second");
+
+    result.add({ { "name", "third" }, { "id", "3" } });
+    ASSERT_EQ(result.size(), 3);
+    EXPECT_EQ(result[2].at("id"), "3");
+
+    EXPECT_THROW(result.add({ { "id", "4" } }), std::invalid_argument);
+    EXPECT_THROW(result.add({ { "id", "4" }, { "title", "fourth" } }), std::invalid_argument);
+    EXPECT_EQ(result.size(), 3);
+}
+
+// Test for reusing result after clear
+TEST(QueryResultTest, ClearKeepsColumns)
+{
+    database_adapter::query_result result({ "id" });
+    result.add_value("1", 1);
+    result.clear();
+
+    EXPECT_TRUE(result.empty());
+    ASSERT_EQ(result.columns().size(), 1);
+
+    result.add_value("2", 1);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0].at("id"), "2");
+}
+
+// Test for typed cell access
+TEST(QueryResultTest, TypedAccess)
+{
+    database_adapter::query_result result({ "integer", "real", "text", "blob", "null" });
+    result.add_int64(-42);
+    result.add_double(1);
+    result.add_value("15", 2);
+    result.add_blob("a\0b", 3);
+    result.add_null();
+
+    const auto row = result[0];
+    EXPECT_EQ(row.type(0), database_adapter::query_result::cell_type::integer);
+    EXPECT_EQ(row.as_int64(0), -42);
+    EXPECT_EQ(row.at(0), "-42");
+
+    EXPECT_EQ(row.type(1), database_adapter::query_result::cell_type::real);
+    EXPECT_DOUBLE_EQ(row.as_double(1), 1.0);
+    EXPECT_EQ(row.at(1), "1.0");
+
+    EXPECT_EQ(row.type(2), database_adapter::query_result::cell_type::text);
+    EXPECT_EQ(row.as_int64(2), 15);
+    EXPECT_DOUBLE_EQ(row.as_double(2), 15.0);
+    EXPECT_THROW(result[0].as_int64(3), std::invalid_argument);
+
+    EXPECT_EQ(row.as_blob(3).size(), 3);
+    EXPECT_EQ(row.as_int64(4), 0);
+    EXPECT_TRUE(row.is_null(4));
+}
+
+// Test for appending rows of another result
+TEST(QueryResultTest, Append)
+{
+    database_adapter::query_result first({ "id", "name" });
+    first.add_int64(1);
+    first.add_value("a", 1);
+
+    database_adapter::query_result second({ "id", "name" });
+    second.add_int64(2);
+    second.add_null();
+
+    database_adapter::query_result result;
+    result.append(first);
+    result.append(second);
+
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0].at("name"), "a");
+    EXPECT_EQ(result[1].as_int64(0), 2);
+    EXPECT_TRUE(result[1].is_null(1));
+
+    EXPECT_THROW(result.append(database_adapter::query_result({ "id" })), std::invalid_argument);
+}
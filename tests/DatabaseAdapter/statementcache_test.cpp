@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <DatabaseAdapter/statementcache.h>
+
+#include <vector>
+
+// Test for normalizing sql used as cache key
+TEST(StatementCacheTest, NormalizeSql)
+{
+    EXPECT_EQ(database_adapter::normalize_sql("  SELECT  *\n\tFROM A ;  "), "SELECT * FROM A");
+    EXPECT_EQ(database_adapter::normalize_sql("BEGIN;"), "BEGIN");
+    EXPECT_EQ(database_adapter::normalize_sql("SELECT 'a   b' ,  \"c  d\""), "SELECT 'a   b' , \"c  d\"");
+    EXPECT_EQ(database_adapter::normalize_sql("SELECT 'it''s  ok'"), "SELECT 'it''s  ok'");
+}
+
+// Test for keeping backslash escaped strings verbatim
+TEST(StatementCacheTest, NormalizeSqlEscapeStringsDoNotCollide)
+{
+    EXPECT_EQ(database_adapter::normalize_sql("SELECT E'a\\'  b'"), "SELECT E'a\\'  b'");
+    EXPECT_NE(database_adapter::normalize_sql("SELECT E'a\\'  b'"), database_adapter::normalize_sql("SELECT E'a\\' b'"));
+    EXPECT_EQ(database_adapter::normalize_sql("SELECT e'\\\\'  ,  1"), "SELECT e'\\\\' , 1");
+}
+
+// Test for keeping line and block comments verbatim
+TEST(StatementCacheTest, NormalizeSqlCommentsDoNotCollide)
+{
+    EXPECT_NE(database_adapter::normalize_sql("SELECT 1 -- a\nb"), database_adapter::normalize_sql("SELECT 1 -- a b"));
+    EXPECT_NE(database_adapter::normalize_sql("SELECT 1 /* a  b */"), database_adapter::normalize_sql("SELECT 1 /* a b */"));
+    EXPECT_EQ(database_adapter::normalize_sql("SELECT /* a /* b */  ; */  1"), "SELECT /* a /* b */  ; */ 1");
+    EXPECT_EQ(database_adapter::normalize_sql("SELECT 1 -- a;"), "SELECT 1 -- a;");
+}
+
+// Test for keeping dollar quoted strings verbatim
+TEST(StatementCacheTest, NormalizeSqlDollarQuotesDoNotCollide)
+{
+    EXPECT_NE(database_adapter::normalize_sql("SELECT $$a  b$$"), database_adapter::normalize_sql("SELECT $$a b$$"));
+    EXPECT_EQ(database_adapter::normalize_sql("SELECT $tag$ ' $$  $tag$  ,  $1"), "SELECT $tag$ ' $$  $tag$ , $1");
+    EXPECT_EQ(database_adapter::normalize_sql("SELECT  $1 ,  $2"), "SELECT $1 , $2");
+}
+
+// Test for hit/miss counters and eviction of the least recently used statement
+TEST(StatementCacheTest, LeastRecentlyUsedEviction)
+{
+    std::vector<int> released;
+    database_adapter::statement_cache<int> cache(2, [&released](int& statement) { released.push_back(statement); });
+
+    cache.insert("a", 1);
+    cache.insert("b", 2);
+
+    ASSERT_NE(cache.find("a"), nullptr);
+    EXPECT_EQ(cache.find("c"), nullptr);
+
+    cache.insert("c", 3);
+
+    EXPECT_EQ(cache.find("b"), nullptr);
+    ASSERT_EQ(released.size(), 1);
+    EXPECT_EQ(released.front(), 2);
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.size, 2);
+    EXPECT_EQ(stats.capacity, 2);
+
+    cache.clear();
+    EXPECT_EQ(released.size(), 3);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <DatabaseAdapter/databaseadapter.h>
+
+#include <sstream>
+
+namespace {
+database_adapter::query_metrics make_metrics(const uint64_t fingerprint, const std::chrono::nanoseconds time, const size_t rows = 1)
+{
+    database_adapter::query_metrics metrics;
+    metrics.query = "SELECT * FROM A WHERE id = 1";
+    metrics.source = "storage::get";
+    metrics.fingerprint = fingerprint;
+    metrics.execute_time = time;
+    metrics.rows = rows;
+    return metrics;
+}
+} // namespace
+
+// Test for aggregating count, latency and rows by fingerprint
+TEST(StatementStatisticsTest, AggregatesByFingerprint)
+{
+    database_adapter::statement_statistics statistics;
+
+    for(int i = 1; i <= 100; i++) {
+        statistics.record(make_metrics(1, std::chrono::microseconds(i)));
+    }
+    statistics.record(make_metrics(2, std::chrono::milliseconds(5), 10));
+
+    const auto summary = statistics.get(1);
+    EXPECT_EQ(summary.calls, 100);
+    EXPECT_EQ(summary.rows, 100);
+    EXPECT_EQ(summary.total_time, std::chrono::microseconds(5050));
+    EXPECT_EQ(summary.min_time, std::chrono::microseconds(1));
+    EXPECT_EQ(summary.max_time, std::chrono::microseconds(100));
+    EXPECT_GE(summary.p99_time, std::chrono::microseconds(99));
+    EXPECT_LE(summary.p99_time, std::chrono::microseconds(100));
+    EXPECT_STREQ(summary.source, "storage::get");
+
+    const auto snapshot = statistics.snapshot();
+    ASSERT_EQ(snapshot.size(), 2);
+    EXPECT_EQ(snapshot.front().fingerprint, 1);
+
+    EXPECT_EQ(statistics.get(3).calls, 0);
+
+    std::stringstream stream;
+    statistics.dump(stream, 1);
+    EXPECT_NE(stream.str().find("SELECT * FROM A WHERE id = 1"), std::string::npos);
+}
+
+// Test for counting calls of statements beyond the table limit
+TEST(StatementStatisticsTest, LimitsStatementCount)
+{
+    database_adapter::statement_statistics statistics(1);
+
+    statistics.record(make_metrics(1, std::chrono::microseconds(1)));
+    statistics.record(make_metrics(2, std::chrono::microseconds(1)));
+    statistics.record(make_metrics(1, std::chrono::microseconds(1)));
+
+    EXPECT_EQ(statistics.get(1).calls, 2);
+    EXPECT_EQ(statistics.untracked(), 1);
+
+    statistics.reset();
+    EXPECT_TRUE(statistics.snapshot().empty());
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <EntityCraft/entitydecoder.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Point
+{
+    int x = 0;
+    std::string label;
+};
+
+using row_view = database_adapter::query_result::row_view;
+using connection = std::shared_ptr<database_adapter::IConnection>;
+
+/// Декодер с колонками x и label, у которого шаги не изменяют своё состояние
+entity_craft::entity_decoder<Point> make_point_decoder()
+{
+    entity_craft::entity_decoder<Point> decoder;
+
+    const auto x_slot = decoder.add_slot("x");
+    decoder.add_step([x_slot](Point& point, const row_view& row, const size_t* positions, const connection&) {
+        if(positions[x_slot] != database_adapter::query_result::npos)
+            point.x = static_cast<int>(row.as_int64(positions[x_slot]));
+    });
+
+    const auto label_slot = decoder.add_slot("label");
+    decoder.add_step([label_slot](Point& point, const row_view& row, const size_t* positions, const connection&) {
+        if(positions[label_slot] != database_adapter::query_result::npos)
+            point.label = row.at(positions[label_slot]).str();
+    });
+
+    return decoder;
+}
+} // namespace
+
+// Test for decoding rows by slot positions bound to the result columns
+TEST(EntityDecoderTest, DecodesBySlotPositions)
+{
+    const auto decoder = make_point_decoder();
+
+    database_adapter::query_result result({ "label", "x" });
+    result.add_value("a", 1);
+    result.add_value("10", 2);
+
+    const auto positions = decoder.bind(result);
+    EXPECT_EQ(positions, (std::vector<size_t> { 1, 0 }));
+
+    const auto point = decoder.decode(result[0], positions.data(), nullptr);
+    EXPECT_EQ(point.x, 10);
+    EXPECT_EQ(point.label, "a");
+
+    // Колонки, которых нет в результате, не заполняются
+    database_adapter::query_result partial({ "x" });
+    partial.add_value("5", 1);
+
+    const auto partial_positions = decoder.bind(partial);
+    EXPECT_EQ(partial_positions[1], database_adapter::query_result::npos);
+    EXPECT_EQ(decoder.decode(partial[0], partial_positions.data(), nullptr).label, "");
+}
+
+// Test for decoding with one shared decoder from several threads
+TEST(EntityDecoderTest, SharedBetweenThreads)
+{
+    const auto decoder = make_point_decoder();
+
+    database_adapter::query_result result({ "x", "label" });
+    for(int i = 0; i < 100; ++i) {
+        const auto x = std::to_string(i);
+        result.add_value(x.data(), x.size());
+        result.add_value("p", 1);
+    }
+    const auto positions = decoder.bind(result);
+
+    std::vector<int> sums(4, 0);
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < sums.size(); ++t) {
+        threads.emplace_back([&decoder, &result, &positions, &sum = sums[t]]() {
+            for(const auto& row : result) {
+                sum += decoder.decode(row, positions.data(), nullptr).x;
+            }
+        });
+    }
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    for(const auto sum : sums) {
+        EXPECT_EQ(sum, 4950);
+    }
+}
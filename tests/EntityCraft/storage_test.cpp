@@ -0,0 +1,446 @@
+#ifdef ENABLE_SQLITE
+
+#include <gtest/gtest.h>
+#include <EntityCraft/entitycraft.h>
+#include <SqliteAdapter/sqliteadapter.h>
+
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace {
+struct Item
+{
+    int id = 0;
+    std::string name;
+};
+
+struct ItemTableInfo
+{
+    static auto dto()
+    {
+        using namespace entity_craft;
+
+        return make_table<Item>("", "Item",
+            make_column("id", &Item::id, query_craft::primary_key() | query_craft::column_settings::auto_increment),
+            make_column("name", &Item::name, query_craft::not_null()));
+    }
+};
+
+struct Note
+{
+    int id = 0;
+    int parent_id = 0;
+    std::string text;
+};
+
+struct NoteTableInfo
+{
+    static auto dto()
+    {
+        using namespace entity_craft;
+
+        return make_table<Note>("", "Note",
+            make_column("id", &Note::id, query_craft::primary_key()),
+            make_column("parent_id", &Note::parent_id, query_craft::not_null()),
+            make_column("text", &Note::text, query_craft::not_null()));
+    }
+};
+
+struct Tag
+{
+    int id = 0;
+    int parent_id = 0;
+    std::string name;
+};
+
+struct TagTableInfo
+{
+    static auto dto()
+    {
+        using namespace entity_craft;
+
+        return make_table<Tag>("", "Tag",
+            make_column("id", &Tag::id, query_craft::primary_key()),
+            make_column("parent_id", &Tag::parent_id, query_craft::not_null()),
+            make_column("name", &Tag::name, query_craft::not_null()));
+    }
+};
+
+struct Parent
+{
+    int id = 0;
+    std::string name;
+    std::list<Note> notes;
+    std::list<Tag> tags;
+};
+
+struct ParentTableInfo
+{
+    static auto dto()
+    {
+        using namespace entity_craft;
+
+        return make_table<Parent>("", "Parent",
+            make_column("id", &Parent::id, query_craft::primary_key()),
+            make_column("name", &Parent::name, query_craft::not_null()),
+            make_reference_column("parent_id", &Parent::notes, NoteTableInfo::dto(), relation_type::one_to_many),
+            make_reference_column("parent_id", &Parent::tags, TagTableInfo::dto(), relation_type::one_to_many));
+    }
+};
+
+struct Attachment
+{
+    int id = 0;
+    std::string path;
+};
+
+struct AttachmentTableInfo
+{
+    static auto dto()
+    {
+        using namespace entity_craft;
+
+        return make_table<Attachment>("", "Attachment",
+            make_column("id", &Attachment::id, query_craft::primary_key()),
+            make_column("path", &Attachment::path, query_craft::not_null()));
+    }
+};
+
+struct Owner
+{
+    int id = 0;
+    Attachment attachment;
+};
+
+struct OwnerTableInfo
+{
+    static auto dto()
+    {
+        using namespace entity_craft;
+
+        return make_table<Owner>("", "Owner",
+            make_column("id", &Owner::id, query_craft::primary_key()),
+            make_reference_column("attachment_id", &Owner::attachment, AttachmentTableInfo::dto(), relation_type::one_to_one));
+    }
+};
+
+/// Получатель измерений, который сохраняет их для проверки
+class recording_sink final : public database_adapter::IMetricsSink
+{
+public:
+    void record(const database_adapter::query_metrics& metrics) override
+    {
+        records.push_back(metrics);
+    }
+
+    /// Количество обращений через метод call, текст запроса которых содержит fragment
+    size_t count(const char* call, const std::string& fragment) const
+    {
+        size_t result = 0;
+        for(const auto& metrics : records) {
+            if(std::strcmp(metrics.call, call) == 0 && metrics.query.find(fragment) != std::string::npos) {
+                result++;
+            }
+        }
+
+        return result;
+    }
+
+    std::vector<database_adapter::query_metrics> records;
+};
+
+/// Функция обратного вызова, которая выполняет запрос через переданное соединение при каждой выборке
+class querying_callback final : public entity_craft::IRequestCallback<Note>
+{
+public:
+    void pre_request_callback(Note&, entity_craft::request_callback_type, const std::shared_ptr<database_adapter::IConnection>&) override
+    {
+    }
+
+    void post_request_callback(Note&, entity_craft::request_callback_type type, const std::shared_ptr<database_adapter::IConnection>& connection) override
+    {
+        if(type == entity_craft::request_callback_type::select) {
+            connection->exec("SELECT 1;");
+            calls++;
+        }
+    }
+
+    size_t calls = 0;
+};
+
+/// Соединение с пустой таблицей Item в базе в памяти
+std::shared_ptr<database_adapter::IConnection> make_item_database()
+{
+    database_adapter::sqlite::settings settings;
+    settings.url = ":memory:";
+
+    auto database = std::make_shared<database_adapter::sqlite::connection>(settings);
+    database->exec("CREATE TABLE Item (id integer primary key autoincrement, name varchar not null);");
+
+    return database;
+}
+
+/// Соединение с таблицами Parent, Note и Tag, в которых у каждого из двух объектов Parent есть по две заметки и одной метке
+std::shared_ptr<database_adapter::IConnection> make_parent_database()
+{
+    database_adapter::sqlite::settings settings;
+    settings.url = ":memory:";
+
+    auto database = std::make_shared<database_adapter::sqlite::connection>(settings);
+    database->exec("CREATE TABLE Parent (id integer primary key, name varchar not null);");
+    database->exec("CREATE TABLE Note (id integer primary key, parent_id integer not null, text varchar not null);");
+    database->exec("CREATE TABLE Tag (id integer primary key, parent_id integer not null, name varchar not null);");
+    database->exec("INSERT INTO Parent VALUES (1, 'a'), (2, 'b');");
+    database->exec("INSERT INTO Note VALUES (1, 1, 'a1'), (2, 1, 'a2'), (3, 2, 'b1'), (4, 2, 'b2');");
+    database->exec("INSERT INTO Tag VALUES (1, 1, 'x'), (2, 2, 'y');");
+
+    return database;
+}
+
+/// Соединение с пустыми таблицами Owner и Attachment
+std::shared_ptr<database_adapter::IConnection> make_owner_database()
+{
+    database_adapter::sqlite::settings settings;
+    settings.url = ":memory:";
+
+    auto database = std::make_shared<database_adapter::sqlite::connection>(settings);
+    database->exec("CREATE TABLE Attachment (id integer primary key, path varchar not null);");
+    database->exec("CREATE TABLE Owner (id integer primary key, attachment_id integer);");
+
+    return database;
+}
+} // namespace
+
+// Test for skipping cascaded writes of one_to_one references with an empty primary key
+TEST(StorageTest, CascadeSkipsEmptyReference)
+{
+    auto database = make_owner_database();
+    auto storage = entity_craft::make_storage(database, OwnerTableInfo::dto());
+    auto attachments = entity_craft::make_storage(database, AttachmentTableInfo::dto());
+
+    Owner owner;
+    owner.id = 1;
+    storage.upsert(owner);
+    EXPECT_EQ(attachments.count(), 0);
+
+    owner.attachment.id = 1;
+    owner.attachment.path = "path";
+    storage.update(owner);
+    EXPECT_EQ(attachments.count(), 1);
+
+    // Очистка связи удаляет связанный объект и не добавляет вместо него пустой
+    owner.attachment = {};
+    EXPECT_NO_THROW(storage.update(owner));
+    EXPECT_NO_THROW(storage.update(owner));
+    EXPECT_EQ(attachments.count(), 0);
+
+    const auto stored = storage.select();
+    ASSERT_EQ(stored.size(), 1);
+    EXPECT_EQ(stored[0].attachment.id, 0);
+}
+
+// Test for sending cascaded updates and removals of a batch update as deferred statements
+TEST(StorageTest, BatchUpdateDefersCascadedStatements)
+{
+    const auto sink = std::make_shared<recording_sink>();
+    const auto database = std::make_shared<database_adapter::instrumented_connection>(make_parent_database(), sink);
+    auto storage = entity_craft::make_storage(database, ParentTableInfo::dto());
+
+    auto parents = storage.select();
+    ASSERT_EQ(parents.size(), 2);
+
+    for(auto& parent : parents) {
+        parent.name += "!";
+        parent.notes.front().text += "!";
+        parent.notes.pop_back();
+    }
+
+    sink->records.clear();
+    storage.update(parents);
+
+    // Ни одно обновление и удаление не выполнено отдельным запросом
+    EXPECT_EQ(sink->count("exec_prepared", "UPDATE"), 0);
+    EXPECT_EQ(sink->count("exec_prepared", "DELETE"), 0);
+    EXPECT_GT(sink->count("exec_batch", ""), 0);
+
+    // Состояние объекта в базе читается один раз на объект, а не на каждую связь
+    EXPECT_EQ(sink->count("exec_prepared", "FROM \"Parent\""), 2);
+
+    const auto stored = storage.select();
+    ASSERT_EQ(stored.size(), 2);
+    EXPECT_EQ(stored[0].name, "a!");
+    ASSERT_EQ(stored[0].notes.size(), 1);
+    EXPECT_EQ(stored[0].notes.front().text, "a1!");
+    ASSERT_EQ(stored[1].notes.size(), 1);
+    EXPECT_EQ(stored[1].notes.front().text, "b1!");
+    EXPECT_EQ(stored[1].tags.size(), 1);
+}
+
+// Test for passing errors of a batch update and upsert to the caller after rolling back
+TEST(StorageTest, BatchUpdateRethrowsErrors)
+{
+    auto database = make_item_database();
+    auto storage = entity_craft::make_storage(database, ItemTableInfo::dto());
+
+    std::vector<Item> items(2);
+    items[0].name = "a";
+    items[1].name = "b";
+    storage.insert(items.begin(), items.end());
+
+    items[0].name = "c";
+    items[1].name = query_craft::column_info::null_value();
+
+    EXPECT_THROW(storage.update(items), database_adapter::sql_exception);
+    EXPECT_FALSE(database->is_transaction());
+
+    EXPECT_THROW(storage.upsert(items), database_adapter::sql_exception);
+    EXPECT_FALSE(database->is_transaction());
+
+    const auto stored = storage.select();
+    ASSERT_EQ(stored.size(), 2);
+    EXPECT_EQ(stored[0].name, "a");
+}
+
+// Test for running the callback of a related table for every decoded related entity
+TEST(StorageTest, SelectRunsRelatedTableCallbacks)
+{
+    const auto callback = std::make_shared<querying_callback>();
+
+    using namespace entity_craft;
+    auto dto = make_table<Parent>("", "Parent",
+        make_column("id", &Parent::id, query_craft::primary_key()),
+        make_column("name", &Parent::name, query_craft::not_null()),
+        make_reference_column("parent_id", &Parent::notes, NoteTableInfo::dto().set_reques_callback(callback), relation_type::one_to_many));
+
+    auto storage = make_storage(make_parent_database(), dto);
+
+    const auto parents = storage.select();
+    EXPECT_EQ(callback->calls, 4);
+
+    ASSERT_EQ(parents.size(), 2);
+    EXPECT_EQ(parents[0].notes.size(), 2);
+    EXPECT_EQ(parents[1].notes.size(), 2);
+}
+
+// Test for keeping the order of the query for merged entities and their one to many relations
+TEST(StorageTest, SelectKeepsQueryOrder)
+{
+    auto storage = entity_craft::make_storage(make_parent_database(), ParentTableInfo::dto());
+
+    storage.sort_columns({ query_craft::desc_sort(ParentTableInfo::dto().table_info().column("id")),
+        query_craft::desc_sort(NoteTableInfo::dto().table_info().column("id")) });
+    const auto parents = storage.select();
+
+    ASSERT_EQ(parents.size(), 2);
+    EXPECT_EQ(parents[0].id, 2);
+    EXPECT_EQ(parents[1].id, 1);
+
+    std::vector<int> note_ids;
+    for(const auto& parent : parents) {
+        for(const auto& note : parent.notes) {
+            note_ids.emplace_back(note.id);
+        }
+    }
+    EXPECT_EQ(note_ids, (std::vector<int> { 4, 3, 2, 1 }));
+    EXPECT_EQ(parents[0].tags.size(), 1);
+    EXPECT_EQ(parents[1].tags.size(), 1);
+}
+
+// Test for streaming entities with their one to many relations merged by primary key
+TEST(StorageTest, SelectStreamMergesRelations)
+{
+    const auto sink = std::make_shared<recording_sink>();
+    const auto database = std::make_shared<database_adapter::instrumented_connection>(make_parent_database(), sink);
+    auto storage = entity_craft::make_storage(database, ParentTableInfo::dto());
+
+    std::vector<Parent> parents;
+    storage.select_stream([&parents](Parent& parent) {
+        parents.emplace_back(parent);
+    });
+
+    EXPECT_EQ(sink->count("exec_stream", "FROM \"Parent\""), 1);
+
+    ASSERT_EQ(parents.size(), 2);
+    EXPECT_EQ(parents[0].id, 1);
+    EXPECT_EQ(parents[0].notes.size(), 2);
+    EXPECT_EQ(parents[0].tags.size(), 1);
+    EXPECT_EQ(parents[1].id, 2);
+    EXPECT_EQ(parents[1].notes.size(), 2);
+    EXPECT_EQ(parents[1].tags.size(), 1);
+}
+
+// Test for reading the whole result before running callbacks of related tables, which may query the same connection
+TEST(StorageTest, SelectStreamReadsResultBeforeCallbacks)
+{
+    const auto callback = std::make_shared<querying_callback>();
+
+    using namespace entity_craft;
+    auto dto = make_table<Parent>("", "Parent",
+        make_column("id", &Parent::id, query_craft::primary_key()),
+        make_column("name", &Parent::name, query_craft::not_null()),
+        make_reference_column("parent_id", &Parent::notes, NoteTableInfo::dto().set_reques_callback(callback), relation_type::one_to_many));
+
+    const auto sink = std::make_shared<recording_sink>();
+    const auto database = std::make_shared<database_adapter::instrumented_connection>(make_parent_database(), sink);
+    auto storage = make_storage(database, dto);
+
+    std::vector<Parent> parents;
+    storage.select_stream([&parents](Parent& parent) {
+        parents.emplace_back(parent);
+    });
+
+    EXPECT_EQ(sink->count("exec_stream", ""), 0);
+    EXPECT_EQ(sink->count("exec_prepared", "FROM \"Parent\""), 1);
+    EXPECT_EQ(callback->calls, 4);
+
+    ASSERT_EQ(parents.size(), 2);
+    EXPECT_EQ(parents[0].notes.size(), 2);
+    EXPECT_EQ(parents[1].notes.size(), 2);
+}
+
+// Test for filling generated keys of bulk inserted entities in the order they were passed
+TEST(StorageTest, BulkInsertFetchesKeysInOrder)
+{
+    auto storage = entity_craft::make_storage(make_item_database(), ItemTableInfo::dto());
+
+    std::vector<Item> items(3);
+    items[0].name = "a";
+    items[1].name = "b";
+    items[2].name = "c";
+
+    storage.bulk_insert(items, true);
+
+    EXPECT_EQ(items[0].id, 1);
+    EXPECT_EQ(items[1].id, 2);
+    EXPECT_EQ(items[2].id, 3);
+    EXPECT_FALSE(storage.database()->is_transaction());
+    EXPECT_EQ(storage.count(), 3);
+}
+
+// Test for rolling back the transaction opened by a failed bulk insert
+TEST(StorageTest, BulkInsertRollsBackOnError)
+{
+    auto database = make_item_database();
+    auto storage = entity_craft::make_storage(database, ItemTableInfo::dto());
+
+    std::vector<Item> items(2);
+    items[0].name = "a";
+    items[1].name = query_craft::column_info::null_value();
+
+    EXPECT_THROW(storage.bulk_insert(items), database_adapter::sql_exception);
+
+    EXPECT_FALSE(database->is_transaction());
+    EXPECT_EQ(storage.count(), 0);
+
+    // Транзакция вызывающего не откатывается, ошибка передаётся ему
+    database->open_base_transaction();
+    storage.insert(items[0]);
+    EXPECT_THROW(storage.bulk_insert(items), database_adapter::sql_exception);
+    EXPECT_TRUE(database->is_transaction());
+    database->rollback();
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <EntityCraft/entitycraft.h>
+
+#include <string>
+
+namespace {
+struct Record
+{
+    int id = 0;
+    std::string name;
+};
+
+auto make_record_table()
+{
+    using namespace entity_craft;
+
+    return make_table<Record>("", "Record",
+        make_column("id", &Record::id, query_craft::primary_key()),
+        make_column("name", &Record::name, query_craft::not_null()));
+}
+
+/// Получить план выборки таблицы и посчитать, сколько раз он формировался
+template<typename Table>
+const entity_craft::select_plan& plan_of(const Table& table, int& builds)
+{
+    return table.cached_select_plan([&builds]() {
+        builds++;
+        return entity_craft::select_plan();
+    });
+}
+
+class empty_callback final : public entity_craft::IRequestCallback<Record>
+{
+public:
+    void pre_request_callback(Record&, entity_craft::request_callback_type, const std::shared_ptr<database_adapter::IConnection>&) override
+    {
+    }
+
+    void post_request_callback(Record&, entity_craft::request_callback_type, const std::shared_ptr<database_adapter::IConnection>&) override
+    {
+    }
+};
+} // namespace
+
+// Test for sharing the select plan between copies of a table until one of them is changed
+TEST(TableTest, CopiesSharePlanUntilChanged)
+{
+    auto table = make_record_table();
+
+    int builds = 0;
+    const auto& plan = plan_of(table, builds);
+
+    auto copy = table;
+    EXPECT_EQ(&plan_of(copy, builds), &plan);
+    EXPECT_EQ(builds, 1);
+
+    // Изменённая копия формирует свой план, исходная таблица продолжает использовать прежний
+    copy.set_reques_callback(std::make_shared<empty_callback>());
+    EXPECT_NE(&plan_of(copy, builds), &plan);
+    EXPECT_EQ(builds, 2);
+    EXPECT_EQ(&plan_of(table, builds), &plan);
+    EXPECT_EQ(builds, 2);
+}
+
+// Test for rebuilding the select plan after the columns of a table are changed
+TEST(TableTest, ChangingColumnsResetsPlan)
+{
+    auto table = make_record_table();
+
+    int builds = 0;
+    plan_of(table, builds);
+
+    // Обход колонок без изменения не сбрасывает план
+    table.for_each([](const auto&) {});
+    plan_of(table, builds);
+    EXPECT_EQ(builds, 1);
+
+    table.visit_property("name", [](auto&) {});
+    plan_of(table, builds);
+    EXPECT_EQ(builds, 2);
+
+    table.mutable_for_each([](auto&) {});
+    plan_of(table, builds);
+    EXPECT_EQ(builds, 3);
+}
@@ -0,0 +1,183 @@
+#ifdef ENABLE_POSTGRE
+
+#include <gtest/gtest.h>
+#include <PostgreAdapter/postgrebinaryformat.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+/// Целое число в сетевом порядке байт
+std::string big_endian(uint64_t value, const size_t size)
+{
+    std::string data(size, '\0');
+    for(size_t i = size; i > 0; i--) {
+        data[i - 1] = static_cast<char>(value & 0xFF);
+        value >>= 8;
+    }
+
+    return data;
+}
+
+/// Число numeric в бинарном формате
+std::string numeric(const int16_t weight, const uint16_t sign, const int16_t scale, const std::vector<int16_t>& digits)
+{
+    auto data = big_endian(digits.size(), 2) + big_endian(static_cast<uint16_t>(weight), 2) + big_endian(sign, 2) + big_endian(static_cast<uint16_t>(scale), 2);
+    for(const auto digit : digits) {
+        data += big_endian(static_cast<uint16_t>(digit), 2);
+    }
+
+    return data;
+}
+
+/// Число float8 в бинарном формате
+std::string float8(const double value)
+{
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return big_endian(bits, 8);
+}
+
+/// Число float4 в бинарном формате
+std::string float4(const float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return big_endian(bits, 4);
+}
+
+std::string decode(const Oid type, const std::string& data)
+{
+    database_adapter::query_result result({ "value" });
+    database_adapter::postgre::append_binary_value(type, data.data(), data.size(), result);
+
+    return result[0].at(0).str();
+}
+} // namespace
+
+// Test for decoding integers and floats into typed cells
+TEST(PostgreBinaryFormatTest, Numbers)
+{
+    database_adapter::query_result result({ "int4", "int8", "float8" });
+
+    const auto int4 = big_endian(static_cast<uint32_t>(-5), 4);
+    database_adapter::postgre::append_binary_value(23, int4.data(), int4.size(), result);
+
+    const auto int8 = big_endian(1234567890123ULL, 8);
+    database_adapter::postgre::append_binary_value(20, int8.data(), int8.size(), result);
+
+    const double real = 0.1;
+    uint64_t bits = 0;
+    std::memcpy(&bits, &real, sizeof(bits));
+    const auto float8 = big_endian(bits, 8);
+    database_adapter::postgre::append_binary_value(701, float8.data(), float8.size(), result);
+
+    const auto row = result[0];
+    EXPECT_EQ(row.type(0), database_adapter::query_result::cell_type::integer);
+    EXPECT_EQ(row.as_int64(0), -5);
+    EXPECT_EQ(row.as_int64(1), 1234567890123LL);
+    EXPECT_EQ(row.type(2), database_adapter::query_result::cell_type::real);
+    EXPECT_DOUBLE_EQ(row.as_double(2), 0.1);
+    EXPECT_EQ(row.at(2), "0.1");
+}
+
+// Test for formatting values the same way as the server text format
+TEST(PostgreBinaryFormatTest, TextRepresentation)
+{
+    EXPECT_EQ(decode(16, std::string(1, '\1')), "t");
+    EXPECT_EQ(decode(16, std::string(1, '\0')), "f");
+
+    EXPECT_EQ(decode(1114, big_endian(0, 8)), "2000-01-01 00:00:00");
+    EXPECT_EQ(decode(1114, big_endian(static_cast<uint64_t>(-1), 8)), "1999-12-31 23:59:59.999999");
+    EXPECT_EQ(decode(1184, big_endian(86400000000ULL * 365 + 123000, 8)), "2000-12-31 00:00:00.123+00");
+
+    EXPECT_EQ(decode(1700, numeric(1, 0, 3, { 1, 2345, 6780 })), "12345.678");
+    EXPECT_EQ(decode(1700, numeric(-1, 0, 4, { 12 })), "0.0012");
+    EXPECT_EQ(decode(1700, numeric(0, 0x4000, 0, { 100 })), "-100");
+    EXPECT_EQ(decode(1700, numeric(0, 0, 2, {})), "0.00");
+
+    std::string uuid;
+    for(int i = 0; i < 16; i++) {
+        uuid.push_back(static_cast<char>(i * 17));
+    }
+    EXPECT_EQ(decode(2950, uuid), "00112233-4455-6677-8899-aabbccddeeff");
+
+    EXPECT_THROW(decode(1082, big_endian(0, 4)), std::invalid_argument);
+}
+
+// Test for formatting floats the same way as the server text format (PostgreSQL 12+, float4out/float8out)
+TEST(PostgreBinaryFormatTest, FloatTextRepresentation)
+{
+    EXPECT_EQ(decode(701, float8(1e8)), "100000000");
+    EXPECT_EQ(decode(701, float8(123456789012345.0)), "123456789012345");
+    EXPECT_EQ(decode(701, float8(1e15)), "1e+15");
+    EXPECT_EQ(decode(701, float8(1.5e300)), "1.5e+300");
+    EXPECT_EQ(decode(701, float8(0.0001)), "0.0001");
+    EXPECT_EQ(decode(701, float8(1e-5)), "1e-05");
+    EXPECT_EQ(decode(701, float8(-2.5)), "-2.5");
+    EXPECT_EQ(decode(701, float8(-0.0)), "-0");
+    EXPECT_EQ(decode(701, float8(0.1 + 0.2)), "0.30000000000000004");
+
+    EXPECT_EQ(decode(700, float4(100000.0f)), "100000");
+    EXPECT_EQ(decode(700, float4(1e6f)), "1e+06");
+    EXPECT_EQ(decode(700, float4(0.1f)), "0.1");
+    EXPECT_EQ(decode(700, float4(3.14159f)), "3.14159");
+}
+
+// Test for using binary format only when the decoded text matches the text format of the session
+TEST(PostgreBinaryFormatTest, SessionSettings)
+{
+    using database_adapter::postgre::has_binary_decoder;
+    using database_adapter::postgre::make_binary_format_settings;
+
+    const auto utc = make_binary_format_settings("ISO, MDY", "UTC", "on", 160000);
+    EXPECT_TRUE(has_binary_decoder(1114, utc));
+    EXPECT_TRUE(has_binary_decoder(1184, utc));
+    EXPECT_TRUE(has_binary_decoder(701, utc));
+    EXPECT_TRUE(has_binary_decoder(16, utc));
+    EXPECT_FALSE(has_binary_decoder(17, utc));
+
+    const auto moscow = make_binary_format_settings("ISO, DMY", "Europe/Moscow", "on", 160000);
+    EXPECT_TRUE(has_binary_decoder(1114, moscow));
+    EXPECT_FALSE(has_binary_decoder(1184, moscow));
+
+    const auto german = make_binary_format_settings("German, DMY", "UTC", "on", 160000);
+    EXPECT_FALSE(has_binary_decoder(1114, german));
+    EXPECT_FALSE(has_binary_decoder(1184, german));
+
+    const auto old_server = make_binary_format_settings("ISO, MDY", "UTC", "on", 110000);
+    EXPECT_FALSE(has_binary_decoder(701, old_server));
+    EXPECT_FALSE(has_binary_decoder(700, old_server));
+    EXPECT_TRUE(has_binary_decoder(20, old_server));
+}
+
+// Test for reading the same value from binary and text results of the server
+TEST(PostgreBinaryFormatTest, BinaryMatchesTextFormat)
+{
+    // Пары значение в бинарном формате - текстовое представление сервера для того же значения
+    const std::vector<std::pair<Oid, std::pair<std::string, std::string>>> values = {
+        { 16, { std::string(1, '\1'), "t" } },
+        { 16, { std::string(1, '\0'), "f" } },
+        { 23, { big_endian(static_cast<uint32_t>(-42), 4), "-42" } },
+        { 701, { float8(1e8), "100000000" } },
+        { 701, { float8(2.5e-7), "2.5e-07" } },
+        { 1114, { big_endian(0, 8), "2000-01-01 00:00:00" } },
+        { 1184, { big_endian(1500000, 8), "2000-01-01 00:00:01.5+00" } },
+    };
+
+    for(const auto& value : values) {
+        database_adapter::query_result binary({ "value" });
+        database_adapter::postgre::append_binary_value(value.first, value.second.first.data(), value.second.first.size(), binary);
+
+        database_adapter::query_result text({ "value" });
+        text.add_value(value.second.second.data(), value.second.second.size());
+
+        EXPECT_EQ(binary[0].at(0), text[0].at(0)) << value.second.second;
+        if(binary[0].type(0) != database_adapter::query_result::cell_type::text) {
+            EXPECT_DOUBLE_EQ(binary[0].as_double(0), text[0].as_double(0)) << value.second.second;
+        }
+    }
+}
+
+#endif
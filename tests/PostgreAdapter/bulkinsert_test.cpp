@@ -0,0 +1,61 @@
+#ifdef ENABLE_POSTGRE
+
+#include <gtest/gtest.h>
+#include <PostgreAdapter/postgrebulkinsert.h>
+
+#include <string>
+
+// Test for returning the source row number together with the returning columns
+TEST(PostgreBulkInsertTest, MergeReturnsOrderColumn)
+{
+    const auto sql = database_adapter::postgre::bulk_insert_merge_sql("\"public\".\"A\"", "pg_temp.\"T1\"", { "B", "C" }, "N", { "ID" });
+
+    EXPECT_EQ(sql,
+        "MERGE INTO \"public\".\"A\" AS target USING pg_temp.\"T1\" AS source ON false WHEN NOT MATCHED THEN "
+        "INSERT (\"B\", \"C\") VALUES (source.\"B\", source.\"C\") RETURNING source.\"N\", target.\"ID\"");
+}
+
+// Test for placing returned rows by their source row number instead of the order they arrived in
+TEST(PostgreBulkInsertTest, OrdersRowsByOrdinal)
+{
+    database_adapter::query_result result({ "N", "ID", "NAME" });
+    result.add_value("3", 1);
+    result.add_value("30", 2);
+    result.add_null();
+    result.add_value("1", 1);
+    result.add_value("10", 2);
+    result.add_value("a", 1);
+    result.add_value("2", 1);
+    result.add_value("20", 2);
+    result.add_value("b", 1);
+
+    const auto ordered = database_adapter::postgre::order_by_ordinal(result);
+
+    ASSERT_EQ(ordered.size(), 3);
+    EXPECT_EQ(ordered.columns(), (std::vector<std::string> { "ID", "NAME" }));
+    EXPECT_EQ(ordered[0].as_int64(0), 10);
+    EXPECT_EQ(ordered[1].as_int64(0), 20);
+    EXPECT_EQ(ordered[2].as_int64(0), 30);
+    EXPECT_EQ(std::string(ordered[0].as_text(1).data(), ordered[0].as_text(1).size()), "a");
+    EXPECT_TRUE(ordered[2].is_null(1));
+}
+
+// Test for rejecting a result whose row numbers are not a permutation of the inserted rows
+TEST(PostgreBulkInsertTest, RejectsUnexpectedOrdinals)
+{
+    database_adapter::query_result duplicate({ "N", "ID" });
+    duplicate.add_value("1", 1);
+    duplicate.add_value("10", 2);
+    duplicate.add_value("1", 1);
+    duplicate.add_value("20", 2);
+
+    EXPECT_THROW(database_adapter::postgre::order_by_ordinal(duplicate), std::invalid_argument);
+
+    database_adapter::query_result out_of_range({ "N", "ID" });
+    out_of_range.add_value("2", 1);
+    out_of_range.add_value("10", 2);
+
+    EXPECT_THROW(database_adapter::postgre::order_by_ordinal(out_of_range), std::invalid_argument);
+}
+
+#endif
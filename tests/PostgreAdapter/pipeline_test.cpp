@@ -0,0 +1,64 @@
+#ifdef ENABLE_POSTGRE
+
+#include <gtest/gtest.h>
+#include <PostgreAdapter/postgreadapter.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace {
+/// Значение переменной окружения или пустая строка
+std::string environment(const char* name)
+{
+    const char* value = std::getenv(name);
+    return value == nullptr ? std::string() : std::string(value);
+}
+
+/**
+ * Соединение с тестовым сервером PostgreSQL
+ * @return nullptr, если сервер не задан переменной окружения ENTITY_CRAFT_TEST_POSTGRE_URL
+ * @note Остальные параметры подключения берутся из ENTITY_CRAFT_TEST_POSTGRE_PORT, _DATABASE, _LOGIN и _PASSWORD
+ */
+std::shared_ptr<database_adapter::postgre::connection> make_test_connection()
+{
+    database_adapter::postgre::settings settings;
+    settings.url = environment("ENTITY_CRAFT_TEST_POSTGRE_URL");
+    if(settings.url.empty()) {
+        return nullptr;
+    }
+
+    settings.port = environment("ENTITY_CRAFT_TEST_POSTGRE_PORT");
+    settings.database_name = environment("ENTITY_CRAFT_TEST_POSTGRE_DATABASE");
+    settings.login = environment("ENTITY_CRAFT_TEST_POSTGRE_LOGIN");
+    settings.password = environment("ENTITY_CRAFT_TEST_POSTGRE_PASSWORD");
+
+    return std::make_shared<database_adapter::postgre::connection>(settings, false, 1);
+}
+} // namespace
+
+// Test for not caching statements whose preparation was skipped because an earlier command of the pipeline failed
+TEST(PostgrePipelineTest, AbortedPrepareIsNotCached)
+{
+    const auto database = make_test_connection();
+    if(database == nullptr) {
+        GTEST_SKIP() << "ENTITY_CRAFT_TEST_POSTGRE_URL is not set";
+    }
+
+    database->exec("CREATE TEMP TABLE pipeline_test (id integer);");
+
+    const std::string insert = "INSERT INTO pipeline_test (id) VALUES ($1);";
+    EXPECT_THROW(database->exec_batch({ { "SELECT 1 / $1;", { "0" } }, { insert, { "1" } } }), database_adapter::sql_exception);
+
+    // Запрос, подготовка которого была пропущена, выполняется в транзакции без ошибки
+    database->open_base_transaction();
+    EXPECT_NO_THROW(database->exec_prepared(insert, { "2" }));
+    EXPECT_NO_THROW(database->exec_prepared(insert, { "3" }));
+    database->commit();
+
+    const auto result = database->exec("SELECT count(*) FROM pipeline_test;");
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0].at(0).str(), "2");
+}
+
+#endif
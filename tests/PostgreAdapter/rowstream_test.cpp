@@ -0,0 +1,69 @@
+#ifdef ENABLE_POSTGRE
+
+#include <gtest/gtest.h>
+#include <PostgreAdapter/postgrerowstream.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+using pg_result_ptr = std::unique_ptr<PGresult, decltype(&PQclear)>;
+
+/// Результат libpq с колонками id и name, собранный без обращения к серверу
+pg_result_ptr make_result(const std::vector<std::vector<const char*>>& rows)
+{
+    pg_result_ptr result(PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK), &PQclear);
+
+    PGresAttDesc attributes[2] = {};
+    attributes[0].name = const_cast<char*>("id");
+    attributes[1].name = const_cast<char*>("name");
+    PQsetResultAttrs(result.get(), 2, attributes);
+
+    for(size_t i = 0; i < rows.size(); ++i) {
+        for(size_t j = 0; j < rows[i].size(); ++j) {
+            const auto* value = rows[i][j];
+            PQsetvalue(result.get(), static_cast<int>(i), static_cast<int>(j), const_cast<char*>(value), value == nullptr ? -1 : static_cast<int>(std::string(value).size()));
+        }
+    }
+
+    return result;
+}
+} // namespace
+
+// Test for passing every row of a complete result when single row mode could not be enabled
+TEST(PostgreRowStreamTest, StreamsWholeResult)
+{
+    const auto result = make_result({ { "1", "a" }, { "2", nullptr }, { "3", "c" } });
+
+    database_adapter::query_result row;
+    std::vector<std::string> ids;
+    std::vector<std::string> names;
+    database_adapter::postgre::stream_rows(result.get(), row, [&ids, &names](const database_adapter::query_result::row_view& value) {
+        ids.emplace_back(value.at("id").str());
+        names.emplace_back(value.is_null(1) ? "NULL" : value.at(1).str());
+    });
+
+    EXPECT_EQ(ids, (std::vector<std::string> { "1", "2", "3" }));
+    EXPECT_EQ(names, (std::vector<std::string> { "a", "NULL", "c" }));
+}
+
+// Test for reusing the columns of the first single row result for the following ones
+TEST(PostgreRowStreamTest, StreamsSingleRowResults)
+{
+    database_adapter::query_result row;
+    std::vector<std::string> names;
+    const auto callback = [&names](const database_adapter::query_result::row_view& value) {
+        names.emplace_back(value.at("name").str());
+    };
+
+    database_adapter::postgre::stream_rows(make_result({ { "1", "a" } }).get(), row, callback);
+    database_adapter::postgre::stream_rows(make_result({ { "2", "b" } }).get(), row, callback);
+    // Итоговый результат режима одной строки не содержит строк
+    database_adapter::postgre::stream_rows(make_result({}).get(), row, callback);
+
+    EXPECT_EQ(names, (std::vector<std::string> { "a", "b" }));
+    EXPECT_EQ(row.columns(), (std::vector<std::string> { "id", "name" }));
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <QueryCraft/helper/literalescaping.h>
+
+#include <random>
+#include <string>
+
+namespace {
+/// Reference escaping with the same rules as the SQL builder
+std::string escape_reference(const std::string& value)
+{
+    std::string result;
+    for(size_t i = 0; i < value.size(); i++) {
+        result.push_back(value[i]);
+
+        if(value[i] == '\'' || (value[i] == '\\' && (i + 1 >= value.size() || value[i + 1] != '"'))) {
+            result.push_back(value[i]);
+        }
+    }
+
+    return result;
+}
+
+std::string escape(const std::string& value, const query_craft::helper::escape_kernel kernel)
+{
+    std::string result(query_craft::helper::escaped_literal_size(value.data(), value.size(), kernel), '\0');
+    const auto* end = query_craft::helper::escape_literal(value.data(), value.size(), &result[0], kernel);
+
+    EXPECT_EQ(end, result.data() + result.size());
+    return result;
+}
+
+const query_craft::helper::escape_kernel kernels[] = {
+    query_craft::helper::escape_kernel::scalar,
+    query_craft::helper::escape_kernel::sse2,
+    query_craft::helper::escape_kernel::avx2
+};
+} // namespace
+
+// Test for quotes, backslashes and json escapes
+TEST(LiteralEscapingTest, EscapesSpecialCharacters)
+{
+    for(const auto kernel : kernels) {
+        if(!query_craft::helper::is_escape_kernel_supported(kernel)) {
+            continue;
+        }
+
+        EXPECT_EQ(escape("", kernel), "");
+        EXPECT_EQ(escape("it's", kernel), "it''s");
+        EXPECT_EQ(escape("C:\\dir\\", kernel), "C:\\\\dir\\\\");
+        EXPECT_EQ(escape("{\"a\": \"b\\\"c\"}", kernel), "{\"a\": \"b\\\"c\"}");
+    }
+}
+
+// Test for all kernels matching the reference on special characters at every block position
+TEST(LiteralEscapingTest, KernelsMatchReference)
+{
+    std::mt19937 random(42);
+    const char alphabet[] = { 'a', 'b', '\'', '\\', '"', '\0', '\xff', ' ' };
+
+    for(size_t size = 0; size < 200; size++) {
+        std::string value(size, 'x');
+        for(auto& symbol : value) {
+            // Special characters are kept sparse so that clean spans cross block boundaries
+            symbol = random() % 8 == 0 ? alphabet[random() % sizeof(alphabet)] : 'x';
+        }
+
+        const auto expected = escape_reference(value);
+        for(const auto kernel : kernels) {
+            if(query_craft::helper::is_escape_kernel_supported(kernel)) {
+                EXPECT_EQ(escape(value, kernel), expected) << "size " << size << " kernel " << static_cast<int>(kernel);
+            }
+        }
+    }
+}
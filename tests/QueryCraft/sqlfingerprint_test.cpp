@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include <QueryCraft/querycraft.h>
+
+// Test for replacing literals and collapsing IN-lists into a stable shape
+TEST(SqlFingerprintTest, NormalizesLiteralsAndLists)
+{
+    EXPECT_EQ(query_craft::sql_shape("SELECT * FROM \"A\" WHERE \"id\" IN ('1', '2', '3') AND \"info\" = 'it''s'"),
+        "SELECT*FROM \"A\" WHERE \"id\" IN(...)AND \"info\"=?");
+
+    EXPECT_EQ(query_craft::sql_fingerprint("select * from \"A\" where \"id\" in ('42')  -- by id"),
+        query_craft::sql_fingerprint("SELECT *\nFROM \"A\" WHERE \"id\" IN ('7', '8')"));
+}
+
+// Test for equal fingerprints of inlined and parameterized multi-row inserts
+TEST(SqlFingerprintTest, CollapsesInsertRows)
+{
+    const auto inlined = query_craft::sql_fingerprint("INSERT INTO \"A\" (\"id\", \"info\") VALUES ('1', 'x'), ('2', NULL);");
+    const auto parameterized = query_craft::sql_fingerprint("INSERT INTO \"A\" (\"id\", \"info\") VALUES ($1, $2);");
+
+    EXPECT_EQ(inlined, parameterized);
+    EXPECT_NE(inlined, query_craft::sql_fingerprint("INSERT INTO \"B\" (\"id\", \"info\") VALUES ($1, $2);"));
+}
+
+// Test for keeping operators, casts and identifiers with digits intact
+TEST(SqlFingerprintTest, KeepsStructure)
+{
+    EXPECT_EQ(query_craft::sql_shape("UPDATE t SET a1 = a1 - 1, b = c::text WHERE d > -2.5e-3 LIMIT 10"),
+        "UPDATE T SET A1=A1-?,B=C::TEXT WHERE D>? LIMIT ?");
+}
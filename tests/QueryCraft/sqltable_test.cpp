@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <QueryCraft/querycraft.h>
+
+// Test for replacing inserted values with question placeholders
+TEST(SqlTableTest, ParameterizedInsert)
+{
+    auto sql_table = query_craft::sql_table(query_craft::table("A", "", { query_craft::column_info("id"), query_craft::column_info("info") }));
+    sql_table.add_row({ "1", "it's" });
+    sql_table.add_row({ "2", query_craft::column_info::null_value() });
+
+    query_craft::sql_parameters parameters;
+    const auto sql = sql_table.insert_sql(parameters);
+
+    EXPECT_EQ(sql, "INSERT INTO \"A\" (\"id\", \"info\") VALUES (?, ?), (?, ?);");
+    EXPECT_EQ(parameters.values(), (std::vector<std::string> { "1", "it's", "2", query_craft::column_info::null_value() }));
+}
+
+// Test for bound column values keeping the backslash escaping of literal inserts unless it is disabled
+TEST(SqlTableTest, ParameterizedInsertEscapesBackslashes)
+{
+    auto sql_table = query_craft::sql_table(query_craft::table("A", "", { query_craft::column_info("id"), query_craft::column_info("info") }));
+    const auto columns = sql_table.columns();
+
+    sql_table.add_row({ "1", "a\\b \\\"json\\\"" });
+    query_craft::sql_parameters parameters;
+    sql_table.insert_sql(parameters);
+
+    EXPECT_EQ(parameters.values(), (std::vector<std::string> { "1", "a\\\\b \\\"json\\\"" }));
+
+    sql_table.add_row({ "1", "a\\b" });
+    query_craft::sql_parameters verbatim_parameters(query_craft::placeholder_type::question, false);
+    sql_table.insert_sql(verbatim_parameters);
+
+    EXPECT_EQ(verbatim_parameters.values(), (std::vector<std::string> { "1", "a\\b" }));
+
+    query_craft::sql_parameters condition_parameters;
+    sql_table.select_sql(condition_parameters, {}, columns[1] == "a\\b", {}, 0, 0, { columns[0] });
+
+    EXPECT_EQ(condition_parameters.values(), (std::vector<std::string> { "a\\b" }));
+}
+
+// Test for numbering placeholders of a select condition while limit stays literal
+TEST(SqlTableTest, ParameterizedSelect)
+{
+    const auto sql_table = query_craft::sql_table(query_craft::table("A", "", { query_craft::column_info("id"), query_craft::column_info("info") }));
+    const auto columns = sql_table.columns();
+
+    query_craft::sql_parameters parameters(query_craft::placeholder_type::numbered);
+    const auto sql = sql_table.select_sql(parameters, {}, columns[0] == 5 && columns[1] != "b", {}, 10, 0, { columns[0] });
+
+    EXPECT_EQ(sql, "SELECT \"A\".\"id\" AS A_id FROM \"A\" WHERE (\"A\".\"id\" = $1 AND \"A\".\"info\" <> $2) LIMIT 10;");
+    EXPECT_EQ(parameters.values(), (std::vector<std::string> { "5", "b" }));
+}
+
+// Test for sorted select and returning insert ending exactly at the semicolon
+TEST(SqlTableTest, NoTrailingBytesAfterLists)
+{
+    auto sql_table = query_craft::sql_table(query_craft::table("A", "", { query_craft::column_info("id"), query_craft::column_info("info") }));
+    const auto columns = sql_table.columns();
+
+    EXPECT_EQ(sql_table.select_sql({}, {}, { query_craft::desc_sort(columns[0]) }, 0, 0, { columns[0] }),
+        "SELECT \"A\".\"id\" AS A_id FROM \"A\" ORDER BY A_id DESC;");
+
+    sql_table.add_row({ "1", "it's \\ \\\"json\\\"" });
+    EXPECT_EQ(sql_table.insert_sql({}, true, { columns[0], columns[1] }),
+        "INSERT INTO \"A\" (\"id\", \"info\") VALUES ('1', 'it''s \\\\ \\\"json\\\"') RETURNING \"id\", \"info\";");
+}
+
+// Test for reusing one builder across inserts
+TEST(SqlTableTest, InsertIntoReusedBuilder)
+{
+    auto sql_table = query_craft::sql_table(query_craft::table("A", "", { query_craft::column_info("id"), query_craft::column_info("info") }));
+    query_craft::sql_builder builder;
+
+    sql_table.add_row({ "1", "a" });
+    sql_table.add_row({ "2", "b" });
+    sql_table.insert_sql(builder);
+    const auto capacity = builder.str().capacity();
+
+    sql_table.add_row({ "3", query_craft::column_info::null_value() });
+    sql_table.insert_sql(builder);
+
+    EXPECT_EQ(builder.str(), "INSERT INTO \"A\" (\"id\", \"info\") VALUES ('3', NULL);");
+    EXPECT_EQ(builder.str().capacity(), capacity);
+}
@@ -0,0 +1,156 @@
+#ifdef ENABLE_SQLITE
+
+#include <gtest/gtest.h>
+#include <SqliteAdapter/sqliteadapter.h>
+
+#include <cstdio>
+#include <string>
+
+namespace {
+/// Значение PRAGMA в виде строки
+std::string pragma(database_adapter::sqlite::connection& connection, const std::string& name)
+{
+    const auto result = connection.exec("PRAGMA " + name + ";");
+    const auto value = result[0].as_text(0);
+    return std::string(value.data(), value.size());
+}
+} // namespace
+
+// Test for applying tuning profile when connection is opened
+TEST(SqliteConnectionTest, AppliesTuningOnOpen)
+{
+    database_adapter::sqlite::settings settings;
+    settings.url = "sqlite_tuning_test.db";
+    std::remove(settings.url.c_str());
+
+    {
+        database_adapter::sqlite::connection connection(settings, database_adapter::sqlite::tuning::throughput());
+
+        EXPECT_EQ(pragma(connection, "journal_mode"), "wal");
+        EXPECT_EQ(pragma(connection, "synchronous"), "1");
+        EXPECT_EQ(pragma(connection, "cache_size"), "-65536");
+        EXPECT_EQ(pragma(connection, "temp_store"), "2");
+        EXPECT_EQ(pragma(connection, "busy_timeout"), "5000");
+    }
+
+    {
+        // Профиль по умолчанию не меняет настройки соединения
+        database_adapter::sqlite::connection connection(settings);
+
+        EXPECT_EQ(pragma(connection, "synchronous"), "2");
+        EXPECT_EQ(pragma(connection, "busy_timeout"), "0");
+    }
+
+    std::remove(settings.url.c_str());
+    std::remove((settings.url + "-wal").c_str());
+    std::remove((settings.url + "-shm").c_str());
+}
+
+// Test for reusing column names of a cached statement until the schema changes
+TEST(SqliteConnectionTest, CachedStatementReusesColumns)
+{
+    database_adapter::sqlite::settings settings;
+    settings.url = ":memory:";
+    database_adapter::sqlite::connection connection(settings);
+
+    connection.exec("CREATE TABLE A (B INTEGER);");
+
+    const auto first = connection.exec("SELECT * FROM A;");
+    const auto second = connection.exec("SELECT * FROM A;");
+    EXPECT_EQ(&first.columns(), &second.columns());
+
+    connection.exec("ALTER TABLE A ADD COLUMN C TEXT;");
+
+    const auto altered = connection.exec("SELECT * FROM A;");
+    const std::vector<std::string> expected { "B", "C" };
+    EXPECT_EQ(altered.columns(), expected);
+    EXPECT_EQ(first.columns().size(), 1);
+}
+
+// Test for routing reads to read-only connections and writes to the single writer
+TEST(SqliteConnectionTest, ReadWritePoolRoutesStatements)
+{
+    database_adapter::sqlite::settings settings;
+    settings.url = "sqlite_read_write_test.db";
+    std::remove(settings.url.c_str());
+
+    {
+        database_adapter::sqlite::read_write_pool pool(settings, 2);
+        auto connection = pool.open_connection();
+
+        connection->exec("CREATE TABLE A (B INTEGER);");
+        connection->exec_prepared("INSERT INTO A VALUES (?);", { "1" });
+        EXPECT_EQ(connection->exec("SELECT COUNT(*) FROM A;")[0].as_int64(0), 1);
+        EXPECT_EQ(pool.reader_pool()->metrics().checkouts, 1);
+
+        // Внутри транзакции чтение видит незафиксированные изменения, так как выполняется на соединении для записи
+        connection->open_base_transaction();
+        connection->exec_prepared("INSERT INTO A VALUES (?);", { "2" });
+        EXPECT_EQ(connection->exec("SELECT COUNT(*) FROM A;")[0].as_int64(0), 2);
+        EXPECT_EQ(pool.reader_pool()->metrics().checkouts, 1);
+
+        // Другие соединения читают последнее зафиксированное состояние без ожидания записи
+        EXPECT_EQ(pool.open_connection()->exec("SELECT COUNT(*) FROM A;")[0].as_int64(0), 1);
+
+        connection->commit();
+        EXPECT_EQ(pool.writer_pool()->metrics().active, 0);
+        EXPECT_EQ(pool.open_connection()->exec("SELECT COUNT(*) FROM A;")[0].as_int64(0), 2);
+    }
+
+    std::remove(settings.url.c_str());
+    std::remove((settings.url + "-wal").c_str());
+    std::remove((settings.url + "-shm").c_str());
+}
+
+// Test for keeping the writer pinned while a transaction opened by a raw statement is in progress
+TEST(SqliteConnectionTest, ReadWritePoolPinsRawTransactions)
+{
+    database_adapter::sqlite::settings settings;
+    settings.url = "sqlite_read_write_raw_test.db";
+    std::remove(settings.url.c_str());
+
+    {
+        database_adapter::sqlite::read_write_pool pool(settings, 1, std::chrono::milliseconds(100));
+        auto connection = pool.open_connection();
+
+        connection->exec("CREATE TABLE A (B INTEGER);");
+
+        connection->exec("BEGIN;");
+        EXPECT_TRUE(connection->is_transaction());
+        EXPECT_EQ(pool.writer_pool()->metrics().active, 1);
+
+        connection->exec_prepared("INSERT INTO A VALUES (?);", { "1" });
+        EXPECT_EQ(connection->exec("SELECT COUNT(*) FROM A;")[0].as_int64(0), 1);
+        EXPECT_EQ(pool.open_connection()->exec("SELECT COUNT(*) FROM A;")[0].as_int64(0), 0);
+
+        connection->exec("COMMIT;");
+        EXPECT_FALSE(connection->is_transaction());
+        EXPECT_EQ(pool.writer_pool()->metrics().active, 0);
+
+        // Точка сохранения вне транзакции открывает транзакцию, которая завершается при RELEASE
+        connection->add_save_point("A1");
+        connection->exec_prepared("INSERT INTO A VALUES (?);", { "2" });
+        EXPECT_EQ(pool.writer_pool()->metrics().active, 1);
+
+        connection->rollback_to_save_point("A1");
+        EXPECT_EQ(pool.writer_pool()->metrics().active, 1);
+
+        connection->exec("RELEASE A1;");
+        EXPECT_EQ(pool.writer_pool()->metrics().active, 0);
+        EXPECT_EQ(pool.open_connection()->exec("SELECT COUNT(*) FROM A;")[0].as_int64(0), 1);
+
+        // Незавершённая транзакция откатывается до возврата соединения для записи в пул
+        connection->exec("BEGIN;");
+        connection->exec_prepared("INSERT INTO A VALUES (?);", { "3" });
+        connection.reset();
+
+        EXPECT_EQ(pool.writer_pool()->metrics().active, 0);
+        EXPECT_EQ(pool.open_connection()->exec("SELECT COUNT(*) FROM A;")[0].as_int64(0), 1);
+    }
+
+    std::remove(settings.url.c_str());
+    std::remove((settings.url + "-wal").c_str());
+    std::remove((settings.url + "-shm").c_str());
+}
+
+#endif
@@ -20,6 +20,21 @@ TEST(ContainerConverterTest, ConvertToTargetWithEmplaceBack)
     EXPECT_EQ(target.back(), 3);
 }
 
+TEST(ContainerConverterTest, MoveToTargetAppendsMovedValues)
+{
+    using namespace type_converter_api;
+    std::vector<std::string> source = { "first", "second" };
+    std::list<std::string> target = { "head" };
+    container_converter<std::list<std::string>, std::string> converter;
+    converter.move_to_target(target, source);
+
+    ASSERT_EQ(target.size(), 3);
+    EXPECT_EQ(target.front(), "head");
+    EXPECT_EQ(*(++target.begin()), "first");
+    EXPECT_EQ(target.back(), "second");
+    EXPECT_EQ(source.size(), 2);
+}
+
 TEST(ContainerConverterTest, ConvertToTargetWithUnsupportedType)
 {
     const std::vector<int> source = { 7, 8, 9 };
@@ -19,6 +19,21 @@ TEST(TypeConverterTest, StringToBool)
     EXPECT_TRUE(value);
 }
 
+// Test for converting database boolean spellings to a boolean
+TEST(TypeConverterTest, DatabaseStringToBool)
+{
+    const type_converter_api::type_converter<bool> converter;
+    bool value = false;
+    converter.fill_from_string(value, "t");
+    EXPECT_TRUE(value);
+    converter.fill_from_string(value, "f");
+    EXPECT_FALSE(value);
+    converter.fill_from_string(value, "1");
+    EXPECT_TRUE(value);
+    converter.fill_from_string(value, "0");
+    EXPECT_FALSE(value);
+}
+
 // Test for converting an integer to a string
 TEST(TypeConverterTest, IntToString)
 {